@@ -1,14 +1,15 @@
 #pragma once
 
 #include <mutex>
+#include <shared_mutex>
 
 namespace l::concurrency {
 
-	template<class T>
+	template<class T, class Mutex = std::mutex>
 	class ObjectLock {
 	public:
 		ObjectLock() = default;
-		ObjectLock(std::mutex& mutex, T* object) :
+		ObjectLock(Mutex& mutex, T* object) :
 			mLock(mutex, std::adopt_lock),
 			mObject(object)
 		{}
@@ -42,7 +43,50 @@ namespace l::concurrency {
 		}
 
 	protected:
-		std::unique_lock<std::mutex> mLock;
+		std::unique_lock<Mutex> mLock;
+		T* mObject = nullptr;
+	};
+
+	// Read access through a shared lock, any number of readers can hold one at a time
+	template<class T, class Mutex = std::shared_mutex>
+	class SharedObjectLock {
+	public:
+		SharedObjectLock() = default;
+		SharedObjectLock(Mutex& mutex, T* object) :
+			mLock(mutex, std::adopt_lock),
+			mObject(object)
+		{}
+
+		~SharedObjectLock() = default;
+
+		SharedObjectLock& operator=(SharedObjectLock&& other) {
+			if (this != &other) {
+				mLock = std::move(other.mLock);
+				mObject = other.mObject;
+				other.mObject = nullptr;
+			}
+			return *this;
+		}
+
+		void reset() {
+			mObject = nullptr;
+			mLock.unlock();
+		}
+
+		bool valid() {
+			return mObject != nullptr;
+		}
+
+		T* operator->() {
+			return mObject;
+		}
+
+		T& operator*() {
+			return *mObject;
+		}
+
+	protected:
+		std::shared_lock<Mutex> mLock;
 		T* mObject = nullptr;
 	};
 
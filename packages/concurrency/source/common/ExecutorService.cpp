@@ -138,13 +138,13 @@ namespace l::concurrency {
 	bool ExecutorService::queueJob(std::unique_ptr<Runnable> runnable) {
 		{
 			if (mRunState.mDestructing) {
-				LOG(LogWarning) << "Service is shutdown and waiting for destruction";
+				LOG_RATE_LIMITED(LogWarning, 10, 1000) << "Service is shutdown and waiting for destruction";
 				return false;
 			}
 
 			std::lock_guard<std::mutex> lock(mRunnablesMutex);
 			if (mMaxQueuedJobs > 0 && mRunnables.size() > mMaxQueuedJobs) {
-				LOG(LogWarning) << "Too many jobs!";
+				LOG_RATE_LIMITED(LogWarning, 10, 1000) << "Too many jobs!";
 				return false;
 			}
 			mRunnables.push_back(std::move(runnable));
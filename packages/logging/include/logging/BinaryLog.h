@@ -0,0 +1,148 @@
+#pragma once
+
+#include "logging/Log.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace l::logging {
+
+	/*
+	Binary log file layout (little endian, native sizes):
+		header:  'LBLG' (u32), version (u32)
+		format:  kind 0 (u8), id (u32), level (u8), line (u32), file (u16 + bytes), format (u16 + bytes), signature (u16 + bytes)
+		message: kind 1 (u8), id (u32), thread (u32), time in microseconds since epoch (i64), payload (u16 + bytes)
+
+	A format record is written once per call site and file, the first time the call site logs. Message payloads
+	are the raw argument bytes in call order, strings are stored as u16 length + bytes. The signature string
+	has two characters per argument, a type code ('i' signed, 'u' unsigned, 'f' floating point, 'b' bool,
+	'c' char, 's' string) and the byte size ('0' for strings). Long doubles are stored as doubles.
+	*/
+
+	constexpr uint32_t kBinaryLogIdentifier = 0x474c424c; // 'LBLG'
+	constexpr uint32_t kBinaryLogVersion = 1;
+	constexpr size_t kBinaryLogMaxPayload = 512;
+
+	extern std::atomic_bool gBinaryLogOpen;
+
+	inline bool IsBinaryLogOpen() {
+		return gBinaryLogOpen.load(std::memory_order_relaxed);
+	}
+
+	bool OpenBinaryLog(std::string_view path);
+	void CloseBinaryLog();
+	void FlushBinaryLog();
+
+	uint32_t RegisterBinaryLogFormat(const char* file, int line, LogLevel level, std::string_view format, std::string signature);
+	void WriteBinaryLogRecord(uint32_t formatId, const unsigned char* payload, size_t size);
+
+	// Renders every message in a binary log as a text line, returns false if the data is not a valid binary log
+	bool DecodeBinaryLog(std::istream& src, std::function<void(std::string_view)> handler);
+	bool DecodeBinaryLogFile(std::string_view path, std::ostream& dst);
+
+	namespace binarylog {
+		template<class T>
+		inline constexpr bool IsString =
+			std::is_same_v<T, std::string> ||
+			std::is_same_v<T, std::string_view> ||
+			std::is_same_v<T, const char*> ||
+			std::is_same_v<T, char*>;
+
+		template<class T>
+		void AppendSignature(std::string& signature) {
+			using U = std::decay_t<T>;
+			if constexpr (IsString<U>) {
+				signature += "s0";
+			}
+			else if constexpr (std::is_enum_v<U>) {
+				AppendSignature<std::underlying_type_t<U>>(signature);
+			}
+			else if constexpr (std::is_same_v<U, long double>) {
+				// packed as a double, its size differs between platforms
+				AppendSignature<double>(signature);
+			}
+			else {
+				static_assert(std::is_arithmetic_v<U>, "Binary log arguments must be arithmetic, enums or strings");
+				if constexpr (std::is_same_v<U, bool>) {
+					signature += 'b';
+				}
+				else if constexpr (std::is_same_v<U, char>) {
+					signature += 'c';
+				}
+				else if constexpr (std::is_floating_point_v<U>) {
+					signature += 'f';
+				}
+				else if constexpr (std::is_signed_v<U>) {
+					signature += 'i';
+				}
+				else {
+					signature += 'u';
+				}
+				signature += static_cast<char>('0' + sizeof(U));
+			}
+		}
+
+		template<class... Args>
+		std::string GetSignature() {
+			std::string signature;
+			(AppendSignature<Args>(signature), ...);
+			return signature;
+		}
+
+		template<class T>
+		void Pack(std::array<unsigned char, kBinaryLogMaxPayload>& buffer, size_t& size, const T& value) {
+			using U = std::decay_t<T>;
+			if constexpr (IsString<U>) {
+				std::string_view str;
+				if constexpr (std::is_pointer_v<U>) {
+					const char* ptr = value;
+					if (ptr != nullptr) {
+						str = ptr;
+					}
+				}
+				else {
+					str = value;
+				}
+				auto left = buffer.size() - size;
+				if (left >= 2) {
+					auto count = static_cast<uint16_t>(str.size() < left - 2 ? str.size() : left - 2);
+					memcpy(buffer.data() + size, &count, 2);
+					memcpy(buffer.data() + size + 2, str.data(), count);
+					size += 2 + count;
+				}
+			}
+			else if constexpr (std::is_same_v<U, long double>) {
+				Pack(buffer, size, static_cast<double>(value));
+			}
+			else if (size + sizeof(U) <= buffer.size()) {
+				memcpy(buffer.data() + size, &value, sizeof(U));
+				size += sizeof(U);
+			}
+		}
+	}
+
+	// The Tag parameter is a unique lambda type per call site so each call site gets its own static format id
+	template<class Tag, class... Args>
+	void BinaryLogMessage(const char* file, int line, LogLevel level, Tag, const char* format, const Args&... args) {
+		static const uint32_t id = RegisterBinaryLogFormat(file, line, level, format, binarylog::GetSignature<Args...>());
+
+		std::array<unsigned char, kBinaryLogMaxPayload> buffer;
+		size_t size = 0;
+		(binarylog::Pack(buffer, size, args), ...);
+		WriteBinaryLogRecord(id, buffer.data(), size);
+	}
+}
+
+/* Usage:
+BLOG(LogInfo, "Loaded {} candles for {} in {} ms", count, symbol, ms);
+*/
+#define BLOG(level, ...) \
+	(l::logging::LogLevel::level < LOG_LEVEL_MIN || !l::logging::IsLogLevelOn(l::logging::LogLevel::level) || !l::logging::IsBinaryLogOpen()) ? (void)0 : \
+	l::logging::BinaryLogMessage(__FILE__, __LINE__, l::logging::LogLevel::level, []() {}, __VA_ARGS__)
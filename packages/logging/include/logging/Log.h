@@ -12,6 +12,7 @@
 #include <vector>
 #include <type_traits>
 #include <utility>
+#include <atomic>
 
 
 #ifdef _MSC_VER
@@ -26,6 +27,11 @@
 	(void)0
 #endif
 
+// Log levels below this value are compiled out entirely, i.e. define as 1 to strip all LogDebug call sites
+#ifndef LOG_LEVEL_MIN
+#define LOG_LEVEL_MIN 0
+#endif
+
 namespace l::string {
 	std::string narrow(const std::wstring&);
 }
@@ -81,13 +87,72 @@ namespace logging {
 	private:
 		bool mCondition{ false };
 		LogLevel mLevel;
+		size_t mPrefixSize = 0;
 		std::stringstream mStream;
 	};
 
+	struct LogSiteResult {
+		bool mAllowed = true;
+		uint32_t mSuppressed = 0;
+	};
+
+	// Allows at most maxCount messages per interval from one call site and counts what it suppressed. A count that
+	// no later message reported is written by FlushLog and when the limiter goes away.
+	class LogRateLimiter {
+	public:
+		LogRateLimiter(const char* file, int line, int32_t maxCount, int32_t intervalMs);
+		~LogRateLimiter();
+
+		LogSiteResult Check();
+		void Flush();
+
+	protected:
+		std::mutex mMutex;
+		const char* mFile;
+		int mLine;
+		int32_t mMaxCount;
+		int64_t mIntervalMs;
+		int64_t mWindowStart = 0;
+		int32_t mCount = 0;
+		uint32_t mSuppressed = 0;
+	};
+
+	// The Tag parameter is a unique lambda type per call site so each call site gets its own limiter
+	template<class Tag>
+	LogRateLimiter& GetLogRateLimiter(Tag, const char* file, int line, int32_t maxCount, int32_t intervalMs) {
+		static LogRateLimiter limiter(file, line, maxCount, intervalMs);
+		return limiter;
+	}
+
+	struct LogSuppressed {
+		uint32_t mCount = 0;
+	};
+
+	std::ostream& operator<<(std::ostream& stream, const LogSuppressed& suppressed);
+
+	// Swallows the logger stream expression so the macros below can be used as a single ternary expression
+	struct LogVoidify {
+		void operator&(const Logger&) {}
+	};
+
+	extern std::atomic_bool gLogLevelOn[8];
+
+	inline bool IsLogLevelOn(LogLevel level) {
+		return gLogLevelOn[level].load(std::memory_order_relaxed);
+	}
+
 	void SetLogLevelOn(LogLevel level, bool on);
 
+	// Pending repeat and suppression counts are written to the previous handler first
 	void SetLocalLogHandler(std::function<void(std::string_view)> f);
 
+	// Collapses consecutive identical messages (ignoring the time stamp) into one line and a repeat count
+	void SetLogDeduplication(bool on);
+
+	// Writes the repeat count of the last message and the counts of rate limited call sites that no later message
+	// reported yet. Also done at exit.
+	void FlushLog();
+
 	Logger LogMessage(const char *file, int line, LogLevel level, bool debugBreak = false);
 }
 }
@@ -95,13 +160,30 @@ namespace logging {
 #define LOG_LEVEL_ON(level) l::logging::SetLogLevelOn(l::logging::LogLevel::level, true)
 #define LOG_LEVEL_OFF(level) l::logging::SetLogLevelOn(l::logging::LogLevel::level, false)
 
-#define LOG(level) l::logging::LogMessage(__FILE__, __LINE__, l::logging::LogLevel::level)
-
-#define ASSERT(condition) l::logging::LogMessage(__FILE__, __LINE__, l::logging::LogLevel::LogAssertion, condition)
-
-#define ASSERT_FUZZY(expr1, expr2, tolerance) l::logging::LogMessage(__FILE__, __LINE__, l::logging::LogLevel::LogAssertion, sqrt((expr1 - expr2)*(expr1 - expr2)) < tolerance)
-
-#define EXPECT(condition) l::logging::LogMessage(__FILE__, __LINE__, l::logging::LogLevel::LogExpection, condition)
+// Disabled levels and passing conditions short circuit before the logger is constructed, so neither the stream
+// arguments, the time lookup nor any allocation is evaluated in those cases
+#define LOG(level) \
+	(l::logging::LogLevel::level < LOG_LEVEL_MIN || !l::logging::IsLogLevelOn(l::logging::LogLevel::level)) ? (void)0 : \
+	l::logging::LogVoidify() & l::logging::Logger(__FILE__, __LINE__, l::logging::LogLevel::level)
+
+/* Usage, at most 10 messages per second from this line, the next message after a burst reports how many were dropped:
+LOG_RATE_LIMITED(LogWarning, 10, 1000) << "Connection lost";
+*/
+#define LOG_RATE_LIMITED(level, maxCount, intervalMs) \
+	if (auto logSite_ = (l::logging::LogLevel::level < LOG_LEVEL_MIN || !l::logging::IsLogLevelOn(l::logging::LogLevel::level)) ? \
+		l::logging::LogSiteResult{ false, 0 } : l::logging::GetLogRateLimiter([]() {}, __FILE__, __LINE__, maxCount, intervalMs).Check(); !logSite_.mAllowed) {} \
+	else l::logging::Logger(__FILE__, __LINE__, l::logging::LogLevel::level) << l::logging::LogSuppressed{ logSite_.mSuppressed }
+
+#define ASSERT(condition) \
+	(condition) ? (void)0 : \
+	l::logging::LogVoidify() & l::logging::Logger(__FILE__, __LINE__, l::logging::LogLevel::LogAssertion, false)
+
+#define ASSERT_FUZZY(expr1, expr2, tolerance) \
+	ASSERT(sqrt((expr1 - expr2)*(expr1 - expr2)) < tolerance)
+
+#define EXPECT(condition) \
+	(condition) ? (void)0 : \
+	l::logging::LogVoidify() & l::logging::Logger(__FILE__, __LINE__, l::logging::LogLevel::LogExpection, false)
 
 template<class T>
 T* require(T* ptr) {
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "BinaryLog.h"
 #include "Debug.h"
 #include "Log.h"
 #include "Macro.h"
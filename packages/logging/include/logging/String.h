@@ -9,6 +9,9 @@
 #include <string_view>
 #include <string>
 #include <memory>
+#include <span>
+#include <array>
+#include <charconv>
 
 namespace l::string {
 
@@ -147,6 +150,29 @@ namespace l::string {
 	std::string get_local_time_string(const int32_t unixtime, std::string_view format = "%Y-%m-%d %X");
 
 	size_t get_local_time_string_verbose(char* buf, size_t maxSize);
+
+	// Formats 'YYYY-MM-DD HH:MM:SS.uuuuuu' in local time. The date and time part is cached per thread and only
+	// rebuilt when the second changes, so consecutive calls only format the sub second digits.
+	size_t get_local_time_string_cached(char* buf, size_t maxSize, int64_t unixtimeMicros);
+
+	constexpr int64_t days_from_civil(int32_t year, int32_t month, int32_t day) {
+		year -= month <= 2 ? 1 : 0;
+		const int64_t era = (year >= 0 ? year : year - 399) / 400;
+		const int64_t yoe = static_cast<int64_t>(year) - era * 400;
+		const int64_t doy = (153 * (month + (month > 2 ? -3 : 9)) + 2) / 5 + day - 1;
+		const int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+		return era * 146097 + doe - 719468;
+	}
+
+	// Parses utc ISO-8601 style dates without sscanf/mktime: 'YYYY-MM-DD', 'YYYY-MM-DD HH:MM[:SS]',
+	// 'YYYY-MM-DDTHH:MM:SS[.fraction][Z|+HH:MM|-HH:MM]' as well as plain unix time in seconds (up to 10 digits)
+	// or milliseconds (13 digits). Returns false if no date could be read.
+	bool parse_unix_time_ms(std::string_view date, int64_t& unixtimeMs);
+	int32_t parse_unix_time(std::string_view date);
+
+	// Batch conversion, returns the number of dates that were parsed successfully, failed entries are set to 0
+	size_t parse_unix_times(std::span<const std::string_view> dates, std::span<int32_t> unixtimes);
+	size_t parse_unix_times_ms(std::span<const std::string_view> dates, std::span<int64_t> unixtimesMs);
 	
 	template<size_t BUFSIZE>
 	void get_local_date(string_buffer<BUFSIZE>& buf, const int32_t unixtime, bool fullYear = false) {
@@ -179,33 +205,118 @@ namespace l::string {
 		}
 	}
 
+	// FNV-1a, usable at compile time and stable across platforms and runs (unlike std::hash)
+	constexpr uint32_t fnv1a_32(std::string_view string, uint32_t seed = 0x811c9dc5u) {
+		uint32_t hash = seed;
+		for (auto c : string) {
+			hash ^= static_cast<uint8_t>(c);
+			hash *= 0x01000193u;
+		}
+		return hash;
+	}
+
+	constexpr uint64_t fnv1a_64(std::string_view string, uint64_t seed = 0xcbf29ce484222325ull) {
+		uint64_t hash = seed;
+		for (auto c : string) {
+			hash ^= static_cast<uint8_t>(c);
+			hash *= 0x00000100000001b3ull;
+		}
+		return hash;
+	}
+
 	template<size_t SIZE>
-	uint32_t string_id(const char(&string)[SIZE]) {
-		std::hash<std::string_view> hasher;
-		auto id = hasher(std::string_view(&string[0], SIZE-1));
-		return static_cast<uint32_t>(id);
+	constexpr uint32_t string_id(const char(&string)[SIZE]) {
+		return fnv1a_32(std::string_view(&string[0], SIZE - 1));
+	}
+	constexpr uint32_t string_id(std::string_view string) {
+		return fnv1a_32(string);
+	}
+	inline uint32_t string_id(const std::string& string) {
+		return fnv1a_32(string);
 	}
-	uint32_t string_id(std::string_view string);
-	uint32_t string_id(const std::string& string);
+
+	namespace literals {
+		consteval uint32_t operator""_id(const char* string, size_t size) {
+			return fnv1a_32(std::string_view(string, size));
+		}
+	}
+
+	// Global symbol table. Interned strings get a small dense id (starting at 1, 0 is never used) that stays valid
+	// for the life time of the process. Lookups take a shared lock so concurrent readers don't serialize.
+	uint32_t intern(std::string_view string);
+	// Returns 0 if the string has not been interned
+	uint32_t find_symbol(std::string_view string);
+	// The returned view stays valid for the life time of the process, empty for unknown ids
+	std::string_view symbol_name(uint32_t symbol);
+	size_t symbol_count();
 
 	std::string encode_html(const std::string& input);
 
+	// Locale independent parsing straight from the view (no null termination needed). Leading white space and
+	// '+' are skipped to stay compatible with atof/atoi. Returns false and leaves value untouched on failure.
+	template<class T>
+	bool to_number(std::string_view number, T& value) {
+		static_assert(std::is_arithmetic_v<T>, "to_number only supports arithmetic types");
+		const char* first = number.data();
+		const char* last = first + number.size();
+		while (first < last && (*first == ' ' || *first == '\t' || *first == '\r' || *first == '\n')) {
+			first++;
+		}
+		if (first < last && *first == '+') {
+			first++;
+		}
+		auto [ptr, ec] = std::from_chars(first, last, value);
+		return ec == std::errc() && ptr != first;
+	}
+
+	template<class T>
+	T to_number(std::string_view number) {
+		T value{};
+		to_number(number, value);
+		return value;
+	}
+
 	template<class T>
 	T get_number(std::string_view number) {
-		char buffer[24];
-		ASSERT(number.size() < 24);
-		memcpy(buffer, number.data(), number.size());
-		buffer[number.size()] = '\0';
-		if constexpr (std::is_floating_point_v<T>) {
-			return static_cast<T>(std::atof(buffer));
+		return to_number<T>(number);
+	}
+
+	// Parses a run of numbers separated by any of the separator characters straight into dst. White space always
+	// separates numbers, like the leading white space to_number skips. Tokens that are not numbers are skipped.
+	// Returns the number of values written, at most dst.size().
+	template<class T>
+	size_t to_numbers(std::string_view text, std::span<T> dst, std::string_view separators = ", \t\r\n") {
+		static_assert(std::is_arithmetic_v<T>, "to_numbers only supports arithmetic types");
+		std::array<bool, 256> isSeparator{};
+		for (auto c : separators) {
+			isSeparator[static_cast<unsigned char>(c)] = true;
 		}
-		else if constexpr (std::is_integral_v<T>) {
-			return static_cast<T>(std::atoi(buffer));
+		for (auto c : { ' ', '\t', '\r', '\n' }) {
+			isSeparator[static_cast<unsigned char>(c)] = true;
 		}
-		else {
-			ASSERT(false);
-			return 0;
+		const char* p = text.data();
+		const char* end = p + text.size();
+		size_t count = 0;
+		while (p < end && count < dst.size()) {
+			while (p < end && isSeparator[static_cast<unsigned char>(*p)]) {
+				p++;
+			}
+			if (p >= end) {
+				break;
+			}
+			if (*p == '+') {
+				p++;
+			}
+			auto [ptr, ec] = std::from_chars(p, end, dst[count]);
+			if (ec == std::errc() && ptr != p) {
+				count++;
+			}
+			p = ptr;
+			while (p < end && !isSeparator[static_cast<unsigned char>(*p)]) { // skip the rest of a malformed token
+				p++;
+			}
 		}
+		return count;
 	}
 
 	void replace(std::string& str, const char find_char = '\\', const char new_char = '/');
@@ -218,6 +329,88 @@ namespace l::string {
 	std::vector<std::wstring_view> split(std::wstring_view text, std::wstring_view delim = L" \t\n", char escapeChar = '\"');
 	std::vector<std::string_view> split(std::string_view text, std::string_view delim = " \t\n", char escapeChar = '\"');
 
+	// Set of delimiter characters searched 16/32 bytes at a time with SSE2/AVX2 when available. Sets of more
+	// than 8 characters fall back to a scalar table lookup.
+	class delimiter_set {
+	public:
+		delimiter_set(std::string_view delim = " \t\n");
+		~delimiter_set() = default;
+
+		bool contains(char c) const {
+			return mTable[static_cast<unsigned char>(c)];
+		}
+
+		// Position of the first delimiter at or after pos, or text.size() if there is none
+		size_t find(std::string_view text, size_t pos = 0) const;
+
+	protected:
+		std::array<bool, 256> mTable{};
+		std::array<char, 8> mChars{};
+		size_t mCount = 0;
+	};
+
+	size_t find_first_of(std::string_view text, std::string_view delim, size_t pos = 0);
+
+	// Non allocating tokenizer, consecutive delimiters produce empty tokens unless skipEmpty is set
+	class tokenizer {
+	public:
+		tokenizer(std::string_view text, std::string_view delim = " \t\n", bool skipEmpty = true) :
+			mText(text),
+			mDelimiters(delim),
+			mSkipEmpty(skipEmpty)
+		{}
+		~tokenizer() = default;
+
+		bool next(std::string_view& token);
+
+		void reset(std::string_view text) {
+			mText = text;
+			mPos = 0;
+			mDone = false;
+		}
+
+		class iterator {
+		public:
+			iterator() = default;
+			iterator(tokenizer* owner) : mOwner(owner) {
+				++(*this);
+			}
+
+			std::string_view operator*() const {
+				return mToken;
+			}
+			iterator& operator++() {
+				if (mOwner != nullptr && !mOwner->next(mToken)) {
+					mOwner = nullptr;
+				}
+				return *this;
+			}
+			bool operator==(const iterator& other) const {
+				return mOwner == other.mOwner;
+			}
+		protected:
+			tokenizer* mOwner = nullptr;
+			std::string_view mToken;
+		};
+
+		iterator begin() {
+			return iterator(this);
+		}
+		iterator end() {
+			return iterator();
+		}
+
+	protected:
+		std::string_view mText;
+		delimiter_set mDelimiters;
+		size_t mPos = 0;
+		bool mSkipEmpty = true;
+		bool mDone = false;
+	};
+
+	// Writes tokens into caller provided storage, returns the number of tokens written (at most dst.size())
+	size_t split_into(std::string_view text, std::span<std::string_view> dst, std::string_view delim = " \t\n", bool skipEmpty = true);
+
 	std::string narrow(const std::wstring& str);
 	std::wstring widen(const std::string& str);
 
@@ -225,34 +418,14 @@ namespace l::string {
 
 	template<class T>
 	concept Number = requires(T a) { requires std::convertible_to<T, float> || std::convertible_to<T, uint32_t>; };
+	// Appends at most count numbers parsed from the first length characters of src, which needn't be null terminated
 	template<Number T>
-	void cstring_to_numbers(const char* src, size_t count, char separator, std::vector<T>& dst) {
-		constexpr size_t bufferSize = 1024;
-		std::array<T, bufferSize> buffer;
-		std::array<char, 32> charBuffer{0};
-		auto srcPtr = const_cast<char*>(src);
-
-		for (size_t i = 0; i < count; i += bufferSize) {
-			auto currentBatchSize = count - i > bufferSize ? bufferSize : count - i;
-			for (size_t j = 0; j < currentBatchSize; j++) {
-				size_t k = 0;
-				while (*srcPtr != separator) {
-					charBuffer[k++] = *srcPtr++;
-				}
-				srcPtr++;
-				charBuffer[k++] = '\0';
-
-				//ASSERT(k < 32) << "Failed to fit number in char buffer";
-
-				if constexpr (std::is_integral<T>::value) {
-					buffer[j] = static_cast<uint32_t>(std::atoi(charBuffer.data()));
-				}
-				else {
-					buffer[j] = static_cast<float>(std::atof(charBuffer.data()));
-				}
-			}
-			dst.insert(dst.end(), buffer.begin(), buffer.begin() + currentBatchSize);
-		}
+	void cstring_to_numbers(const char* src, size_t length, size_t count, char separator, std::vector<T>& dst) {
+		auto offset = dst.size();
+		dst.resize(offset + count);
+		const char separators[] = { separator, 0 };
+		auto parsed = to_numbers(std::string_view(src, length), std::span<T>(dst.data() + offset, count), std::string_view(separators, 1));
+		dst.resize(offset + parsed);
 	}
 
 	template<const char pad = '0'>
@@ -0,0 +1,339 @@
+#include "logging/BinaryLog.h"
+#include "logging/String.h"
+
+#include <chrono>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace l::logging {
+
+	std::atomic_bool gBinaryLogOpen = false;
+
+	namespace {
+		constexpr size_t kFlushThreshold = 1 << 16;
+
+		const char* LevelNames[] = {
+			"Debug",
+			"Info",
+			"Warn",
+			"Error",
+			"Test",
+			"Assert",
+			"Expect",
+			"########"
+		};
+
+		struct Format {
+			std::string mFile;
+			int32_t mLine = 0;
+			LogLevel mLevel = LogLevel::LogInfo;
+			std::string mFormat;
+			std::string mSignature;
+		};
+
+		std::mutex gFormatsMutex;
+		std::vector<Format> gFormats;
+
+		std::mutex gWriterMutex;
+		std::ofstream gWriter;
+		std::vector<unsigned char> gBuffer;
+		std::vector<bool> gWrittenFormats;
+
+		std::atomic_uint32_t gNextThreadId = 0;
+
+		uint32_t GetThreadId() {
+			thread_local uint32_t threadId = gNextThreadId++;
+			return threadId;
+		}
+
+		template<class T>
+		void Append(std::vector<unsigned char>& dst, const T& value) {
+			auto size = dst.size();
+			dst.resize(size + sizeof(T));
+			memcpy(dst.data() + size, &value, sizeof(T));
+		}
+
+		void AppendString(std::vector<unsigned char>& dst, std::string_view str) {
+			auto count = static_cast<uint16_t>(str.size() < 0xffff ? str.size() : 0xffff);
+			Append(dst, count);
+			dst.insert(dst.end(), str.data(), str.data() + count);
+		}
+
+		void FlushBuffer() {
+			if (gWriter.is_open() && !gBuffer.empty()) {
+				gWriter.write(reinterpret_cast<const char*>(gBuffer.data()), static_cast<std::streamsize>(gBuffer.size()));
+				gWriter.flush();
+			}
+			gBuffer.clear();
+		}
+
+		template<class T>
+		bool Read(std::istream& src, T& value) {
+			src.read(reinterpret_cast<char*>(&value), sizeof(T));
+			return src.gcount() == sizeof(T);
+		}
+
+		bool ReadString(std::istream& src, std::string& str) {
+			uint16_t count = 0;
+			if (!Read(src, count)) {
+				return false;
+			}
+			str.resize(count);
+			src.read(str.data(), count);
+			return src.gcount() == count;
+		}
+
+		template<class T>
+		bool Extract(const std::string& payload, size_t& pos, T& value) {
+			if (pos + sizeof(T) > payload.size()) {
+				return false;
+			}
+			memcpy(&value, payload.data() + pos, sizeof(T));
+			pos += sizeof(T);
+			return true;
+		}
+
+		bool RenderArgument(std::string& out, char type, char size, const std::string& payload, size_t& pos) {
+			switch (type) {
+			case 's': {
+				uint16_t count = 0;
+				if (!Extract(payload, pos, count) || pos + count > payload.size()) {
+					return false;
+				}
+				out.append(payload.data() + pos, count);
+				pos += count;
+				return true;
+			}
+			case 'b': {
+				bool value = false;
+				if (!Extract(payload, pos, value)) return false;
+				out += value ? "true" : "false";
+				return true;
+			}
+			case 'c': {
+				char value = 0;
+				if (!Extract(payload, pos, value)) return false;
+				out += value;
+				return true;
+			}
+			case 'f': {
+				double value = 0.0;
+				if (size == '4') {
+					float f = 0.0f;
+					if (!Extract(payload, pos, f)) return false;
+					value = static_cast<double>(f);
+				}
+				else if (size != '8' || !Extract(payload, pos, value)) {
+					return false;
+				}
+				std::ostringstream stream;
+				stream << value;
+				out += stream.str();
+				return true;
+			}
+			case 'i': {
+				int64_t value = 0;
+				switch (size) {
+				case '1': { int8_t v; if (!Extract(payload, pos, v)) return false; value = v; break; }
+				case '2': { int16_t v; if (!Extract(payload, pos, v)) return false; value = v; break; }
+				case '4': { int32_t v; if (!Extract(payload, pos, v)) return false; value = v; break; }
+				default: if (!Extract(payload, pos, value)) return false; break;
+				}
+				out += std::to_string(value);
+				return true;
+			}
+			case 'u': {
+				uint64_t value = 0;
+				switch (size) {
+				case '1': { uint8_t v; if (!Extract(payload, pos, v)) return false; value = v; break; }
+				case '2': { uint16_t v; if (!Extract(payload, pos, v)) return false; value = v; break; }
+				case '4': { uint32_t v; if (!Extract(payload, pos, v)) return false; value = v; break; }
+				default: if (!Extract(payload, pos, value)) return false; break;
+				}
+				out += std::to_string(value);
+				return true;
+			}
+			default:
+				return false;
+			}
+		}
+
+		std::string Render(const Format& format, uint32_t threadId, int64_t micros, const std::string& payload) {
+			auto seconds = static_cast<time_t>(micros / 1000000);
+			struct tm timeinfo = {};
+			l::string::convert_to_local_tm_from_utc_time(seconds, &timeinfo, true);
+
+			char prefix[64];
+			std::snprintf(prefix, sizeof(prefix), "<[%.4d-%.2d-%.2d %.2d:%.2d:%.2d.%.6d] ",
+				timeinfo.tm_year, timeinfo.tm_mon, timeinfo.tm_mday, timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec, static_cast<int>(micros % 1000000));
+
+			std::string out = prefix;
+			out += LevelNames[format.mLevel < 8 ? format.mLevel : 7];
+			out += "> ";
+			out += l::string::rcut(l::string::rcut(format.mFile, '/'), '\\');
+			out += "(" + std::to_string(format.mLine) + ") [" + std::to_string(threadId) + "] ";
+
+			size_t pos = 0;
+			size_t arg = 0;
+			size_t argCount = format.mSignature.size() / 2;
+			std::string_view fmt = format.mFormat;
+			for (size_t i = 0; i < fmt.size(); i++) {
+				if (fmt[i] == '{' && i + 1 < fmt.size() && fmt[i + 1] == '}' && arg < argCount) {
+					if (!RenderArgument(out, format.mSignature[arg * 2], format.mSignature[arg * 2 + 1], payload, pos)) {
+						out += "<truncated>";
+						return out;
+					}
+					arg++;
+					i++;
+				}
+				else {
+					out += fmt[i];
+				}
+			}
+			for (; arg < argCount; arg++) { // arguments without placeholders are appended
+				out += ' ';
+				if (!RenderArgument(out, format.mSignature[arg * 2], format.mSignature[arg * 2 + 1], payload, pos)) {
+					out += "<truncated>";
+					break;
+				}
+			}
+			return out;
+		}
+	}
+
+	bool OpenBinaryLog(std::string_view path) {
+		std::lock_guard<std::mutex> lock(gWriterMutex);
+		if (gWriter.is_open()) {
+			FlushBuffer();
+			gWriter.close();
+		}
+		gWriter.open(std::string(path), std::ios::binary | std::ios::trunc);
+		if (!gWriter.is_open()) {
+			gBinaryLogOpen = false;
+			return false;
+		}
+		gWrittenFormats.clear();
+		gBuffer.reserve(kFlushThreshold * 2);
+		Append(gBuffer, kBinaryLogIdentifier);
+		Append(gBuffer, kBinaryLogVersion);
+		gBinaryLogOpen = true;
+		return true;
+	}
+
+	void CloseBinaryLog() {
+		std::lock_guard<std::mutex> lock(gWriterMutex);
+		gBinaryLogOpen = false;
+		FlushBuffer();
+		if (gWriter.is_open()) {
+			gWriter.close();
+		}
+	}
+
+	void FlushBinaryLog() {
+		std::lock_guard<std::mutex> lock(gWriterMutex);
+		FlushBuffer();
+	}
+
+	uint32_t RegisterBinaryLogFormat(const char* file, int line, LogLevel level, std::string_view format, std::string signature) {
+		std::lock_guard<std::mutex> lock(gFormatsMutex);
+		gFormats.push_back(Format{ file, line, level, std::string(format), std::move(signature) });
+		return static_cast<uint32_t>(gFormats.size() - 1);
+	}
+
+	void WriteBinaryLogRecord(uint32_t formatId, const unsigned char* payload, size_t size) {
+		auto micros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+		auto threadId = GetThreadId();
+
+		std::lock_guard<std::mutex> lock(gWriterMutex);
+		if (!gWriter.is_open()) {
+			return;
+		}
+		if (formatId >= gWrittenFormats.size()) {
+			gWrittenFormats.resize(formatId + 1, false);
+		}
+		if (!gWrittenFormats[formatId]) {
+			gWrittenFormats[formatId] = true;
+
+			std::lock_guard<std::mutex> lockFormats(gFormatsMutex);
+			auto& format = gFormats.at(formatId);
+			Append(gBuffer, static_cast<uint8_t>(0));
+			Append(gBuffer, formatId);
+			Append(gBuffer, static_cast<uint8_t>(format.mLevel));
+			Append(gBuffer, format.mLine);
+			AppendString(gBuffer, format.mFile);
+			AppendString(gBuffer, format.mFormat);
+			AppendString(gBuffer, format.mSignature);
+		}
+
+		Append(gBuffer, static_cast<uint8_t>(1));
+		Append(gBuffer, formatId);
+		Append(gBuffer, threadId);
+		Append(gBuffer, static_cast<int64_t>(micros));
+		Append(gBuffer, static_cast<uint16_t>(size));
+		gBuffer.insert(gBuffer.end(), payload, payload + size);
+
+		if (gBuffer.size() >= kFlushThreshold) {
+			FlushBuffer();
+		}
+	}
+
+	bool DecodeBinaryLog(std::istream& src, std::function<void(std::string_view)> handler) {
+		uint32_t identifier = 0;
+		uint32_t version = 0;
+		if (!Read(src, identifier) || !Read(src, version) || identifier != kBinaryLogIdentifier || version > kBinaryLogVersion) {
+			return false;
+		}
+
+		std::vector<Format> formats;
+		std::string payload;
+		for (;;) {
+			uint8_t kind = 0;
+			if (!Read(src, kind)) {
+				return true;
+			}
+			uint32_t id = 0;
+			if (!Read(src, id)) {
+				return false;
+			}
+			if (kind == 0) {
+				Format format;
+				uint8_t level = 0;
+				if (!Read(src, level) || !Read(src, format.mLine) ||
+					!ReadString(src, format.mFile) || !ReadString(src, format.mFormat) || !ReadString(src, format.mSignature)) {
+					return false;
+				}
+				format.mLevel = static_cast<LogLevel>(level);
+				if (id >= formats.size()) {
+					formats.resize(id + 1);
+				}
+				formats.at(id) = std::move(format);
+			}
+			else if (kind == 1) {
+				uint32_t threadId = 0;
+				int64_t micros = 0;
+				if (!Read(src, threadId) || !Read(src, micros) || !ReadString(src, payload)) {
+					return false;
+				}
+				if (id >= formats.size()) {
+					return false;
+				}
+				handler(Render(formats.at(id), threadId, micros, payload));
+			}
+			else {
+				return false;
+			}
+		}
+	}
+
+	bool DecodeBinaryLogFile(std::string_view path, std::ostream& dst) {
+		std::ifstream src(std::string(path), std::ios::binary);
+		if (!src.is_open()) {
+			return false;
+		}
+		return DecodeBinaryLog(src, [&](std::string_view line) {
+			dst << line << "\n";
+			});
+	}
+}
@@ -1,4 +1,5 @@
 #include <logging/Log.h>
+#include <logging/String.h>
 
 #include <memory>
 #include <sstream>
@@ -16,35 +17,8 @@ namespace l {
 namespace logging {
 
 	size_t get_time_string(char* buffer, size_t maxSize) {
-		using namespace std::chrono;
-
-		auto n = system_clock::now();
-		auto tp = n.time_since_epoch();
-
-		auto micros = std::chrono::duration_cast<std::chrono::microseconds>(tp);
-		auto seconds = std::chrono::duration_cast<std::chrono::hours>(tp);
-		auto minutes = std::chrono::duration_cast<std::chrono::hours>(tp);
-		auto hours = std::chrono::duration_cast<std::chrono::hours>(tp);
-
-		const time_t now = system_clock::to_time_t(n);
-		struct tm newtime;
-#ifdef WIN32
-		localtime_s(&newtime, &now);
-#else
-		localtime_r(&now, &newtime);
-#endif
-		newtime.tm_year += 1900;
-		auto micro = static_cast<int>(micros.count() % 1000000);
-
-#ifdef __GNUC__
-#pragma GCC diagnostic push
-#pragma GCC diagnostic ignored "-Wformat-truncation"
-#endif
-		auto count = std::snprintf(buffer, maxSize, "%.2d-%.2d-%.2d %.2d:%.2d:%.2d.%.6d", newtime.tm_year, newtime.tm_mon, newtime.tm_mday, newtime.tm_hour, newtime.tm_min, newtime.tm_sec, micro);
-#ifdef __GNUC__
-#pragma GCC diagnostic pop
-#endif
-		return static_cast<size_t>(count);
+		auto micros = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::system_clock::now().time_since_epoch()).count();
+		return l::string::get_local_time_string_cached(buffer, maxSize, micros);
 	}
 
 	namespace {
@@ -70,15 +44,40 @@ namespace logging {
 		};
 
 		std::mutex gStreamMutex;
-		std::atomic<bool> mLogLevelOn[8] = { true, true, true, true, true, true, true, true };
+
+		bool gDeduplicate = false;
+		std::string gLastMessage;
+		uint32_t gRepeatCount = 0;
 
 		std::function<void(const std::string&)> LocalLogHandler = [](std::string_view msg) {
 			std::cout << msg << std::endl;
 		};
+
+		std::mutex gRateLimiterMutex;
+		std::vector<LogRateLimiter*> gRateLimiters;
+
+		// Called with the stream mutex held
+		void FlushRepeatCount() {
+			if (gRepeatCount > 0) {
+				LocalLogHandler("Last message repeated " + std::to_string(gRepeatCount) + " times");
+			}
+			gLastMessage.clear();
+			gRepeatCount = 0;
+		}
+
+		// Reports what is still pending when the process exits, declared last so it goes before the state above
+		struct LogFlusher {
+			~LogFlusher() {
+				FlushLog();
+			}
+		} gLogFlusher;
 	}
 
+	std::atomic_bool gLogLevelOn[8] = { true, true, true, true, true, true, true, true };
+
 	Logger::Logger(const logging::Logger& logger) {
 		mLevel = logger.mLevel;
+		mPrefixSize = logger.mPrefixSize;
 		mStream.str("");
 		mStream.clear();
 		mStream << logger.mStream.str();
@@ -112,6 +111,7 @@ namespace logging {
 			mStream << "<[";
 			mStream << timeview;
 			mStream << "] ";
+			mPrefixSize = static_cast<size_t>(mStream.tellp());
 			mStream << LogLevelStrings2.at(level);
 			mStream << "> ";
 			mStream << filename;
@@ -165,18 +165,101 @@ namespace logging {
 		}
 
 		if (!msg.empty()) {
-			if (mLogLevelOn[mLevel]) {
+			if (gLogLevelOn[mLevel]) {
 				std::lock_guard<std::mutex> lock(gStreamMutex);
+				if (gDeduplicate) {
+					auto body = std::string_view(msg).substr(mPrefixSize < msg.size() ? mPrefixSize : msg.size());
+					if (body == gLastMessage) {
+						gRepeatCount++;
+						return;
+					}
+					FlushRepeatCount();
+					gLastMessage = body;
+				}
 				LocalLogHandler(msg);
 			}
 		}
 	}
 
 	void SetLogLevelOn(LogLevel level, bool on) {
-		mLogLevelOn[level] = on;
+		gLogLevelOn[level] = on;
+	}
+
+	void SetLogDeduplication(bool on) {
+		std::lock_guard<std::mutex> lock(gStreamMutex);
+		FlushRepeatCount();
+		gDeduplicate = on;
+	}
+
+	void FlushLog() {
+		{
+			std::lock_guard<std::mutex> lock(gStreamMutex);
+			FlushRepeatCount();
+		}
+		std::lock_guard<std::mutex> lock(gRateLimiterMutex);
+		for (auto limiter : gRateLimiters) {
+			limiter->Flush();
+		}
+	}
+
+	LogRateLimiter::LogRateLimiter(const char* file, int line, int32_t maxCount, int32_t intervalMs) :
+		mFile(file),
+		mLine(line),
+		mMaxCount(maxCount < 1 ? 1 : maxCount),
+		mIntervalMs(intervalMs < 1 ? 1 : intervalMs)
+	{
+		std::lock_guard<std::mutex> lock(gRateLimiterMutex);
+		gRateLimiters.push_back(this);
+	}
+
+	LogRateLimiter::~LogRateLimiter() {
+		std::lock_guard<std::mutex> lock(gRateLimiterMutex);
+		Flush();
+		std::erase(gRateLimiters, this);
+	}
+
+	void LogRateLimiter::Flush() {
+		uint32_t suppressed = 0;
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			suppressed = mSuppressed;
+			mSuppressed = 0;
+		}
+		if (suppressed > 0) {
+			std::lock_guard<std::mutex> lock(gStreamMutex);
+			auto file = std::string_view(mFile);
+			file = file.substr(file.find_last_of("\\/") + 1);
+			LocalLogHandler("Suppressed " + std::to_string(suppressed) + " messages from " + std::string(file) + "(" + std::to_string(mLine) + ")");
+		}
+	}
+
+	LogSiteResult LogRateLimiter::Check() {
+		auto now = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+		std::lock_guard<std::mutex> lock(mMutex);
+		if (now - mWindowStart >= mIntervalMs) {
+			mWindowStart = now;
+			mCount = 0;
+		}
+		if (mCount < mMaxCount) {
+			mCount++;
+			auto suppressed = mSuppressed;
+			mSuppressed = 0;
+			return { true, suppressed };
+		}
+		mSuppressed++;
+		return { false, 0 };
+	}
+
+	std::ostream& operator<<(std::ostream& stream, const LogSuppressed& suppressed) {
+		if (suppressed.mCount > 0) {
+			stream << "[" << suppressed.mCount << " suppressed] ";
+		}
+		return stream;
 	}
 
 	void SetLocalLogHandler(std::function<void(std::string_view)> f) {
+		FlushLog();
 		std::lock_guard<std::mutex> lock(gStreamMutex);
 		LocalLogHandler = f;
 	}
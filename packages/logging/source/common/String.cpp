@@ -16,6 +16,18 @@
 #include <time.h>
 #include <atomic>
 #include <time.h>
+#include <bit>
+#include <deque>
+#include <shared_mutex>
+#include <unordered_map>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define L_STRING_SSE2
+#endif
 
 namespace {
 	constexpr size_t buffer_size = 1024;
@@ -138,7 +150,11 @@ namespace l::string {
 			timeinfo->tm_year += 1900;
 			timeinfo->tm_mon += 1;
 		}
+#ifdef WIN32
 		ASSERT(res == 0);
+#else
+		ASSERT(res != nullptr);
+#endif
 	}
 
 	int32_t get_unix_epoch() {
@@ -166,63 +182,13 @@ namespace l::string {
 	}
 
 	int32_t to_unix_time(std::string_view date) {
-		struct tm timeinfo = {};
-
-		int ret = 0;
-
-		if (date.size() > 10) {
-			ASSERT(date.size() == 19);
-#ifdef WIN32
-			ret = sscanf_s(date.data(), "%4d-%2d-%2d %2d:%2d:%2d",
-				&timeinfo.tm_year, &timeinfo.tm_mon, &timeinfo.tm_mday, &timeinfo.tm_hour, &timeinfo.tm_min, &timeinfo.tm_sec);
-#else
-			ret = sscanf(date.data(), "%4d-%2d-%2d %2d:%2d:%2d",
-				&timeinfo.tm_year, &timeinfo.tm_mon, &timeinfo.tm_mday, &timeinfo.tm_hour, &timeinfo.tm_min, &timeinfo.tm_sec);
-#endif
-			ASSERT(ret <= 6);
-		}
-		else {
-			ASSERT(date.size() == 10);
-#ifdef WIN32
-			ret = sscanf_s(date.data(), "%4d-%2d-%2d",
-				&timeinfo.tm_year, &timeinfo.tm_mon, &timeinfo.tm_mday);
-#else
-			ret = sscanf(date.data(), "%4d-%2d-%2d",
-				&timeinfo.tm_year, &timeinfo.tm_mon, &timeinfo.tm_mday);
-#endif
-			timeinfo.tm_hour = 0;
-			timeinfo.tm_min = 0;
-			timeinfo.tm_sec = 0;
-			ASSERT(ret <= 3);
-		}
-
-		// use _mkgmtime for gmt/utc time, use it when local time zone is unknown, for example in storage
-		// use mktime for local time zone presentation
-		bool adjustYearAndMonth = timeinfo.tm_year > 1000 ? true : false;
-		return static_cast<int32_t>(convert_to_time(&timeinfo, adjustYearAndMonth));
+		ASSERT(date.size() == 19 || date.size() == 10);
+		return parse_unix_time(date);
 	}
 
 	int32_t to_unix_time2(std::string_view date) {
-		struct tm timeinfo = {};
-
-		int ret = 0;
-		int microsec;
-
 		ASSERT(date.size() == 28);
-#ifdef WIN32
-		ret = sscanf_s(date.data(), "%4d-%2d-%2dT%2d:%2d:%2d.%7dZ",
-			&timeinfo.tm_year, &timeinfo.tm_mon, &timeinfo.tm_mday, &timeinfo.tm_hour, &timeinfo.tm_min, &timeinfo.tm_sec, &microsec);
-#else
-		ret = sscanf(date.data(), "%4d-%2d-%2dT%2d:%2d:%2d.%7dZ",
-			&timeinfo.tm_year, &timeinfo.tm_mon, &timeinfo.tm_mday, &timeinfo.tm_hour, &timeinfo.tm_min, &timeinfo.tm_sec, &microsec);
-#endif
-
-		ASSERT(ret <= 7);
-
-		// use _mkgmtime for gmt/utc time, use it when local time zone is unknown, for example in storage
-		// use mktime for local time zone presentation
-		bool adjustYearAndMonth = timeinfo.tm_year > 1000 ? true : false;
-		return static_cast<int32_t>(convert_to_time(&timeinfo, adjustYearAndMonth));
+		return parse_unix_time(date);
 	}
 
 	int32_t to_unix_time_from_local(const int32_t* dateAndTime) {
@@ -326,16 +292,213 @@ namespace l::string {
 		return static_cast<size_t>(count);
 	}
 
-	uint32_t string_id(std::string_view string) {
-		std::hash<std::string_view> hasher;
-		auto id = hasher(string);
-		return static_cast<uint32_t>(id);
+	size_t get_local_time_string_cached(char* buf, size_t maxSize, int64_t unixtimeMicros) {
+		struct Cache {
+			int64_t mSecond = INT64_MIN;
+			char mPrefix[32];
+			size_t mPrefixSize = 0;
+		};
+		thread_local Cache cache;
+
+		auto second = unixtimeMicros >= 0 ? unixtimeMicros / 1000000 : (unixtimeMicros - 999999) / 1000000;
+		auto micro = static_cast<int32_t>(unixtimeMicros - second * 1000000);
+
+		if (second != cache.mSecond) {
+			struct tm timeinfo = {};
+			convert_to_local_tm_from_utc_time(static_cast<time_t>(second), &timeinfo, true);
+			auto count = std::snprintf(cache.mPrefix, sizeof(cache.mPrefix), "%.4d-%.2d-%.2d %.2d:%.2d:%.2d.",
+				timeinfo.tm_year, timeinfo.tm_mon, timeinfo.tm_mday, timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec);
+			cache.mPrefixSize = count > 0 ? static_cast<size_t>(count) : 0;
+			cache.mSecond = second;
+		}
+
+		if (maxSize < cache.mPrefixSize + 7) {
+			return 0;
+		}
+		memcpy(buf, cache.mPrefix, cache.mPrefixSize);
+		char* digits = buf + cache.mPrefixSize;
+		for (int32_t i = 5; i >= 0; i--) {
+			digits[i] = static_cast<char>('0' + micro % 10);
+			micro /= 10;
+		}
+		digits[6] = 0;
+		return cache.mPrefixSize + 6;
+	}
+
+	namespace {
+		inline bool is_digit(char c) {
+			return static_cast<unsigned char>(c - '0') < 10;
+		}
+
+		// Reads exactly count digits at pos, returns -1 if any of them is not a digit
+		inline int32_t read_digits(std::string_view s, size_t pos, size_t count) {
+			if (pos + count > s.size()) {
+				return -1;
+			}
+			int32_t value = 0;
+			for (size_t i = pos; i < pos + count; i++) {
+				if (!is_digit(s[i])) {
+					return -1;
+				}
+				value = value * 10 + (s[i] - '0');
+			}
+			return value;
+		}
+	}
+
+	bool parse_unix_time_ms(std::string_view date, int64_t& unixtimeMs) {
+		unixtimeMs = 0;
+
+		size_t numDigits = 0;
+		while (numDigits < date.size() && is_digit(date[numDigits])) {
+			numDigits++;
+		}
+		if (numDigits > 0 && numDigits == date.size() && (numDigits <= 10 || numDigits == 13)) {
+			int64_t value = 0;
+			for (auto c : date) {
+				value = value * 10 + (c - '0');
+			}
+			unixtimeMs = numDigits == 13 ? value : value * 1000;
+			return true;
+		}
+
+		auto year = read_digits(date, 0, 4);
+		auto month = read_digits(date, 5, 2);
+		auto day = read_digits(date, 8, 2);
+		if (year < 0 || month < 1 || month > 12 || day < 1 || day > 31 || date[4] != '-' || date[7] != '-') {
+			return false;
+		}
+		int64_t seconds = days_from_civil(year, month, day) * 86400;
+		int64_t millis = 0;
+
+		if (date.size() >= 16 && (date[10] == ' ' || date[10] == 'T') && date[13] == ':') {
+			auto hour = read_digits(date, 11, 2);
+			auto min = read_digits(date, 14, 2);
+			if (hour < 0 || min < 0) {
+				return false;
+			}
+			seconds += hour * 3600 + min * 60;
+
+			size_t pos = 16;
+			if (date.size() >= 19 && date[16] == ':') {
+				auto sec = read_digits(date, 17, 2);
+				if (sec < 0) {
+					return false;
+				}
+				seconds += sec;
+				pos = 19;
+			}
+			if (pos < date.size() && (date[pos] == '.' || date[pos] == ',')) {
+				pos++;
+				int32_t scale = 100;
+				for (; pos < date.size() && is_digit(date[pos]); pos++) {
+					millis += (date[pos] - '0') * scale;
+					scale /= 10;
+				}
+			}
+			if (pos < date.size() && (date[pos] == '+' || date[pos] == '-')) {
+				auto offsetHour = read_digits(date, pos + 1, 2);
+				auto offsetMin = pos + 3 < date.size() && date[pos + 3] == ':' ? read_digits(date, pos + 4, 2) : read_digits(date, pos + 3, 2);
+				if (offsetHour >= 0) {
+					auto offset = offsetHour * 3600 + (offsetMin > 0 ? offsetMin * 60 : 0);
+					seconds += date[pos] == '+' ? -offset : offset;
+				}
+			}
+		}
+
+		unixtimeMs = seconds * 1000 + millis;
+		return true;
+	}
+
+	int32_t parse_unix_time(std::string_view date) {
+		int64_t unixtimeMs = 0;
+		parse_unix_time_ms(date, unixtimeMs);
+		return static_cast<int32_t>(unixtimeMs >= 0 ? unixtimeMs / 1000 : (unixtimeMs - 999) / 1000);
 	}
 
-	uint32_t string_id(const std::string& string) {
-		std::hash<std::string> hasher;
-		auto id = hasher(string);
-		return static_cast<uint32_t>(id);
+	size_t parse_unix_times(std::span<const std::string_view> dates, std::span<int32_t> unixtimes) {
+		auto count = dates.size() < unixtimes.size() ? dates.size() : unixtimes.size();
+		size_t parsed = 0;
+		for (size_t i = 0; i < count; i++) {
+			int64_t unixtimeMs = 0;
+			if (parse_unix_time_ms(dates[i], unixtimeMs)) {
+				parsed++;
+			}
+			unixtimes[i] = static_cast<int32_t>(unixtimeMs >= 0 ? unixtimeMs / 1000 : (unixtimeMs - 999) / 1000);
+		}
+		return parsed;
+	}
+
+	size_t parse_unix_times_ms(std::span<const std::string_view> dates, std::span<int64_t> unixtimesMs) {
+		auto count = dates.size() < unixtimesMs.size() ? dates.size() : unixtimesMs.size();
+		size_t parsed = 0;
+		for (size_t i = 0; i < count; i++) {
+			if (parse_unix_time_ms(dates[i], unixtimesMs[i])) {
+				parsed++;
+			}
+		}
+		return parsed;
+	}
+
+	namespace {
+		struct symbol_hash {
+			size_t operator()(std::string_view string) const {
+				return static_cast<size_t>(fnv1a_64(string));
+			}
+		};
+
+		struct symbol_table {
+			std::shared_mutex mMutex;
+			std::deque<std::string> mNames; // deque keeps the strings (and views into them) in place when growing
+			std::unordered_map<std::string_view, uint32_t, symbol_hash> mIds;
+		};
+
+		symbol_table& get_symbol_table() {
+			static symbol_table table;
+			return table;
+		}
+	}
+
+	uint32_t intern(std::string_view string) {
+		auto& table = get_symbol_table();
+		{
+			std::shared_lock<std::shared_mutex> lock(table.mMutex);
+			auto it = table.mIds.find(string);
+			if (it != table.mIds.end()) {
+				return it->second;
+			}
+		}
+		std::unique_lock<std::shared_mutex> lock(table.mMutex);
+		auto it = table.mIds.find(string);
+		if (it != table.mIds.end()) {
+			return it->second;
+		}
+		auto& name = table.mNames.emplace_back(string);
+		auto symbol = static_cast<uint32_t>(table.mNames.size());
+		table.mIds.emplace(std::string_view(name), symbol);
+		return symbol;
+	}
+
+	uint32_t find_symbol(std::string_view string) {
+		auto& table = get_symbol_table();
+		std::shared_lock<std::shared_mutex> lock(table.mMutex);
+		auto it = table.mIds.find(string);
+		return it != table.mIds.end() ? it->second : 0;
+	}
+
+	std::string_view symbol_name(uint32_t symbol) {
+		auto& table = get_symbol_table();
+		std::shared_lock<std::shared_mutex> lock(table.mMutex);
+		if (symbol == 0 || symbol > table.mNames.size()) {
+			return {};
+		}
+		return table.mNames[symbol - 1];
+	}
+
+	size_t symbol_count() {
+		auto& table = get_symbol_table();
+		std::shared_lock<std::shared_mutex> lock(table.mMutex);
+		return table.mNames.size();
 	}
 
 	std::string encode_html(const std::string& input) {
@@ -483,30 +646,119 @@ namespace l::string {
 			}
 		};
 
-		bool escape = false;
-		auto start = text.begin();
-		for (auto it = text.begin(); it != text.end(); it++) {
-			if (*it == escapeChar) {
-				insert(&*start, it - start);
-				start = it + 1;
+		std::string delimAndEscape(delim);
+		delimAndEscape += escapeChar;
+		delimiter_set delimiters(delimAndEscape);
 
+		bool escape = false;
+		size_t start = 0;
+		size_t i = 0;
+		for (;;) {
+			// inside an escaped section only the escape character ends the token
+			i = escape ? text.find(escapeChar, i) : delimiters.find(text, i);
+			if (i >= text.size()) {
+				break;
+			}
+			insert(text.data() + start, i - start);
+			start = i + 1;
+			if (text[i] == escapeChar) {
 				escape = !escape;
 			}
-			else if(!escape){
-				for (auto it2 = delim.begin(); it2 != delim.end(); it2++) {
-					if (*it == *it2) {
-						insert(&*start, it - start);
-						start = it + 1;
-						break;
-					}
+			i++;
+		}
+		if (start < text.size()) {
+			insert(text.data() + start, text.size() - start);
+		}
+
+		return out;
+	}
+
+	delimiter_set::delimiter_set(std::string_view delim) {
+		for (auto c : delim) {
+			if (mTable[static_cast<unsigned char>(c)]) {
+				continue;
+			}
+			mTable[static_cast<unsigned char>(c)] = true;
+			if (mCount < mChars.size()) {
+				mChars[mCount] = c;
+			}
+			mCount++;
+		}
+	}
+
+	size_t delimiter_set::find(std::string_view text, size_t pos) const {
+		const char* data = text.data();
+		const char* p = data + (pos < text.size() ? pos : text.size());
+		const char* end = data + text.size();
+
+		if (mCount > 0 && mCount <= mChars.size()) {
+#if defined(__AVX2__)
+			while (end - p >= 32) {
+				__m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+				__m256i m = _mm256_cmpeq_epi8(v, _mm256_set1_epi8(mChars[0]));
+				for (size_t i = 1; i < mCount; i++) {
+					m = _mm256_or_si256(m, _mm256_cmpeq_epi8(v, _mm256_set1_epi8(mChars[i])));
+				}
+				auto mask = static_cast<uint32_t>(_mm256_movemask_epi8(m));
+				if (mask != 0) {
+					return static_cast<size_t>(p - data) + std::countr_zero(mask);
 				}
+				p += 32;
 			}
+#endif
+#if defined(L_STRING_SSE2)
+			while (end - p >= 16) {
+				__m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+				__m128i m = _mm_cmpeq_epi8(v, _mm_set1_epi8(mChars[0]));
+				for (size_t i = 1; i < mCount; i++) {
+					m = _mm_or_si128(m, _mm_cmpeq_epi8(v, _mm_set1_epi8(mChars[i])));
+				}
+				auto mask = static_cast<uint32_t>(_mm_movemask_epi8(m));
+				if (mask != 0) {
+					return static_cast<size_t>(p - data) + std::countr_zero(mask);
+				}
+				p += 16;
+			}
+#endif
 		}
-		if (start < text.end()) {
-			insert(&*start, text.end() - start);
+		for (; p < end; p++) {
+			if (mTable[static_cast<unsigned char>(*p)]) {
+				return static_cast<size_t>(p - data);
+			}
 		}
+		return text.size();
+	}
 
-		return out;
+	size_t find_first_of(std::string_view text, std::string_view delim, size_t pos) {
+		return delimiter_set(delim).find(text, pos);
+	}
+
+	bool tokenizer::next(std::string_view& token) {
+		while (!mDone) {
+			auto i = mDelimiters.find(mText, mPos);
+			token = std::string_view(mText.data() + mPos, i - mPos);
+			if (i >= mText.size()) {
+				mDone = true;
+				mPos = mText.size();
+			}
+			else {
+				mPos = i + 1;
+			}
+			if (!mSkipEmpty || !token.empty()) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	size_t split_into(std::string_view text, std::span<std::string_view> dst, std::string_view delim, bool skipEmpty) {
+		tokenizer tokens(text, delim, skipEmpty);
+		size_t count = 0;
+		std::string_view token;
+		while (count < dst.size() && tokens.next(token)) {
+			dst[count++] = token;
+		}
+		return count;
 	}
 
 	std::string narrow(const std::wstring& str) {
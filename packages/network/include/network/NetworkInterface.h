@@ -3,10 +3,12 @@
 #include "network/NetworkManager.h"
 #include "network/NetworkHostInfo.h"
 
+#include "logging/String.h"
+
 #include <cstdint>
 #include <memory>
 #include <filesystem>
-#include <map>
+#include <unordered_map>
 #include <functional>
 
 namespace l::network {
@@ -45,7 +47,7 @@ namespace l::network {
 		) {
 			auto network = mNetworkManager.lock();
 			if (network) {
-				auto it = mInterfaces.find(interfaceName.data());
+				auto it = mInterfaces.find(l::string::find_symbol(interfaceName));
 				if (it != mInterfaces.end()) {
 					it->second.AddEndpoint(queryName, endpointString);
 
@@ -71,7 +73,7 @@ namespace l::network {
 		void SetNetworkStatus(std::string_view interfaceName, bool isup);
 
 		std::weak_ptr<l::network::NetworkManager> mNetworkManager;
-		std::map<std::string, HostInfo> mInterfaces;
+		std::unordered_map<uint32_t, HostInfo> mInterfaces; // keyed by interned interface name
 	};
 
 	std::shared_ptr<NetworkInterface> CreateNetworkInterface(std::weak_ptr<l::network::NetworkManager> networkManager);
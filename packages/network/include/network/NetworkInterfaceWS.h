@@ -3,10 +3,12 @@
 #include "network/NetworkManager.h"
 #include "network/NetworkHostInfo.h"
 
+#include "logging/String.h"
+
 #include <cstdint>
 #include <memory>
 #include <filesystem>
-#include <map>
+#include <unordered_map>
 #include <functional>
 #include <deque>
 
@@ -49,7 +51,7 @@ namespace l::network {
 		) {
 			auto network = mNetworkManager.lock();
 			if (network) {
-				auto it = mInterfaces.find(interfaceName.data());
+				auto it = mInterfaces.find(l::string::find_symbol(interfaceName));
 				if (it != mInterfaces.end()) {
 					it->second.AddEndpoint(interfaceName, endpointString);
 					network->CreateRequest(std::make_unique<l::network::WebSocket>(interfaceName, "", 0, handler));
@@ -61,7 +63,7 @@ namespace l::network {
 		void SetNetworkStatus(std::string_view interfaceName, bool isup);
 
 		std::weak_ptr<l::network::NetworkManager> mNetworkManager;
-		std::map<std::string, HostInfo> mInterfaces;
+		std::unordered_map<uint32_t, HostInfo> mInterfaces; // keyed by interned interface name
 	};
 
 	std::shared_ptr<NetworkInterfaceWS> CreateNetworkInterfaceWS(std::weak_ptr<l::network::NetworkManager> networkManager);
@@ -135,7 +135,7 @@ namespace l::network {
 #endif
 			auto curlMCode = curl_multi_add_handle(multiHandle, mCurl);
 			if (curlMCode != CURLMcode::CURLM_OK) {
-				LOG(LogError) << "Curl failure  " << std::to_string(curlMCode) << ": " << mRequestQueryArgs;
+				LOG_RATE_LIMITED(LogError, 10, 1000) << "Curl failure  " << std::to_string(curlMCode) << ": " << mRequestQueryArgs;
 				mSuccess = false;
 			}
 		}
@@ -143,7 +143,7 @@ namespace l::network {
 			auto curlCode = curl_easy_perform(mCurl);
 			//curl_easy_header()
 			if (curlCode != CURLE_OK) {
-				LOG(LogError) << "Curl failure  " << std::to_string(curlCode) << ": " << mRequestQueryArgs;
+				LOG_RATE_LIMITED(LogError, 10, 1000) << "Curl failure  " << std::to_string(curlCode) << ": " << mRequestQueryArgs;
 				mSuccess = false;
 			}
 		}
@@ -253,12 +253,12 @@ namespace l::network {
 	int32_t ConnectionBase::WSWrite(const char* buffer, size_t size) {
 		if (HasExpired()) {
 			mWebSocketCanSendData = false;
-			LOG(LogError) << "Failed wss write, connection expired";
+			LOG_RATE_LIMITED(LogError, 10, 1000) << "Failed wss write, connection expired";
 			return -101;
 		}
 		if (mCurl == nullptr) {
 			mWebSocketCanSendData = false;
-			LOG(LogError) << "Failed wss write, no curl instance";
+			LOG_RATE_LIMITED(LogError, 10, 1000) << "Failed wss write, no curl instance";
 			return -102;
 		}
 		size_t sentBytes = 0;
@@ -290,12 +290,12 @@ namespace l::network {
 	int32_t ConnectionBase::WSRead(char* buffer, size_t size) {
 		if (HasExpired()) {
 			mWebSocketCanReceiveData = false;
-			LOG(LogError) << "Failed wss read, connection expired";
+			LOG_RATE_LIMITED(LogError, 10, 1000) << "Failed wss read, connection expired";
 			return -101;
 		}
 		if (mCurl == nullptr) {
 			mWebSocketCanReceiveData = false;
-			LOG(LogError) << "Failed wss read, no curl instance";
+			LOG_RATE_LIMITED(LogError, 10, 1000) << "Failed wss read, no curl instance";
 			return -102;
 		}
 		int32_t maxTries = 3;
@@ -15,7 +15,7 @@ namespace l::network {
 		std::string_view host, 
 		uint32_t port, 
 		int32_t networkStatusInterval) {
-		if (!mInterfaces.contains(interfaceName.data())) {
+		if (!mInterfaces.contains(l::string::find_symbol(interfaceName))) {
 			auto pingHandler = [&, name = std::string(interfaceName)](bool success, std::string_view, l::network::RequestStringStream&) {
 				SetNetworkStatus(name, success);
 				if (success) {
@@ -24,7 +24,7 @@ namespace l::network {
 				return l::concurrency::RunnableResult::FAILURE;
 				};
 
-			mInterfaces.emplace(std::string(interfaceName), HostInfo(protocol, host, port, networkStatusInterval) );
+			mInterfaces.emplace(l::string::intern(interfaceName), HostInfo(protocol, host, port, networkStatusInterval) );
 
 			std::string queryName = interfaceName.data();
 			queryName += "Ping";
@@ -45,7 +45,7 @@ namespace l::network {
 		std::function<void(bool, std::string_view)> cb) {
 
 		bool result = false;
-		auto it = mInterfaces.find(interfaceName.data());
+		auto it = mInterfaces.find(l::string::find_symbol(interfaceName));
 		if (it != mInterfaces.end()) {
 			if (NetworkStatus(interfaceName)) {
 				auto query = it->second.GetQuery(queryName, queryArguments);
@@ -61,7 +61,7 @@ namespace l::network {
 	}
 
 	bool NetworkInterface::NetworkStatus(std::string_view interfaceName) {
-		auto it = mInterfaces.find(interfaceName.data());
+		auto it = mInterfaces.find(l::string::find_symbol(interfaceName));
 		if (it != mInterfaces.end()) {
 			return it->second.Status();
 		}
@@ -69,7 +69,7 @@ namespace l::network {
 	}
 
 	void NetworkInterface::SetNetworkStatus(std::string_view interfaceName, bool isup) {
-		auto it = mInterfaces.find(interfaceName.data());
+		auto it = mInterfaces.find(l::string::find_symbol(interfaceName));
 		if (it != mInterfaces.end()) {
 			it->second.SetStatus(isup);
 		}
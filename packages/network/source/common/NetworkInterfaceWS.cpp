@@ -15,8 +15,8 @@ namespace l::network {
 		std::string_view host, 
 		uint32_t port, 
 		int32_t networkStatusInterval) {
-		if (!mInterfaces.contains(interfaceName.data())) {
-			mInterfaces.emplace(std::string(interfaceName), HostInfo(protocol, host, port, networkStatusInterval) );
+		if (!mInterfaces.contains(l::string::find_symbol(interfaceName))) {
+			mInterfaces.emplace(l::string::intern(interfaceName), HostInfo(protocol, host, port, networkStatusInterval) );
 		}
 	}
 
@@ -41,7 +41,7 @@ namespace l::network {
 		std::function<void(bool, std::string_view)> cb) {
 
 		bool result = false;
-		auto it = mInterfaces.find(interfaceName.data());
+		auto it = mInterfaces.find(l::string::find_symbol(interfaceName));
 		if (it != mInterfaces.end()) {
 			if (NetworkStatus(interfaceName)) {
 				auto query = it->second.GetQuery(interfaceName);
@@ -58,7 +58,7 @@ namespace l::network {
 
 	int32_t NetworkInterfaceWS::Read(std::string_view interfaceName, char* buffer, size_t size) {
 		int32_t read = 0;
-		auto it = mInterfaces.find(interfaceName.data());
+		auto it = mInterfaces.find(l::string::find_symbol(interfaceName));
 		if (it != mInterfaces.end()) {
 			if (NetworkStatus(interfaceName)) {
 				auto networkManager = mNetworkManager.lock();
@@ -71,7 +71,7 @@ namespace l::network {
 	}
 
 	int32_t NetworkInterfaceWS::NumQueued(std::string_view interfaceName) {
-		auto it = mInterfaces.find(interfaceName.data());
+		auto it = mInterfaces.find(l::string::find_symbol(interfaceName));
 		if (it != mInterfaces.end()) {
 			if (NetworkStatus(interfaceName)) {
 				auto networkManager = mNetworkManager.lock();
@@ -85,7 +85,7 @@ namespace l::network {
 	}
 
 	void NetworkInterfaceWS::SendQueued(std::string_view interfaceName, int32_t maxQueued) {
-		auto it = mInterfaces.find(interfaceName.data());
+		auto it = mInterfaces.find(l::string::find_symbol(interfaceName));
 		if (it != mInterfaces.end()) {
 			if (NetworkStatus(interfaceName)) {
 				auto networkManager = mNetworkManager.lock();
@@ -98,7 +98,7 @@ namespace l::network {
 							queue.pop_front();
 						}
 						else {
-							LOG(LogWarning) << "Failed to write to: " << interfaceName << " : error: " << written;
+							LOG_RATE_LIMITED(LogWarning, 10, 1000) << "Failed to write to: " << interfaceName << " : error: " << written;
 						}
 						maxQueued--;
 					}
@@ -108,7 +108,7 @@ namespace l::network {
 	}
 
 	void NetworkInterfaceWS::ClearQueued(std::string_view interfaceName) {
-		auto it = mInterfaces.find(interfaceName.data());
+		auto it = mInterfaces.find(l::string::find_symbol(interfaceName));
 		if (it != mInterfaces.end()) {
 			if (NetworkStatus(interfaceName)) {
 				auto& queue = it->second.GetQueue();
@@ -118,7 +118,7 @@ namespace l::network {
 	}
 
 	void NetworkInterfaceWS::QueueWrite(std::string_view interfaceName, const char* buffer, size_t size) {
-		auto it = mInterfaces.find(interfaceName.data());
+		auto it = mInterfaces.find(l::string::find_symbol(interfaceName));
 		if (it != mInterfaces.end()) {
 			if (NetworkStatus(interfaceName)) {
 				auto& queue = it->second.GetQueue();
@@ -129,14 +129,14 @@ namespace l::network {
 
 	int32_t NetworkInterfaceWS::Write(std::string_view interfaceName, const char* buffer, size_t size) {
 		int32_t written = 0;
-		auto it = mInterfaces.find(interfaceName.data());
+		auto it = mInterfaces.find(l::string::find_symbol(interfaceName));
 		if (it != mInterfaces.end()) {
 			if (NetworkStatus(interfaceName)) {
 				auto networkManager = mNetworkManager.lock();
 				if (networkManager) {
 					written = networkManager->WSWrite(interfaceName, buffer, size) >= 0;
 					if (written < 0) {
-						LOG(LogWarning) << "Failed to write to: " << interfaceName << " : error: " << written;
+						LOG_RATE_LIMITED(LogWarning, 10, 1000) << "Failed to write to: " << interfaceName << " : error: " << written;
 					}
 				}
 			}
@@ -145,7 +145,7 @@ namespace l::network {
 	}
 
 	bool NetworkInterfaceWS::IsConnected(std::string_view interfaceName) {
-		auto it = mInterfaces.find(interfaceName.data());
+		auto it = mInterfaces.find(l::string::find_symbol(interfaceName));
 		if (it != mInterfaces.end()) {
 			auto networkManager = mNetworkManager.lock();
 			if (networkManager) {
@@ -156,7 +156,7 @@ namespace l::network {
 	}
 
 	bool NetworkInterfaceWS::NetworkStatus(std::string_view interfaceName) {
-		auto it = mInterfaces.find(interfaceName.data());
+		auto it = mInterfaces.find(l::string::find_symbol(interfaceName));
 		if (it != mInterfaces.end()) {
 			return it->second.Status();
 		}
@@ -164,7 +164,7 @@ namespace l::network {
 	}
 
 	void NetworkInterfaceWS::SetNetworkStatus(std::string_view interfaceName, bool isup) {
-		auto it = mInterfaces.find(interfaceName.data());
+		auto it = mInterfaces.find(l::string::find_symbol(interfaceName));
 		if (it != mInterfaces.end()) {
 			it->second.SetStatus(isup);
 		}
@@ -46,7 +46,7 @@ namespace l::nodegraph {
             mInputs.clear();
             mOutputs.clear();
 
-            LOG(LogInfo) << "Node graph base destroyed";
+            LOG_RATE_LIMITED(LogInfo, 10, 1000) << "Node graph base destroyed";
         }
 
         NodeGraphBase& operator=(NodeGraphBase&& other) noexcept {
@@ -186,7 +186,7 @@ namespace l::nodegraph {
             mName(name)
         {}
         virtual ~NodeGraphOp() {
-            LOG(LogInfo) << "Node operation destroyed";
+            LOG_RATE_LIMITED(LogInfo, 10, 1000) << "Node operation destroyed";
         }
 
         NodeGraphOp& operator=(NodeGraphOp&& other) noexcept {
@@ -265,7 +265,7 @@ namespace l::nodegraph {
         {
         }
         virtual ~NodeGraphOpCached() {
-            LOG(LogInfo) << "Buffered operation destroyed";
+            LOG_RATE_LIMITED(LogInfo, 10, 1000) << "Buffered operation destroyed";
         }
 
         NodeGraphOpCached& operator=(NodeGraphOpCached&& other) noexcept {
@@ -308,7 +308,7 @@ namespace l::nodegraph {
             DefaultDataInit();
         }
         virtual ~NodeGraph() {
-            LOG(LogInfo) << "Node destroyed";
+            LOG_RATE_LIMITED(LogInfo, 10, 1000) << "Node destroyed";
         }
 
         NodeGraph& operator=(NodeGraph&& other) noexcept {
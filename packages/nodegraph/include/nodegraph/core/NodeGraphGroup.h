@@ -48,7 +48,7 @@ namespace l::nodegraph {
         }
         ~NodeGraphGroup() {
             Reset();
-            LOG(LogInfo) << "Node group destroyed";
+            LOG_RATE_LIMITED(LogInfo, 10, 1000) << "Node group destroyed";
         }
 
         NodeGraphGroup& operator=(NodeGraphGroup&& other) noexcept {
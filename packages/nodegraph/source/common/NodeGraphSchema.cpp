@@ -103,12 +103,15 @@ namespace l::nodegraph {
             mStringId = GetStringId();
         }
 
+        std::string json;
+        json.reserve(1 << 16);
         l::serialization::JsonBuilder builder(true);
+        builder.SetBuffer(&json);
         GetArchiveData(builder);
 
         l::filesystem::File dataFile(file);
         dataFile.modeBinary().modeWriteTrunc();
-        if (dataFile.open() && dataFile.write(builder.GetStream()) > 0) {
+        if (dataFile.open() && dataFile.write(json.data(), json.size()) > 0) {
             LOG(LogInfo) << "Created " << file;
             return true;
         }
@@ -138,17 +141,17 @@ namespace l::nodegraph {
                 }
 
                 if (nodeGraphSchema.has_key("Name")) {
-                    mName = nodeGraphSchema.get("Name").as_string();
+                    mName = nodeGraphSchema.get("Name").as_unescaped_string();
                 }
                 if (nodeGraphSchema.has_key("TypeName")) {
-                    mTypeName = nodeGraphSchema.get("TypeName").as_string();
+                    mTypeName = nodeGraphSchema.get("TypeName").as_unescaped_string();
                 }
                 if (nodeGraphSchema.has_key("FileName")) {
-                    mFileName = nodeGraphSchema.get("FileName").as_string();
+                    mFileName = nodeGraphSchema.get("FileName").as_unescaped_string();
                 }
                 mStringId = 0;
                 if (nodeGraphSchema.has_key("FullPath")) {
-                    mFullPath = nodeGraphSchema.get("FullPath").as_string();
+                    mFullPath = nodeGraphSchema.get("FullPath").as_unescaped_string();
                     if (nodeGraphSchema.has_key("StringId")) {
                         mStringId = nodeGraphSchema.get("StringId").as_uint32();
                     }
@@ -104,7 +104,7 @@ namespace l::nodegraph {
                                                     }
                                                 }
                                                 else if (data.has_key("Text")) {
-                                                    auto text= data.get("Text").as_string();
+                                                    auto text = data.get("Text").as_unescaped_string();
                                                     if (!node->SetInput(channel, text)) {
                                                         LOG(LogError) << "Failed to set channel text data";
                                                     }
@@ -6,6 +6,7 @@
 #include "filesystem/File.h"
 #include "logging/String.h"
 
+#include <cstring>
 #include <functional>
 #include <mutex>
 #include <unordered_map>
@@ -80,7 +81,7 @@ namespace rendering {
 			sourceNode.mFloatArray.mId = id;
 			sourceNode.mFloatArray.mCount = count;
 			sourceNode.mFloatArray.mFloatArray.reserve(count);
-			string::cstring_to_numbers<float>(content, count, ' ', sourceNode.mFloatArray.mFloatArray);
+			string::cstring_to_numbers<float>(content, std::strlen(content), count, ' ', sourceNode.mFloatArray.mFloatArray);
 		}
 		else if (string::equal(node.parent().parent().name(), "source")
 			&& string::equal(node.parent().name(), "technique_common")
@@ -129,7 +130,7 @@ namespace rendering {
 			//auto& trianglesNode = mColladaNodes.mGeometryNodes.back().mTrianglesNodes.back();
 			//auto content = node.text().as_string();
 			//trianglesNode.mIndiceCountPerPrimitive.reserve(trianglesNode.mIndicesCount);
-			//string::cstring_to_numbers<uint32_t>(content, trianglesNode.mIndicesCount, ' ', trianglesNode.mIndiceCountPerPrimitive);
+			//string::cstring_to_numbers<uint32_t>(content, std::strlen(content), trianglesNode.mIndicesCount, ' ', trianglesNode.mIndiceCountPerPrimitive);
 			//for (int i = 0; i < trianglesNode.mIndiceCountPerPrimitive.size();i++) {
 			//	ASSERT(trianglesNode.mIndiceCountPerPrimitive[i] == 3) << "Collada mesh contains non-triangles and there is no converter yet";
 			//}
@@ -141,7 +142,7 @@ namespace rendering {
 			auto& trianglesNode = mColladaNodes.mGeometryNodes.back().mTrianglesNodes.back();
 			auto content = node.text().as_string();
 			trianglesNode.mIndices.reserve(trianglesNode.mIndicesCount);
-			string::cstring_to_numbers<uint32_t>(content, trianglesNode.mIndicesCount, ' ', trianglesNode.mIndices);
+			string::cstring_to_numbers<uint32_t>(content, std::strlen(content), trianglesNode.mIndicesCount, ' ', trianglesNode.mIndices);
 		}
 
 		return true;
@@ -2,13 +2,29 @@
 
 #include <string>
 #include <string_view>
+#include <span>
 #include <vector>
 #include <sstream>
 #include <unordered_map>
 
 #include "logging/String.h"
+#include "serialization/Codec.h"
 
 namespace l::serialization {
+	constexpr size_t base16_encoded_size(size_t len) {
+		return len * 2;
+	}
+
+	constexpr size_t base16_decoded_size(size_t len) {
+		return len / 2;
+	}
+
+	// Encodes into dst without allocating, returns the number of characters written or 0 if dst is too small
+	size_t base16_encode(std::span<const unsigned char> src, std::span<char> dst, bool tolowercase = true);
+
+	// Accepts both cases. An odd length is reported as an error at the last character.
+	CodecResult base16_decode(std::string_view src, std::span<unsigned char> dst);
+
 	std::string base16_encode(unsigned char* src, size_t len, bool tolowercase = true);
 	void base16_decode(unsigned char* dst, std::string_view src);
 
@@ -1,13 +1,32 @@
 #pragma once
 
 #include <string>
+#include <string_view>
+#include <span>
 #include <vector>
 #include <sstream>
 #include <unordered_map>
 
 #include "logging/String.h"
+#include "serialization/Codec.h"
 
 namespace l::serialization {
+	constexpr size_t base64_encoded_size(size_t len) {
+		return (len + 2) / 3 * 4;
+	}
+
+	// Upper bound, padding makes the actual size up to two bytes smaller
+	constexpr size_t base64_decoded_size(size_t len) {
+		return (len + 3) / 4 * 3;
+	}
+
+	// Encodes into dst without allocating, returns the number of characters written or 0 if dst is too small
+	size_t base64_encode(std::span<const unsigned char> src, std::span<char> dst);
+
+	// Strict decode: only the standard alphabet, '=' padding only at the end and no white space. Unpadded input is
+	// accepted. Running out of space in dst is reported as an error at the first input character that didn't fit.
+	CodecResult base64_decode(std::string_view src, std::span<unsigned char> dst);
+
 	std::string base64_encode(unsigned char* src, size_t len);
 	void base64_decode(unsigned char* dst, std::string_view src);
 
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstddef>
+#include <limits>
+
+namespace l::serialization {
+
+	// Outcome of a decode into a caller provided buffer. On failure mSize bytes (everything before the offending
+	// character) have been written and mErrorPosition is the offset of that character in the input.
+	struct CodecResult {
+		static constexpr size_t kNoError = std::numeric_limits<size_t>::max();
+
+		size_t mSize = 0;
+		size_t mErrorPosition = kNoError;
+
+		bool valid() const {
+			return mErrorPosition == kNoError;
+		}
+	};
+}
@@ -3,9 +3,14 @@
 #include "logging/String.h"
 
 #include <string>
+#include <string_view>
 #include <vector>
 #include <sstream>
 #include <deque>
+#include <span>
+#include <charconv>
+#include <functional>
+#include <type_traits>
 
 
 namespace l::serialization {
@@ -19,8 +24,19 @@ namespace l::serialization {
         ~JsonBuilder() = default;
 
         void SetStream(std::stringstream* stream);
+        // Buffer modes, output is appended to the buffer so a reused buffer doesn't allocate once it has grown
+        // large enough. A fixed span never grows, HasOverflow() reports if output was dropped.
+        void SetBuffer(std::string* buffer);
+        void SetBuffer(std::span<char> buffer);
+        bool HasOverflow() const;
+        // Digits after the decimal point for floating point numbers, -1 is the shortest text that reads back to the
+        // same value
+        void SetFloatPrecision(int32_t precision);
+
+        // Only valid in stream mode, buffer modes don't write to the stream
         std::stringstream& GetStream();
         std::string GetStr();
+        std::string_view GetView();
         
         void BeginExternalObject(std::string_view name);
         void EndExternalObject();
@@ -28,23 +44,26 @@ namespace l::serialization {
         void End(bool array = false);
         void AddJson(std::string_view json);
         void AddString(std::string_view name, std::string_view data);
+        // The generated text is escaped like the string_view overload
         void AddString(std::string_view name, std::function<void(std::stringstream& json)> dataGenerator);
 
         template<class T>
         void AddNumber(std::string_view name, T value, bool asString = false) {
             if (mNestingItemCount.back() > 1) {
-                *mJson << ",";
+                Write(',');
                 //Indent();
             }
             mNestingItemCount.back()++;
             if (!name.empty()) {
-                *mJson << "\"" << name << "\":";
+                WriteName(name);
             }
             if (asString) {
-                *mJson << "\"" << std::to_string(value) << "\"";
+                Write('"');
+                WriteNumber(value);
+                Write('"');
             }
             else {
-                *mJson << std::to_string(value);
+                WriteNumber(value);
             }
         }
         void Reset();
@@ -54,9 +73,63 @@ namespace l::serialization {
         void BeginNesting();
         void EndNesting();
 
+        void Write(char c) {
+            if (mBuffer != nullptr) {
+                mBuffer->push_back(c);
+            }
+            else if (mFixed.data() != nullptr) {
+                if (mFixedSize < mFixed.size()) {
+                    mFixed[mFixedSize++] = c;
+                }
+                else {
+                    mOverflow = true;
+                }
+            }
+            else {
+                mJson->put(c);
+            }
+        }
+        void Write(std::string_view text);
+        void WriteName(std::string_view name);
+        void WriteEscaped(std::string_view text);
+
+        template<class T>
+        void WriteNumber(T value) {
+            char buffer[64];
+            std::to_chars_result result;
+            if constexpr (std::is_floating_point_v<T>) {
+                if (mFloatPrecision < 0) {
+                    result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+                }
+                else {
+                    result = std::to_chars(buffer, buffer + sizeof(buffer), value, std::chars_format::fixed, mFloatPrecision);
+                }
+            }
+            else if constexpr (std::is_same_v<T, bool>) {
+                Write(value ? std::string_view("1") : std::string_view("0"));
+                return;
+            }
+            else {
+                result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+            }
+            if (result.ec == std::errc()) {
+                Write(std::string_view(buffer, static_cast<size_t>(result.ptr - buffer)));
+            }
+            else {
+                // very large fixed precision numbers
+                Write(std::to_string(value));
+            }
+        }
+
         bool mPretty = false;
         std::deque<int32_t> mNestingItemCount;
         std::stringstream* mJson;
         std::stringstream mJsonInternal;
+
+        std::string* mBuffer = nullptr;
+        std::span<char> mFixed;
+        size_t mFixedSize = 0;
+        bool mOverflow = false;
+        int32_t mFloatPrecision = -1;
     };
 }
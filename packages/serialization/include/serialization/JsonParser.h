@@ -5,7 +5,15 @@
 #define JSMN_HEADER
 #include <various/jsmn.h>
 
+#include <serialization/JsonStructural.h>
+
+#include <string>
 #include <string_view>
+#include <array>
+#include <vector>
+#include <tuple>
+#include <type_traits>
+#include <variant>
 #include <cassert>
 #include <cstdlib>
 
@@ -13,10 +21,46 @@ namespace l::serialization {
 
     class JsonValue;
 
+    // Navigation side tables for one parsed document, owned by the parser and reset on every parse. Subtree spans
+    // are computed in one pass the first time they are needed which makes skipping a value O(1). Objects with many
+    // keys get an open addressing table (key hash -> key token) built on their first lookup. Like the parser itself
+    // this is not thread safe.
+    class JsonIndex {
+    public:
+        static constexpr int32_t kHashIndexMinKeys = 8;
+
+        void Reset(const char* json, const jsmntok_t* tokens, int32_t count);
+        int32_t Span(const jsmntok_t* token);
+        // Returns the value token of key or nullptr
+        const jsmntok_t* Find(const jsmntok_t* object, std::string_view key);
+
+    protected:
+        struct HashTable {
+            int32_t mStart = -1;
+            int32_t mMask = 0;
+        };
+        struct HashEntry {
+            uint32_t mHash = 0;
+            int32_t mKeyToken = -1;
+        };
+
+        void BuildSpans();
+        HashTable& BuildHashTable(int32_t object);
+
+        const char* mJson = nullptr;
+        const jsmntok_t* mTokens = nullptr;
+        int32_t mCount = 0;
+        bool mHasSpans = false;
+        std::vector<int32_t> mSpans;
+        std::vector<int32_t> mStack;
+        std::vector<HashTable> mTables; // per token, only objects with kHashIndexMinKeys or more keys get a table
+        std::vector<HashEntry> mEntries;
+    };
+
     class JsonIterator {
     public:
-        JsonIterator(const char* json, const jsmntok_t* tokens, int remaining)
-            : json(json), tokens(tokens), remaining(remaining), index(0) {
+        JsonIterator(const char* json, const jsmntok_t* tokens, int remaining, JsonIndex* index = nullptr)
+            : json(json), tokens(tokens), remaining(remaining), index(0), jsonIndex(index) {
         }
 
         bool has_next() const {
@@ -30,6 +74,7 @@ namespace l::serialization {
         const jsmntok_t* tokens;
         int remaining;
         int index;
+        JsonIndex* jsonIndex;
 
         friend class JsonValue;
     };
@@ -38,8 +83,8 @@ namespace l::serialization {
     public:
         JsonValue() : mJson(nullptr), mTokens(nullptr), mCount(0) {}
 
-        JsonValue(const char* json, const jsmntok_t* tokens, int count)
-            : mJson(json), mTokens(tokens), mCount(count) {
+        JsonValue(const char* json, const jsmntok_t* tokens, int count, JsonIndex* index = nullptr)
+            : mJson(json), mTokens(tokens), mCount(count), mIndex(index) {
             if (mTokens && count > 0) {
                 mBase = mJson + mTokens[0].start;
             }
@@ -49,6 +94,8 @@ namespace l::serialization {
         jsmntype_t type() const;
         std::string_view as_string() const;
         std::string_view as_dbg_string() const;
+        // Decodes escape sequences, as_string returns the raw text between the quotes
+        std::string as_unescaped_string() const;
         bool as_bool() const;
         double as_double() const;
         float as_float() const;
@@ -98,44 +145,132 @@ namespace l::serialization {
             return n;
         }
 
+        // Calls f(key, value) for every member of an object in document order
+        template<class F>
+        void for_each_member(F&& f) const {
+            if (!has(JSMN_OBJECT)) return;
+            const jsmntok_t* cur = mTokens + 1;
+            for (int i = 0; i < mTokens[0].size; i++) {
+                auto key = std::string_view(mJson + cur->start, static_cast<size_t>(cur->end - cur->start));
+                int n = span(cur + 1);
+                f(key, JsonValue(mJson, cur + 1, n, mIndex));
+                cur += 1 + n;
+            }
+        }
+
+        // Number of tokens in the subtree of t, O(1) when the value came from a parser
+        int span(const jsmntok_t* t) const {
+            return mIndex ? mIndex->Span(t) : skip(t);
+        }
+
     private:
+        const jsmntok_t* find(const std::string_view& key) const;
+
         const char* mBase = nullptr;
         const char* mJson = nullptr;
         const jsmntok_t* mTokens = nullptr;
         int mCount = 0;
+        JsonIndex* mIndex = nullptr;
 
         friend class JsonIterator;
     };
 
     inline JsonValue JsonIterator::next() {
         assert(index < remaining);
-        JsonValue v(json, tokens + index, remaining - index);
-        int span = JsonValue::skip(tokens + index);
+        int span = jsonIndex ? jsonIndex->Span(tokens + index) : JsonValue::skip(tokens + index);
+        JsonValue v(json, tokens + index, span, jsonIndex);
         index += span;
         return v;
     }
 
-    template<int32_t MaxTokens = 1000>
+    // Fixed mode keeps MaxTokens tokens inline and fails with JSMN_ERROR_NOMEM on larger documents. Growable mode
+    // starts with MaxTokens tokens on the heap and doubles the storage when jsmn runs out, continuing the parse where
+    // it stopped so large documents are still parsed in one pass. The Simd backend tokenizes through a vectorized
+    // structural index (see JsonStructural) into the same token format, so navigation is identical.
+    template<int32_t MaxTokens = 1000, bool Growable = false, JsonBackend Backend = JsonBackend::Jsmn>
     class JsonParser {
     public:
         JsonParser() {
-            mParser.pos = 0;
-            mParser.toknext = 0;
-            mParser.toksuper = 0;
-            for (int32_t i = 0; i < MaxTokens; i++) {
-                mTokens[i].end = 0;
-                mTokens[i].size = 0;
-                mTokens[i].start = 0;
-                mTokens[i].type = JSMN_UNDEFINED;
+            if constexpr (Growable) {
+                mTokens.resize(MaxTokens > 0 ? MaxTokens : 64);
             }
+            Reset();
+        }
+
+        // Token entries are (re)initialized by jsmn as they are allocated so resetting is O(1)
+        void Reset() {
+            jsmn_init(&mParser);
+            mTokenCount = 0;
+            mPending = false;
         }
 
         std::tuple<bool, int32_t> LoadJson(const char* jsondata, size_t size) {
-            mJsondata = jsondata;
+            Reset();
+            return Parse(jsondata, size);
+        }
 
-            jsmn_init(&mParser);
+        // Incremental mode. Call with the full buffer received so far (it may be reallocated between calls but must
+        // keep the earlier bytes). While the document is incomplete { false, JSMN_ERROR_PART } is returned and the
+        // next call continues from where the previous one stopped instead of starting over. Trailing number and
+        // literal characters are held back until a delimiter arrives since jsmn would otherwise end them early, so a
+        // bare top level primitive must be parsed with LoadJson. The Simd backend indexes the whole buffer again on
+        // every call.
+        std::tuple<bool, int32_t> ResumeJson(const char* jsondata, size_t size) {
+            if (!mPending) {
+                Reset();
+            }
+            auto available = size;
+            while (available > mParser.pos && IsPrimitiveChar(jsondata[available - 1])) {
+                available--;
+            }
+            auto result = Parse(jsondata, available);
+            mPending = std::get<1>(result) == JSMN_ERROR_PART;
+            return result;
+        }
 
-            auto ret = jsmn_parse(&mParser, mJsondata, size, mTokens, MaxTokens);
+        bool IsPending() const {
+            return mPending;
+        }
+
+        int32_t GetTokenCount() const {
+            return mTokenCount;
+        }
+
+        int32_t GetTokenCapacity() const {
+            return static_cast<int32_t>(mTokens.size());
+        }
+
+        JsonValue GetRoot() {
+            return JsonValue(mJsondata, mTokens.data(), mTokenCount, &mIndex);
+        }
+
+    protected:
+        static bool IsPrimitiveChar(char c) {
+            return (c >= '0' && c <= '9') || (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '-' || c == '+' || c == '.';
+        }
+
+        std::tuple<bool, int32_t> Parse(const char* jsondata, size_t size) {
+            mJsondata = jsondata;
+
+            int ret = 0;
+            if constexpr (Backend == JsonBackend::Simd) {
+                if constexpr (Growable) {
+                    ret = mStructural.Parse(mJsondata, size, mTokens, true);
+                }
+                else {
+                    ret = mStructural.Parse(mJsondata, size, mTokens.data(), static_cast<uint32_t>(mTokens.size()));
+                }
+            }
+            else {
+                ret = jsmn_parse(&mParser, mJsondata, size, mTokens.data(), static_cast<unsigned int>(mTokens.size()));
+                if constexpr (Growable) {
+                    while (ret == JSMN_ERROR_NOMEM) {
+                        // jsmn leaves the parser at the token that did not fit so it can continue in the larger buffer
+                        mTokens.resize(mTokens.size() * 2);
+                        ret = jsmn_parse(&mParser, mJsondata, size, mTokens.data(), static_cast<unsigned int>(mTokens.size()));
+                    }
+                }
+            }
             if (ret < 0) {
                 /*
                 JSMN_ERROR_INVAL - bad token, JSON string is corrupted
@@ -161,18 +296,23 @@ namespace l::serialization {
             }
             else {
                 mTokenCount = ret;
+                mIndex.Reset(mJsondata, mTokens.data(), mTokenCount);
             }
             return { true, 0 };
         }
 
-        JsonValue GetRoot() {
-            return JsonValue(mJsondata, mTokens, mTokenCount);
-        }
-
-    protected:
         const char* mJsondata = nullptr;
         jsmn_parser mParser;
         int32_t mTokenCount = 0;
-        jsmntok_t mTokens[MaxTokens];
+        bool mPending = false;
+        JsonIndex mIndex;
+        std::conditional_t<Backend == JsonBackend::Simd, JsonStructural, std::monostate> mStructural;
+        std::conditional_t<Growable, std::vector<jsmntok_t>, std::array<jsmntok_t, MaxTokens>> mTokens;
     };
-}
+
+    template<int32_t InitialTokens = 256>
+    using JsonStreamParser = JsonParser<InitialTokens, true>;
+
+    template<int32_t InitialTokens = 256>
+    using JsonSimdParser = JsonParser<InitialTokens, true, JsonBackend::Simd>;
+}
\ No newline at end of file
@@ -0,0 +1,222 @@
+#pragma once
+
+#include <logging/LoggingAll.h>
+#include <serialization/JsonParser.h>
+
+#include <array>
+#include <bit>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/* Usage:
+struct Trade {
+	int64_t mTime = 0;
+	double mPrice = 0.0;
+	std::string_view mSymbol;
+
+	static constexpr auto kJsonFields = std::make_tuple(
+		l::serialization::json_field("T", &Trade::mTime),
+		l::serialization::json_field("p", &Trade::mPrice),
+		l::serialization::json_field("s", &Trade::mSymbol));
+};
+
+Trade trade;
+l::serialization::json_decode(parser.GetRoot(), trade);
+
+Members can be arithmetic (also from quoted numbers), bool, std::string (unescaped), std::string_view (raw text
+pointing into the json document), other structs with kJsonFields, std::vector and std::array of those. Unknown keys
+are skipped, fields missing from the document keep their value.
+*/
+
+namespace l::serialization {
+
+	template<class T, class M>
+	struct JsonField {
+		std::string_view mName;
+		M T::* mMember;
+	};
+
+	template<class T, class M>
+	constexpr JsonField<T, M> json_field(std::string_view name, M T::* member) {
+		return { name, member };
+	}
+
+	template<class T>
+	concept JsonReflected = requires { T::kJsonFields; };
+
+	template<JsonReflected T>
+	bool json_decode(const JsonValue& value, T& out);
+
+	namespace reflection {
+		template<class T>
+		struct IsVector : std::false_type {};
+		template<class T, class A>
+		struct IsVector<std::vector<T, A>> : std::true_type {};
+
+		template<class T>
+		struct IsArray : std::false_type {};
+		template<class T, size_t N>
+		struct IsArray<std::array<T, N>> : std::true_type {};
+
+		template<size_t Size>
+		struct PerfectHash {
+			static constexpr uint32_t kShift = 32 - std::countr_zero(Size);
+
+			// FNV-1a of short keys mixes poorly so the hash goes through a murmur3 finalizer before taking the top bits
+			static constexpr size_t Slot(uint32_t hash) {
+				hash ^= hash >> 16;
+				hash *= 0x85ebca6bu;
+				hash ^= hash >> 13;
+				hash *= 0xc2b2ae35u;
+				hash ^= hash >> 16;
+				return static_cast<size_t>(hash >> kShift);
+			}
+
+			uint32_t mSeed = 0;
+			std::array<int8_t, Size> mSlots{};
+		};
+
+		// Searches for an FNV-1a basis that maps every name to its own slot. Four slots per name keeps the search
+		// short, a failure to find one (duplicate names) is a compile error.
+		template<size_t Size, size_t N>
+		consteval PerfectHash<Size> FindPerfectHash(const std::array<std::string_view, N>& names) {
+			PerfectHash<Size> hash;
+			uint32_t seed = 0x811c9dc5u;
+			for (int32_t attempt = 0; attempt < 4096; attempt++, seed += 0x9e3779b9u) {
+				for (auto& slot : hash.mSlots) {
+					slot = -1;
+				}
+				bool collision = false;
+				for (size_t i = 0; i < N && !collision; i++) {
+					auto slot = PerfectHash<Size>::Slot(l::string::fnv1a_32(names[i], seed));
+					collision = hash.mSlots[slot] >= 0;
+					hash.mSlots[slot] = static_cast<int8_t>(i);
+				}
+				if (!collision) {
+					hash.mSeed = seed;
+					return hash;
+				}
+			}
+			throw "json field names must be unique";
+		}
+
+		template<class M>
+		bool DecodeValue(const JsonValue& value, M& out) {
+			if (!value.valid()) {
+				return false;
+			}
+			if constexpr (std::is_same_v<M, bool>) {
+				// out is left alone unless the token is a bool literal
+				if (!value.has(JSMN_PRIMITIVE)) {
+					return false;
+				}
+				auto text = value.as_string();
+				if (text != "true" && text != "false") {
+					return false;
+				}
+				out = text == "true";
+				return true;
+			}
+			else if constexpr (std::is_arithmetic_v<M>) {
+				return (value.has(JSMN_PRIMITIVE) || value.has(JSMN_STRING)) && l::string::to_number(value.as_string(), out);
+			}
+			else if constexpr (std::is_same_v<M, std::string_view>) {
+				out = value.as_dbg_string();
+				return value.has(JSMN_STRING);
+			}
+			else if constexpr (std::is_same_v<M, std::string>) {
+				auto text = value.as_dbg_string();
+				if (text.find('\\') == std::string_view::npos) {
+					out.assign(text); // keeps the capacity of the member
+				}
+				else {
+					out = value.as_unescaped_string();
+				}
+				return value.has(JSMN_STRING);
+			}
+			else if constexpr (JsonReflected<M>) {
+				return json_decode(value, out);
+			}
+			else if constexpr (IsVector<M>::value) {
+				if (!value.has(JSMN_ARRAY)) {
+					return false;
+				}
+				out.resize(static_cast<size_t>(value.size()));
+				bool result = true;
+				size_t i = 0;
+				auto it = value.as_array();
+				while (it.has_next()) {
+					result &= DecodeValue(it.next(), out[i++]);
+				}
+				return result;
+			}
+			else if constexpr (IsArray<M>::value) {
+				if (!value.has(JSMN_ARRAY)) {
+					return false;
+				}
+				bool result = value.size() == static_cast<int>(out.size());
+				size_t i = 0;
+				auto it = value.as_array();
+				while (it.has_next() && i < out.size()) {
+					result &= DecodeValue(it.next(), out[i++]);
+				}
+				return result;
+			}
+			else {
+				static_assert(std::is_arithmetic_v<M>, "Unsupported json field type");
+				return false;
+			}
+		}
+
+		template<class T>
+		struct Reflection {
+			using Fields = std::remove_cvref_t<decltype(T::kJsonFields)>;
+			using Decoder = bool(*)(T&, const JsonValue&);
+
+			static constexpr size_t kCount = std::tuple_size_v<Fields>;
+			static_assert(kCount > 0 && kCount < 64, "A reflected struct needs between 1 and 63 json fields");
+			static constexpr size_t kSlots = std::bit_ceil(kCount * 4);
+
+			template<size_t... I>
+			static constexpr std::array<std::string_view, kCount> GetNames(std::index_sequence<I...>) {
+				return { std::get<I>(T::kJsonFields).mName... };
+			}
+
+			template<size_t I>
+			static bool DecodeField(T& out, const JsonValue& value) {
+				return DecodeValue(value, out.*(std::get<I>(T::kJsonFields).mMember));
+			}
+
+			template<size_t... I>
+			static constexpr std::array<Decoder, kCount> GetDecoders(std::index_sequence<I...>) {
+				return { &DecodeField<I>... };
+			}
+
+			static constexpr auto kNames = GetNames(std::make_index_sequence<kCount>());
+			static constexpr auto kHash = FindPerfectHash<kSlots>(kNames);
+			static constexpr auto kDecoders = GetDecoders(std::make_index_sequence<kCount>());
+		};
+	}
+
+	// One pass over the members of an object, each key is hashed once and dispatched through a perfect hash table.
+	// Returns false if value is not an object or a known field failed to convert.
+	template<JsonReflected T>
+	bool json_decode(const JsonValue& value, T& out) {
+		using Reflection = reflection::Reflection<T>;
+		if (!value.has(JSMN_OBJECT)) {
+			return false;
+		}
+		bool result = true;
+		value.for_each_member([&](std::string_view key, const JsonValue& member) {
+			auto slot = Reflection::kHash.mSlots[Reflection::kHash.Slot(l::string::fnv1a_32(key, Reflection::kHash.mSeed))];
+			if (slot >= 0 && Reflection::kNames[slot] == key) {
+				result &= Reflection::kDecoders[slot](out, member);
+			}
+			});
+		return result;
+	}
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#define JSMN_HEADER
+#include <various/jsmn.h>
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+#include <vector>
+
+namespace l::serialization {
+
+    enum class JsonBackend {
+        Jsmn = 0,   // byte at a time, resumable
+        Simd        // vectorized structural index
+    };
+
+    /*
+    Two stage tokenizer producing jsmn compatible tokens so JsonValue navigation works unchanged.
+
+    Stage 1 classifies 64 byte blocks (AVX2, SSE2 or scalar) into bit masks for quotes, backslashes, structural
+    characters and white space. Escaped quotes and string interiors are masked out with carries between blocks and
+    the positions of everything that starts a token are written to the structural index.
+
+    Stage 2 walks the index with an explicit container stack, so closing brackets don't scan back through the
+    token array like jsmn does.
+    */
+    class JsonStructural {
+    public:
+        // Returns the token count or a JSMN_ERROR_* code. With growTokens the token vector is sized up front from the
+        // structural count (an upper bound of the token count) so JSMN_ERROR_NOMEM can't happen.
+        int32_t Parse(const char* json, size_t size, jsmntok_t* tokens, uint32_t numTokens);
+        int32_t Parse(const char* json, size_t size, std::vector<jsmntok_t>& tokens, bool growTokens);
+
+        // Stage 1 only, returns false for an unterminated string
+        bool BuildIndex(const char* json, size_t size);
+        std::span<const uint32_t> GetIndex() const {
+            return { mIndex.data(), mIndexCount };
+        }
+
+    protected:
+        int32_t BuildTokens(const char* json, size_t size, jsmntok_t* tokens, uint32_t numTokens);
+
+        std::vector<uint32_t> mIndex; // only grows, mIndexCount entries are valid
+        size_t mIndexCount = 0;
+        std::vector<int32_t> mStack;
+        bool mUnterminatedString = false;
+    };
+}
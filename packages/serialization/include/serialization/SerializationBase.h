@@ -2,6 +2,7 @@
 
 #include "logging/LoggingAll.h"
 #include "various/serializer/Serializer.h"
+#include "serialization/ViewArchive.h"
 
 #include <iostream>
 #include <string>
@@ -10,6 +11,7 @@
 #include <optional>
 #include <chrono>
 #include <type_traits>
+#include <span>
 
 namespace l::serialization {
 
@@ -25,6 +27,7 @@ namespace l::serialization {
 		}
 
 		bool Peek(std::vector<unsigned char>& data);
+		bool Peek(std::span<const unsigned char> data);
 		bool IsIdentifierValid();
 		bool IsVersionValid(int32_t latestVersion);
 
@@ -40,6 +43,7 @@ namespace l::serialization {
 		}
 
 		bool Peek(std::vector<unsigned char>& data);
+		bool Peek(std::span<const unsigned char> data);
 		bool IsIdentifierValid();
 		bool IsVersionValid(int32_t minVersion, int32_t latestVersion);
 
@@ -50,6 +54,8 @@ namespace l::serialization {
 	public:
 		using SaveArchive = zpp::serializer::archive<zpp::serializer::lazy_vector_memory_output_archive>;
 		using LoadArchive = zpp::serializer::archive<zpp::serializer::memory_view_input_archive>;
+		using ViewSaveArchive = SpanOutputArchive;
+		using ViewLoadArchive = ViewInputArchive;
 
 		// default creator for loading of existing data and should be able to handle all cases
 		SerializationBase() :
@@ -88,6 +94,12 @@ namespace l::serialization {
 		void LoadArchiveData(std::vector<unsigned char>& data);
 		void GetArchiveData(std::vector<unsigned char>& data);
 
+		// Zero copy variants. Loading reads straight from a read only view (mmap'd file, network buffer) and saving
+		// writes into a caller reserved span, returning the written size or 0 if the span was too small. Types that
+		// override SaveView/LoadView skip zpp entirely, others fall back on Save/Load over the same memory.
+		bool LoadArchiveData(std::span<const unsigned char> data);
+		size_t GetArchiveData(std::span<unsigned char> data);
+
 		friend zpp::serializer::access;
 		template <typename Archive, typename Self>
 		static void serialize(Archive& archive, Self& self) {
@@ -99,6 +111,12 @@ namespace l::serialization {
 				auto& loadArchive = *reinterpret_cast<LoadArchive*>(&archive);
 				self.LoadHandler(loadArchive);
 			}
+			if constexpr (std::is_base_of<ViewSaveArchive, Archive>{}) {
+				self.SaveHandler(archive);
+			}
+			if constexpr (std::is_base_of<ViewLoadArchive, Archive>{}) {
+				self.LoadHandler(archive);
+			}
 		}
 
 		int32_t GetVersion() const;
@@ -108,6 +126,10 @@ namespace l::serialization {
 		virtual void Load(LoadArchive&) {}
 		virtual void Upgrade(int32_t) {}
 
+		// Return false when not implemented
+		virtual bool SaveView(ViewSaveArchive&) const { return false; }
+		virtual bool LoadView(ViewLoadArchive&) { return false; }
+
 		int32_t mIdentifier = 0;
 		int32_t mVersion = 0;
 		std::string mFiletype;
@@ -124,6 +146,13 @@ namespace l::serialization {
 
 		void SaveHandler(SaveArchive& saveArchive) const;
 		void LoadHandler(LoadArchive& loadArchive);
+		void SaveHandler(ViewSaveArchive& saveArchive) const;
+		void LoadHandler(ViewLoadArchive& loadArchive);
+		template<class Archive>
+		void SaveHeader(Archive& saveArchive) const;
+		template<class Archive>
+		void LoadHeader(Archive& loadArchive);
+		bool ValidateHeader(std::span<const unsigned char> data);
 		void UpgradeToLatest();
 	};
 
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+/*
+Columnar compression for time series such as OCHLV candles, without external dependencies.
+
+Rows are a timestamp (optional) and a fixed number of float columns. Rows are grouped in blocks that are encoded
+independently, timestamps with delta-of-delta coding and floats with Gorilla style XOR coding against the previous
+value of the same column. A fixed width block index after the header gives random access to any row by decoding
+only the block holding it.
+
+Layout (native byte order):
+	header   uint32 magic, uint16 version, uint16 flags, uint32 columns, uint32 rows per block, uint64 rows, uint32 blocks
+	index    uint64 offset per block, from the start of the data
+	block    varint rows, then per column stream (timestamps first) a varint byte size and the bit stream
+*/
+
+namespace l::serialization {
+
+	constexpr uint64_t zigzag_encode(int64_t value) {
+		return (static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63);
+	}
+
+	constexpr int64_t zigzag_decode(uint64_t value) {
+		return static_cast<int64_t>(value >> 1) ^ -static_cast<int64_t>(value & 1);
+	}
+
+	// LEB128, at most 10 bytes. Decoding advances offset and returns false on truncated or overlong input.
+	size_t varint_encode(uint64_t value, std::vector<unsigned char>& out);
+	bool varint_decode(std::span<const unsigned char> data, size_t& offset, uint64_t& value);
+
+	class TimeSeriesWriter {
+	public:
+		static const int32_t kDefaultRowsPerBlock = 1024;
+
+		TimeSeriesWriter(int32_t columns, bool timestamps = true, int32_t rowsPerBlock = kDefaultRowsPerBlock);
+
+		// A row has one value per column
+		void Append(int64_t timestamp, std::span<const float> row);
+		void Append(std::span<const float> row);
+		// Row major values, count is values.size() / columns
+		void Append(std::span<const int64_t> timestamps, std::span<const float> values);
+
+		// Writes the header, index and blocks after whatever out holds, the writer can then be reused
+		void Finish(std::vector<unsigned char>& out);
+
+		uint64_t GetRowCount() const {
+			return mRowCount;
+		}
+
+	protected:
+		void FlushBlock();
+
+		int32_t mColumns = 0;
+		bool mTimestamps = true;
+		int32_t mRowsPerBlock = kDefaultRowsPerBlock;
+		uint64_t mRowCount = 0;
+
+		std::vector<int64_t> mBlockTimestamps;
+		std::vector<float> mBlockValues;
+		std::vector<uint64_t> mBlockOffsets; // relative to the start of mBody
+		std::vector<unsigned char> mBody;
+		std::vector<unsigned char> mStream;
+	};
+
+	// Reads from a view without copying it, the view has to outlive the reader
+	class TimeSeriesReader {
+	public:
+		bool Load(std::span<const unsigned char> data);
+
+		int32_t GetColumnCount() const {
+			return mColumns;
+		}
+		bool HasTimestamps() const {
+			return mTimestamps;
+		}
+		uint64_t GetRowCount() const {
+			return mRowCount;
+		}
+		int32_t GetRowsPerBlock() const {
+			return mRowsPerBlock;
+		}
+		int32_t GetBlockCount() const {
+			return mBlockCount;
+		}
+
+		// Decodes a whole block into row major values (rows * columns) and, if present, its timestamps. Either
+		// pointer may be null to skip it. The buffers need room for the block's rows, which is GetRowsPerBlock()
+		// for all but the last block. Returns the row count or -1 for a corrupt block.
+		int32_t DecodeBlock(int32_t block, int64_t* timestamps, float* values);
+
+		// Random access to count rows starting at firstRow, only the blocks holding them are decoded
+		bool Read(uint64_t firstRow, uint64_t count, int64_t* timestamps, float* values);
+
+	protected:
+		std::span<const unsigned char> mData;
+		int32_t mColumns = 0;
+		bool mTimestamps = false;
+		int32_t mRowsPerBlock = 0;
+		uint64_t mRowCount = 0;
+		int32_t mBlockCount = 0;
+		size_t mIndexOffset = 0;
+
+		std::vector<int64_t> mScratchTimestamps;
+		std::vector<float> mScratchValues;
+	};
+}
@@ -2,7 +2,9 @@
 
 #include <string>
 #include <vector>
+#include <span>
 #include <sstream>
+#include <functional>
 #include <unordered_map>
 
 #include "logging/String.h"
@@ -10,4 +12,81 @@
 namespace l::serialization {
 	std::vector<std::string> ParseTrivialData(std::stringstream& data, std::string_view separators);
 	std::unordered_map<uint32_t, std::string> ParseTrivialDataMap(std::stringstream& data, std::string_view separators);
+
+	// Zero copy variants, the fields point into data so it has to outlive them. Same pairing as above, a line
+	// with an odd number of fields gets an empty value appended.
+	std::vector<std::string_view> ParseTrivialData(std::string_view data, std::string_view separators);
+	std::unordered_map<uint32_t, std::string_view> ParseTrivialDataMap(std::string_view data, std::string_view separators);
+
+	// Walks a contiguous buffer line by line and splits each line into string_view fields without allocating per
+	// field. Empty fields are skipped and text between '"' is kept as one field, like l::string::split.
+	class TrivialDataReader {
+	public:
+		TrivialDataReader(std::string_view data, std::string_view separators);
+		~TrivialDataReader() = default;
+
+		// Moves to the next line, false at the end of the data. Empty lines are rows without fields.
+		bool Next();
+
+		std::span<const std::string_view> GetFields() const {
+			return mFields;
+		}
+		size_t GetFieldCount() const {
+			return mFields.size();
+		}
+		std::string_view GetField(size_t index) const {
+			return index < mFields.size() ? mFields[index] : std::string_view();
+		}
+		// Zero based index of the current line
+		size_t GetRow() const {
+			return mRow;
+		}
+
+		// Typed access to a field of the current row, false if it is missing or not a number
+		template<class T>
+		bool GetValue(size_t index, T& value) const {
+			return index < mFields.size() && l::string::to_number<T>(mFields[index], value);
+		}
+
+		// Parses the fields of the current row into dst, fields that are not numbers are skipped. Returns the
+		// number of values written.
+		template<class T>
+		size_t GetValues(std::span<T> dst) const {
+			size_t count = 0;
+			for (size_t i = 0; i < mFields.size() && count < dst.size(); i++) {
+				if (l::string::to_number<T>(mFields[i], dst[count])) {
+					count++;
+				}
+			}
+			return count;
+		}
+
+	protected:
+		std::string_view mData;
+		l::string::delimiter_set mDelimiters;
+		size_t mPos = 0;
+		size_t mRow = 0;
+		bool mStarted = false;
+		std::vector<std::string_view> mFields;
+	};
+
+	// Calls onRow with the fields of every line, returning false from the callback stops the parse. Returns the
+	// number of rows visited.
+	size_t ParseTrivialDataRows(std::string_view data, std::string_view separators, const std::function<bool(size_t row, std::span<const std::string_view> fields)>& onRow);
+
+	// Parses every numeric field into out, row after row. Returns the number of values appended.
+	template<class T>
+	size_t ParseTrivialDataValues(std::string_view data, std::string_view separators, std::vector<T>& out) {
+		auto start = out.size();
+		TrivialDataReader reader(data, separators);
+		while (reader.Next()) {
+			for (auto field : reader.GetFields()) {
+				T value;
+				if (l::string::to_number<T>(field, value)) {
+					out.push_back(value);
+				}
+			}
+		}
+		return out.size() - start;
+	}
 }
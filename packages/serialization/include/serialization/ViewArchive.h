@@ -0,0 +1,233 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+/*
+Archives over caller owned memory using the zpp wire layout: trivially copyable values are stored as their raw bytes,
+strings and containers are prefixed with a 32 bit element count.
+
+SpanOutputArchive writes into a pre-reserved span and flags an overflow instead of growing. ViewInputArchive reads
+from a read only view (mmap'd file, network buffer) without copying it first. Strings can be read as string_views and
+containers of trivially copyable elements as std::span<const T>, both pointing into the view, so the view must
+outlive them. Types with a zpp style 'static void serialize(Archive&, Self&)' member are supported as well.
+*/
+
+namespace l::serialization {
+
+	namespace archive_traits {
+		template<class T>
+		struct IsVector : std::false_type {};
+		template<class T, class A>
+		struct IsVector<std::vector<T, A>> : std::true_type {};
+
+		template<class T>
+		struct IsConstSpan : std::false_type {};
+		template<class T>
+		struct IsConstSpan<std::span<const T>> : std::true_type {};
+
+		template<class T>
+		constexpr bool IsString = std::is_same_v<T, std::string> || std::is_same_v<T, std::string_view>;
+
+		template<class Archive, class T>
+		concept HasSerialize = requires(Archive & archive, T & item) { T::serialize(archive, item); };
+
+		// Elements that can be copied (or mapped) as one block of bytes, views are trivially copyable but point elsewhere
+		template<class Archive, class T>
+		constexpr bool IsBlockCopyable = std::is_trivially_copyable_v<T> && !std::is_pointer_v<T> && !IsString<T> && !IsConstSpan<T>::value && !HasSerialize<Archive, T>;
+	}
+
+	class SpanOutputArchive {
+	public:
+		using SizeType = uint32_t;
+
+		explicit SpanOutputArchive(std::span<unsigned char> output) : mOutput(output) {}
+
+		template<class... T>
+		bool operator()(const T&... items) {
+			(Write(items), ...);
+			return !mOverflow;
+		}
+
+		// Reserves size bytes at the current offset for the caller to fill in, nullptr on overflow
+		unsigned char* Allocate(size_t size) {
+			if (mOverflow || mOutput.size() - mOffset < size) {
+				mOverflow = true;
+				return nullptr;
+			}
+			auto p = mOutput.data() + mOffset;
+			mOffset += size;
+			return p;
+		}
+
+		size_t GetSize() const {
+			return mOffset;
+		}
+		bool HasOverflow() const {
+			return mOverflow;
+		}
+		std::span<const unsigned char> GetData() const {
+			return mOutput.first(mOffset);
+		}
+
+	protected:
+		void WriteBytes(const void* src, size_t size) {
+			auto p = Allocate(size);
+			if (p != nullptr && size > 0) {
+				memcpy(p, src, size);
+			}
+		}
+
+		void WriteSize(size_t size) {
+			auto count = static_cast<SizeType>(size);
+			WriteBytes(&count, sizeof(count));
+		}
+
+		template<class T>
+		void Write(const T& item) {
+			using namespace archive_traits;
+			if constexpr (HasSerialize<SpanOutputArchive, const T>) {
+				T::serialize(*this, item);
+			}
+			else if constexpr (IsString<T>) {
+				WriteSize(item.size());
+				WriteBytes(item.data(), item.size());
+			}
+			else if constexpr (IsVector<T>::value || IsConstSpan<T>::value) {
+				using Element = typename T::value_type;
+				WriteSize(item.size());
+				if constexpr (IsBlockCopyable<SpanOutputArchive, Element>) {
+					WriteBytes(item.data(), item.size() * sizeof(Element));
+				}
+				else {
+					for (auto& element : item) {
+						Write(element);
+					}
+				}
+			}
+			else {
+				static_assert(IsBlockCopyable<SpanOutputArchive, T>, "Unsupported archive type");
+				WriteBytes(&item, sizeof(T));
+			}
+		}
+
+		std::span<unsigned char> mOutput;
+		size_t mOffset = 0;
+		bool mOverflow = false;
+	};
+
+	class ViewInputArchive {
+	public:
+		using SizeType = uint32_t;
+
+		explicit ViewInputArchive(std::span<const unsigned char> input) : mInput(input) {}
+
+		template<class... T>
+		bool operator()(T&... items) {
+			(Read(items), ...);
+			return !mError;
+		}
+
+		size_t GetOffset() const {
+			return mOffset;
+		}
+		bool HasError() const {
+			return mError;
+		}
+		std::span<const unsigned char> GetRemaining() const {
+			return mInput.subspan(mOffset);
+		}
+
+	protected:
+		const unsigned char* Take(size_t size) {
+			if (mError || mInput.size() - mOffset < size) {
+				mError = true;
+				return nullptr;
+			}
+			auto p = mInput.data() + mOffset;
+			mOffset += size;
+			return p;
+		}
+
+		size_t ReadSize() {
+			SizeType count = 0;
+			auto p = Take(sizeof(count));
+			if (p != nullptr) {
+				memcpy(&count, p, sizeof(count));
+			}
+			return static_cast<size_t>(count);
+		}
+
+		template<class T>
+		void Read(T& item) {
+			using namespace archive_traits;
+			if constexpr (HasSerialize<ViewInputArchive, T>) {
+				T::serialize(*this, item);
+			}
+			else if constexpr (IsString<T>) {
+				auto size = ReadSize();
+				auto p = Take(size);
+				if (p != nullptr) {
+					item = T(reinterpret_cast<const char*>(p), size);
+				}
+			}
+			else if constexpr (IsVector<T>::value) {
+				using Element = typename T::value_type;
+				auto size = ReadSize();
+				if constexpr (IsBlockCopyable<ViewInputArchive, Element>) {
+					auto p = Take(size * sizeof(Element));
+					if (p != nullptr) {
+						item.resize(size);
+						memcpy(item.data(), p, size * sizeof(Element));
+					}
+				}
+				else {
+					if (size > mInput.size() - mOffset) { // every element takes at least a byte, don't trust the count
+						mError = true;
+						return;
+					}
+					item.resize(size);
+					for (auto& element : item) {
+						Read(element);
+					}
+				}
+			}
+			else if constexpr (IsConstSpan<T>::value) {
+				using Element = std::remove_const_t<typename T::element_type>;
+				static_assert(IsBlockCopyable<ViewInputArchive, Element>, "Only trivially copyable elements can be mapped");
+				static_assert(alignof(Element) <= alignof(std::max_align_t));
+				auto size = ReadSize();
+				auto p = Take(size * sizeof(Element));
+				if (p == nullptr) {
+					return;
+				}
+				if (reinterpret_cast<uintptr_t>(p) % alignof(Element) != 0) {
+					// the layout has no padding so misaligned elements get an aligned copy owned by the archive
+					auto& copy = mCopies.emplace_back(std::make_unique<unsigned char[]>(size * sizeof(Element)));
+					memcpy(copy.get(), p, size * sizeof(Element));
+					p = copy.get();
+				}
+				item = T(reinterpret_cast<const Element*>(p), size);
+			}
+			else {
+				static_assert(IsBlockCopyable<ViewInputArchive, T>, "Unsupported archive type");
+				auto p = Take(sizeof(T));
+				if (p != nullptr) {
+					memcpy(&item, p, sizeof(T));
+				}
+			}
+		}
+
+		std::span<const unsigned char> mInput;
+		size_t mOffset = 0;
+		bool mError = false;
+		std::vector<std::unique_ptr<unsigned char[]>> mCopies;
+	};
+}
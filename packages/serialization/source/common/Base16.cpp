@@ -2,81 +2,190 @@
 
 #include "logging/LoggingAll.h"
 
+#include <array>
 #include <string>
-#include <vector>
-#include <sstream>
+
+#if defined(__AVX2__) || defined(__SSSE3__)
+#include <immintrin.h>
+#endif
 
 namespace {
 	const char s_vecUpper[] = "0123456789ABCDEF";
 	const char s_vecLower[] = "0123456789abcdef";
-	const char s_array[256] = {
-		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-		 0,  1,  2,  3,  4,  5,  6,  7,  8,  9, -1, -1, -1, -1, -1, -1,
-		-1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-		-1, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
-		-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1
-	};
+
+	constexpr std::array<int8_t, 256> kDecodeTable = [] {
+		std::array<int8_t, 256> table{};
+		for (auto& value : table) {
+			value = -1;
+		}
+		for (int8_t i = 0; i < 16; i++) {
+			table[static_cast<unsigned char>(s_vecUpper[i])] = i;
+			table[static_cast<unsigned char>(s_vecLower[i])] = i;
+		}
+		return table;
+		}();
+
+	// The vector paths return how far they got, the scalar code finishes the tail and reports errors
+#if defined(__SSSE3__)
+	// 32 hex characters -> 16 bytes, valid is set for every accepted character
+	inline __m128i HexValues(__m128i v, __m128i& valid) {
+		auto digit = _mm_sub_epi8(v, _mm_set1_epi8('0'));
+		auto isDigit = _mm_cmpeq_epi8(_mm_min_epu8(digit, _mm_set1_epi8(9)), digit);
+		auto alpha = _mm_sub_epi8(_mm_or_si128(v, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+		auto isAlpha = _mm_cmpeq_epi8(_mm_min_epu8(alpha, _mm_set1_epi8(5)), alpha);
+		valid = _mm_or_si128(isDigit, isAlpha);
+		return _mm_or_si128(_mm_and_si128(isDigit, digit), _mm_and_si128(isAlpha, _mm_add_epi8(alpha, _mm_set1_epi8(10))));
+	}
+
+	inline __m128i PackNibbles(__m128i values) {
+		return _mm_maddubs_epi16(values, _mm_set1_epi16(0x0110)); // high * 16 + low per character pair
+	}
+#endif
+
+#if defined(__AVX2__)
+	inline __m256i HexValues(__m256i v, __m256i& valid) {
+		auto digit = _mm256_sub_epi8(v, _mm256_set1_epi8('0'));
+		auto isDigit = _mm256_cmpeq_epi8(_mm256_min_epu8(digit, _mm256_set1_epi8(9)), digit);
+		auto alpha = _mm256_sub_epi8(_mm256_or_si256(v, _mm256_set1_epi8(0x20)), _mm256_set1_epi8('a'));
+		auto isAlpha = _mm256_cmpeq_epi8(_mm256_min_epu8(alpha, _mm256_set1_epi8(5)), alpha);
+		valid = _mm256_or_si256(isDigit, isAlpha);
+		return _mm256_or_si256(_mm256_and_si256(isDigit, digit), _mm256_and_si256(isAlpha, _mm256_add_epi8(alpha, _mm256_set1_epi8(10))));
+	}
+
+	size_t EncodeVector(const unsigned char* src, size_t len, char* dst, const char* svec) {
+		auto lut = _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(svec)));
+		auto mask = _mm256_set1_epi8(0x0f);
+		size_t i = 0;
+		for (; i + 32 <= len; i += 32) {
+			// unpack works within lanes, so put quad words 0,2 in the low lane and 1,3 in the high lane first
+			auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+			v = _mm256_permute4x64_epi64(v, _MM_SHUFFLE(3, 1, 2, 0));
+			auto hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(v, 4), mask));
+			auto lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(v, mask));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 2), _mm256_unpacklo_epi8(hi, lo));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i * 2 + 32), _mm256_unpackhi_epi8(hi, lo));
+		}
+		return i;
+	}
+
+	size_t DecodeVector(const char* src, size_t len, unsigned char* dst, size_t capacity) {
+		size_t i = 0;
+		for (; i + 64 <= len && i / 2 + 32 <= capacity; i += 64) {
+			__m256i valid0, valid1;
+			auto v0 = HexValues(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i)), valid0);
+			auto v1 = HexValues(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i + 32)), valid1);
+			if (_mm256_movemask_epi8(_mm256_and_si256(valid0, valid1)) != -1) {
+				break;
+			}
+			auto pair0 = _mm256_maddubs_epi16(v0, _mm256_set1_epi16(0x0110));
+			auto pair1 = _mm256_maddubs_epi16(v1, _mm256_set1_epi16(0x0110));
+			auto out = _mm256_permute4x64_epi64(_mm256_packus_epi16(pair0, pair1), _MM_SHUFFLE(3, 1, 2, 0));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i / 2), out);
+		}
+		return i;
+	}
+#elif defined(__SSSE3__)
+	size_t EncodeVector(const unsigned char* src, size_t len, char* dst, const char* svec) {
+		auto lut = _mm_loadu_si128(reinterpret_cast<const __m128i*>(svec));
+		auto mask = _mm_set1_epi8(0x0f);
+		size_t i = 0;
+		for (; i + 16 <= len; i += 16) {
+			auto v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			auto hi = _mm_shuffle_epi8(lut, _mm_and_si128(_mm_srli_epi16(v, 4), mask));
+			auto lo = _mm_shuffle_epi8(lut, _mm_and_si128(v, mask));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 2), _mm_unpacklo_epi8(hi, lo));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i * 2 + 16), _mm_unpackhi_epi8(hi, lo));
+		}
+		return i;
+	}
+
+	size_t DecodeVector(const char* src, size_t len, unsigned char* dst, size_t capacity) {
+		size_t i = 0;
+		for (; i + 32 <= len && i / 2 + 16 <= capacity; i += 32) {
+			__m128i valid0, valid1;
+			auto v0 = HexValues(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i)), valid0);
+			auto v1 = HexValues(_mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i + 16)), valid1);
+			if (_mm_movemask_epi8(_mm_and_si128(valid0, valid1)) != 0xffff) {
+				break;
+			}
+			auto out = _mm_packus_epi16(PackNibbles(v0), PackNibbles(v1));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i / 2), out);
+		}
+		return i;
+	}
+#else
+	size_t EncodeVector(const unsigned char*, size_t, char*, const char*) {
+		return 0;
+	}
+
+	size_t DecodeVector(const char*, size_t, unsigned char*, size_t) {
+		return 0;
+	}
+#endif
 }
+
 namespace l::serialization {
 
-	std::string base16_encode(unsigned char* src, size_t len, bool tolowercase) {
-		std::string out;
+	size_t base16_encode(std::span<const unsigned char> src, std::span<char> dst, bool tolowercase) {
+		auto len = src.size();
+		if (dst.size() < base16_encoded_size(len)) {
+			return 0;
+		}
 		const char* svec = tolowercase ? s_vecLower : s_vecUpper;
-		for (size_t i = 0; i < len; i++) {
-			auto c = src[i];
-			out += svec[(c >> 4) & 0xf];
-			out += svec[(c & 0xf)];
+		auto in = src.data();
+		auto out = dst.data();
+		size_t i = EncodeVector(in, len, out, svec);
+		for (; i < len; i++) {
+			auto c = in[i];
+			out[i * 2] = svec[(c >> 4) & 0xf];
+			out[i * 2 + 1] = svec[c & 0xf];
 		}
-		return out;
+		return base16_encoded_size(len);
 	}
 
-	void base16_decode(unsigned char* dst, std::string_view src) {
-		auto size = src.size();
-		size = size - size % 2;
-		for (size_t i = 0; i < size; i+=2) {
-			auto high = s_array[static_cast<unsigned char>(src.at(i + 0))];
-			auto low = s_array[static_cast<unsigned char>(src.at(i + 1))];
-			if (high >= 0 && low >= 0) {
-				dst[i] = static_cast<unsigned char>((high << 4) | low);
+	CodecResult base16_decode(std::string_view src, std::span<unsigned char> dst) {
+		size_t i = DecodeVector(src.data(), src.size(), dst.data(), dst.size());
+		for (; i + 1 < src.size(); i += 2) {
+			auto high = kDecodeTable[static_cast<unsigned char>(src[i])];
+			auto low = kDecodeTable[static_cast<unsigned char>(src[i + 1])];
+			if (high < 0 || i / 2 >= dst.size()) {
+				return { i / 2, i };
+			}
+			if (low < 0) {
+				return { i / 2, i + 1 };
 			}
+			dst[i / 2] = static_cast<unsigned char>((high << 4) | low);
+		}
+		if (i < src.size()) {
+			return { i / 2, i };
 		}
+		return { i / 2, CodecResult::kNoError };
 	}
 
-	std::string base16_encode(std::string_view src, bool tolowercase) {
+	std::string base16_encode(unsigned char* src, size_t len, bool tolowercase) {
 		std::string out;
-		const char* svec = tolowercase ? s_vecLower : s_vecUpper;
-		for (size_t i = 0; i < src.size(); i++) {
-			auto c = src[i];
-			out += svec[(c >> 4) & 0xf];
-			out += svec[(c & 0xf)];
-		}
+		out.resize(base16_encoded_size(len));
+		base16_encode(std::span<const unsigned char>(src, len), std::span<char>(out), tolowercase);
 		return out;
 	}
 
-	std::string base16_decode(std::string_view src) {
-		std::string out;
-		auto size = src.size();
-		size = size - size % 2;
-		for (size_t i = 0; i < size; i += 2) {
-			auto high = s_array[static_cast<unsigned char>(src.at(i + 0))];
-			auto low = s_array[static_cast<unsigned char>(src.at(i + 1))];
-			if (high >= 0 && low >= 0) {
-				out += static_cast<unsigned char>((high << 4) | low);
-			}
+	void base16_decode(unsigned char* dst, std::string_view src) {
+		auto result = base16_decode(src, std::span<unsigned char>(dst, base16_decoded_size(src.size())));
+		if (!result.valid()) {
+			LOG(LogWarning) << "Invalid base16 character at " << result.mErrorPosition;
 		}
-		return out;
 	}
 
+	std::string base16_encode(std::string_view src, bool tolowercase) {
+		return base16_encode(reinterpret_cast<unsigned char*>(const_cast<char*>(src.data())), src.size(), tolowercase);
+	}
 
+	// Decodes up to the first invalid character
+	std::string base16_decode(std::string_view src) {
+		std::string out;
+		out.resize(base16_decoded_size(src.size()));
+		auto result = base16_decode(src, std::span<unsigned char>(reinterpret_cast<unsigned char*>(out.data()), out.size()));
+		out.resize(result.mSize);
+		return out;
+	}
 }
@@ -2,95 +2,257 @@
 
 #include "logging/LoggingAll.h"
 
+#include <array>
 #include <string>
-#include <vector>
-#include <sstream>
 
-namespace l::serialization {
+#if defined(__AVX2__) || defined(__SSSE3__)
+#include <immintrin.h>
+#endif
 
-	std::string base64_encode(unsigned char* src, size_t len) {
-		std::string out;
+namespace {
+	constexpr char kAlphabet[] = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
 
-		int val = 0, valb = -6;
-		for (size_t i = 0; i < len; i++) {
-			unsigned char c = src[i];
-			val = (val << 8) + c;
-			valb += 8;
-			while (valb >= 0) {
-				out.push_back("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"[(val >> valb) & 0x3F]);
-				valb -= 6;
-			}
+	constexpr std::array<int8_t, 256> kDecodeTable = [] {
+		std::array<int8_t, 256> table{};
+		for (auto& value : table) {
+			value = -1;
 		}
-		if (valb > -6) {
-			out.push_back("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"[((val << 8) >> (valb + 8)) & 0x3F]);
+		for (int8_t i = 0; i < 64; i++) {
+			table[static_cast<unsigned char>(kAlphabet[i])] = i;
+		}
+		return table;
+		}();
+
+	// The vector paths follow the pshufb based codec of W. Mula and D. Lemire, "Faster Base64 Encoding and Decoding
+	// using AVX2 Instructions". They return how far they got, the scalar code finishes the tail and reports errors.
+#if defined(__SSSE3__)
+	inline __m128i EncodeIndices(__m128i in) {
+		// 3 bytes -> 4 x 6 bit indices, one per byte
+		in = _mm_shuffle_epi8(in, _mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10));
+		auto t0 = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)), _mm_set1_epi32(0x04000040));
+		auto t1 = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003f03f0)), _mm_set1_epi32(0x01000010));
+		return _mm_or_si128(t0, t1);
+	}
+
+	inline __m128i EncodeAscii(__m128i indices) {
+		// 0..25 -> 13, 26..51 -> 0, 52..61 -> 1..10, 62 -> 11, 63 -> 12 selects the offset to add
+		auto result = _mm_subs_epu8(indices, _mm_set1_epi8(51));
+		auto less = _mm_cmpgt_epi8(_mm_set1_epi8(26), indices);
+		result = _mm_or_si128(result, _mm_and_si128(less, _mm_set1_epi8(13)));
+		auto offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+		return _mm_add_epi8(_mm_shuffle_epi8(offsets, result), indices);
+	}
+#endif
+
+#if defined(__AVX2__)
+	inline __m256i Broadcast(__m128i v) {
+		return _mm256_broadcastsi128_si256(v);
+	}
+
+	size_t EncodeVector(const unsigned char* src, size_t len, char* dst) {
+		size_t i = 0;
+		for (; i + 32 <= len; i += 24) {
+			// 24 bytes split 12/12 across the lanes since the shuffles don't cross them
+			auto in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+			in = _mm256_permutevar8x32_epi32(in, _mm256_setr_epi32(0, 1, 2, 3, 3, 4, 5, 6));
+			in = _mm256_shuffle_epi8(in, Broadcast(_mm_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10)));
+			auto t0 = _mm256_mulhi_epu16(_mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00)), _mm256_set1_epi32(0x04000040));
+			auto t1 = _mm256_mullo_epi16(_mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0)), _mm256_set1_epi32(0x01000010));
+			auto indices = _mm256_or_si256(t0, t1);
+
+			auto result = _mm256_subs_epu8(indices, _mm256_set1_epi8(51));
+			auto less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), indices);
+			result = _mm256_or_si256(result, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+			auto offsets = Broadcast(_mm_setr_epi8('a' - 26, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0));
+			result = _mm256_add_epi8(_mm256_shuffle_epi8(offsets, result), indices);
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i / 3 * 4), result);
 		}
-		while (out.size() % 4) {
-			out.push_back('=');
+		for (; i + 16 <= len; i += 12) {
+			auto in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i / 3 * 4), EncodeAscii(EncodeIndices(in)));
 		}
-		return out;
+		return i;
 	}
 
-	void base64_decode(unsigned char* dst, std::string_view src) {
-		std::vector<int> T(256, -1);
-		for (uint8_t i = 0; i < 64; i++) {
-			T["ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"[i]] = i;
+	size_t DecodeVector(const char* src, size_t len, unsigned char* dst, size_t capacity) {
+		const auto lutLo = Broadcast(_mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A));
+		const auto lutHi = Broadcast(_mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10));
+		const auto lutRoll = Broadcast(_mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0));
+		const auto mask2F = _mm256_set1_epi8(0x2f);
+
+		size_t i = 0;
+		// a full 32 byte store per 24 decoded bytes
+		for (; i + 32 <= len && i / 4 * 3 + 32 <= capacity; i += 32) {
+			auto str = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+			auto hiNibbles = _mm256_and_si256(_mm256_srli_epi32(str, 4), mask2F);
+			auto loNibbles = _mm256_and_si256(str, mask2F);
+			auto hi = _mm256_shuffle_epi8(lutHi, hiNibbles);
+			auto lo = _mm256_shuffle_epi8(lutLo, loNibbles);
+			if (!_mm256_testz_si256(lo, hi)) {
+				break; // padding or an invalid character
+			}
+			auto roll = _mm256_shuffle_epi8(lutRoll, _mm256_add_epi8(_mm256_cmpeq_epi8(str, mask2F), hiNibbles));
+			str = _mm256_add_epi8(str, roll);
+
+			auto merged = _mm256_maddubs_epi16(str, _mm256_set1_epi32(0x01400140));
+			auto out = _mm256_madd_epi16(merged, _mm256_set1_epi32(0x00011000));
+			out = _mm256_shuffle_epi8(out, Broadcast(_mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1)));
+			out = _mm256_permutevar8x32_epi32(out, _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7));
+			_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst + i / 4 * 3), out);
 		}
+		return i;
+	}
+#elif defined(__SSSE3__)
+	size_t EncodeVector(const unsigned char* src, size_t len, char* dst) {
+		size_t i = 0;
+		for (; i + 16 <= len; i += 12) {
+			auto in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i / 3 * 4), EncodeAscii(EncodeIndices(in)));
+		}
+		return i;
+	}
 
-		int i = 0;
-		int val = 0, valb = -8;
-		for (unsigned char c : src) {
-			if (T[c] == -1) break;
-			val = (val << 6) + T[c];
-			valb += 6;
-			if (valb >= 0) {
-				dst[i++] = static_cast<unsigned char>((val >> valb) & 0xff);
-				valb -= 8;
+	size_t DecodeVector(const char* src, size_t len, unsigned char* dst, size_t capacity) {
+		// lo/hi nibble lookups flag invalid characters, roll maps each ascii range to its 6 bit value
+		const auto lutLo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+		const auto lutHi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+		const auto lutRoll = _mm_setr_epi8(0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+		const auto mask2F = _mm_set1_epi8(0x2f);
+
+		size_t i = 0;
+		// a full 16 byte store per 12 decoded bytes
+		for (; i + 16 <= len && i / 4 * 3 + 16 <= capacity; i += 16) {
+			auto str = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+			auto hiNibbles = _mm_and_si128(_mm_srli_epi32(str, 4), mask2F);
+			auto loNibbles = _mm_and_si128(str, mask2F);
+			auto hi = _mm_shuffle_epi8(lutHi, hiNibbles);
+			auto lo = _mm_shuffle_epi8(lutLo, loNibbles);
+			if (_mm_movemask_epi8(_mm_cmpgt_epi8(_mm_and_si128(lo, hi), _mm_setzero_si128())) != 0) {
+				break; // padding or an invalid character
 			}
+			auto roll = _mm_shuffle_epi8(lutRoll, _mm_add_epi8(_mm_cmpeq_epi8(str, mask2F), hiNibbles));
+			str = _mm_add_epi8(str, roll);
+
+			auto merged = _mm_maddubs_epi16(str, _mm_set1_epi32(0x01400140));
+			auto out = _mm_madd_epi16(merged, _mm_set1_epi32(0x00011000));
+			out = _mm_shuffle_epi8(out, _mm_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1));
+			_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + i / 4 * 3), out);
+		}
+		return i;
+	}
+#else
+	size_t EncodeVector(const unsigned char*, size_t, char*) {
+		return 0;
+	}
+
+	size_t DecodeVector(const char*, size_t, unsigned char*, size_t) {
+		return 0;
+	}
+#endif
+
+	bool IsPadding(std::string_view src, size_t i) {
+		switch (i % 4) {
+		case 2: return i + 2 == src.size() && src[i + 1] == '=';
+		case 3: return i + 1 == src.size();
+		default: return false;
 		}
 	}
+}
+
+namespace l::serialization {
 
 	// Should follow these rules: https://www.rfc-editor.org/rfc/rfc3548
-	std::string base64_encode(std::string_view in) {
-		std::string out;
+	size_t base64_encode(std::span<const unsigned char> src, std::span<char> dst) {
+		auto len = src.size();
+		auto size = base64_encoded_size(len);
+		if (dst.size() < size) {
+			return 0;
+		}
 
-		int val = 0, valb = -6;
-		for (unsigned char c : in) {
-			val = (val << 8) + c;
-			valb += 8;
-			while (valb >= 0) {
-				out.push_back("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"[(val >> valb) & 0x3F]);
-				valb -= 6;
+		auto in = src.data();
+		auto out = dst.data();
+		size_t i = EncodeVector(in, len, out);
+		out += i / 3 * 4;
+		for (; i + 3 <= len; i += 3) {
+			uint32_t value = (static_cast<uint32_t>(in[i]) << 16) | (static_cast<uint32_t>(in[i + 1]) << 8) | in[i + 2];
+			*out++ = kAlphabet[(value >> 18) & 0x3f];
+			*out++ = kAlphabet[(value >> 12) & 0x3f];
+			*out++ = kAlphabet[(value >> 6) & 0x3f];
+			*out++ = kAlphabet[value & 0x3f];
+		}
+		if (i < len) {
+			uint32_t value = static_cast<uint32_t>(in[i]) << 16;
+			if (i + 1 < len) {
+				value |= static_cast<uint32_t>(in[i + 1]) << 8;
 			}
+			*out++ = kAlphabet[(value >> 18) & 0x3f];
+			*out++ = kAlphabet[(value >> 12) & 0x3f];
+			*out++ = i + 1 < len ? kAlphabet[(value >> 6) & 0x3f] : '=';
+			*out++ = '=';
 		}
-		if (valb > -6) {
-			out.push_back("ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"[((val << 8) >> (valb + 8)) & 0x3F]);
+		return size;
+	}
+
+	CodecResult base64_decode(std::string_view src, std::span<unsigned char> dst) {
+		size_t i = DecodeVector(src.data(), src.size(), dst.data(), dst.size());
+		size_t j = i / 4 * 3;
+
+		uint32_t value = 0;
+		int32_t bits = 0;
+		for (; i < src.size(); i++) {
+			auto c = static_cast<unsigned char>(src[i]);
+			auto digit = kDecodeTable[c];
+			if (digit < 0) {
+				if (c == '=' && IsPadding(src, i)) {
+					return { j, CodecResult::kNoError };
+				}
+				return { j, i };
+			}
+			value = (value << 6) | static_cast<uint32_t>(digit);
+			bits += 6;
+			if (bits >= 8) {
+				bits -= 8;
+				if (j >= dst.size()) {
+					return { j, i };
+				}
+				dst[j++] = static_cast<unsigned char>((value >> bits) & 0xff);
+			}
 		}
-		while (out.size() % 4) {
-			out.push_back('=');
+		if (src.size() % 4 == 1) {
+			return { j, src.size() - 1 }; // six dangling bits
 		}
-		return out;
+		return { j, CodecResult::kNoError };
 	}
 
-	std::string base64_decode(std::string_view in) {
+	std::string base64_encode(unsigned char* src, size_t len) {
 		std::string out;
+		out.resize(base64_encoded_size(len));
+		base64_encode(std::span<const unsigned char>(src, len), std::span<char>(out));
+		return out;
+	}
 
-		std::vector<int> T(256, -1);
-		for (uint8_t i = 0; i < 64; i++) {
-			T["ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"[i]] = i;
+	void base64_decode(unsigned char* dst, std::string_view src) {
+		// The caller only guarantees room for the unpadded size, so the vector stores must stay inside of it
+		auto len = src.size();
+		while (len > 0 && src[len - 1] == '=') {
+			len--;
 		}
-
-		int val = 0, valb = -8;
-		for (unsigned char c : in) {
-			if (T[c] == -1) break;
-			val = (val << 6) + T[c];
-			valb += 6;
-			if (valb >= 0) {
-				out.push_back(char((val >> valb) & 0xFF));
-				valb -= 8;
-			}
+		auto result = base64_decode(src, std::span<unsigned char>(dst, len * 6 / 8));
+		if (!result.valid()) {
+			LOG(LogWarning) << "Invalid base64 character at " << result.mErrorPosition;
 		}
-		return out;
 	}
 
+	std::string base64_encode(std::string_view in) {
+		return base64_encode(reinterpret_cast<unsigned char*>(const_cast<char*>(in.data())), in.size());
+	}
 
+	// Decodes up to the first invalid character
+	std::string base64_decode(std::string_view in) {
+		std::string out;
+		out.resize(base64_decoded_size(in.size()));
+		auto result = base64_decode(in, std::span<unsigned char>(reinterpret_cast<unsigned char*>(out.data()), out.size()));
+		out.resize(result.mSize);
+		return out;
+	}
 }
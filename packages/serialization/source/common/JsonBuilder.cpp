@@ -3,27 +3,142 @@
 #include <string>
 #include <vector>
 #include <sstream>
+#include <cstring>
+#include <bit>
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define L_JSON_SSE2
+#endif
+
+namespace {
+    // Position of the first character that must be escaped in a json string (quote, backslash or control character)
+    size_t FindEscape(std::string_view text, size_t pos) {
+        const char* data = text.data();
+        const char* p = data + pos;
+        const char* end = data + text.size();
+#if defined(L_JSON_SSE2)
+        const __m128i quote = _mm_set1_epi8('"');
+        const __m128i backslash = _mm_set1_epi8('\\');
+        const __m128i space = _mm_set1_epi8(' ');
+        const __m128i sign = _mm_set1_epi8(static_cast<char>(0x80));
+        while (end - p >= 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+            // unsigned v < ' ' as a signed compare with the sign bits flipped
+            __m128i control = _mm_cmplt_epi8(_mm_xor_si128(v, sign), _mm_xor_si128(space, sign));
+            __m128i m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v, quote), _mm_cmpeq_epi8(v, backslash)), control);
+            auto mask = static_cast<uint32_t>(_mm_movemask_epi8(m));
+            if (mask != 0) {
+                return static_cast<size_t>(p - data) + std::countr_zero(mask);
+            }
+            p += 16;
+        }
+#endif
+        for (; p < end; p++) {
+            auto c = static_cast<unsigned char>(*p);
+            if (c == '"' || c == '\\' || c < 0x20) {
+                return static_cast<size_t>(p - data);
+            }
+        }
+        return text.size();
+    }
+}
 
 namespace l::serialization {
 
     void JsonBuilder::SetStream(std::stringstream* stream) {
         mJson = stream;
     }
+    void JsonBuilder::SetBuffer(std::string* buffer) {
+        mBuffer = buffer;
+        mFixed = {};
+        mFixedSize = 0;
+        mOverflow = false;
+    }
+    void JsonBuilder::SetBuffer(std::span<char> buffer) {
+        mBuffer = nullptr;
+        mFixed = buffer;
+        mFixedSize = 0;
+        mOverflow = false;
+    }
+    bool JsonBuilder::HasOverflow() const {
+        return mOverflow;
+    }
+    void JsonBuilder::SetFloatPrecision(int32_t precision) {
+        mFloatPrecision = precision;
+    }
     std::stringstream& JsonBuilder::GetStream() {
+        ASSERT(mBuffer == nullptr && mFixed.data() == nullptr) << "Json builder is in buffer mode, the stream is empty";
         return *mJson;
     }
     std::string JsonBuilder::GetStr() {
-        return mJson->str();
+        return std::string(GetView());
+    }
+    std::string_view JsonBuilder::GetView() {
+        if (mBuffer != nullptr) {
+            return *mBuffer;
+        }
+        if (mFixed.data() != nullptr) {
+            return std::string_view(mFixed.data(), mFixedSize);
+        }
+        return mJson->view();
+    }
+    void JsonBuilder::Write(std::string_view text) {
+        if (mBuffer != nullptr) {
+            mBuffer->append(text);
+        }
+        else if (mFixed.data() != nullptr) {
+            auto count = text.size() <= mFixed.size() - mFixedSize ? text.size() : mFixed.size() - mFixedSize;
+            memcpy(mFixed.data() + mFixedSize, text.data(), count);
+            mFixedSize += count;
+            mOverflow |= count < text.size();
+        }
+        else {
+            mJson->write(text.data(), static_cast<std::streamsize>(text.size()));
+        }
+    }
+    void JsonBuilder::WriteName(std::string_view name) {
+        Write('"');
+        WriteEscaped(name);
+        Write("\":");
+    }
+    void JsonBuilder::WriteEscaped(std::string_view text) {
+        static constexpr char hex[] = "0123456789abcdef";
+        size_t pos = 0;
+        while (pos < text.size()) {
+            // copy the run that needs no escaping in one go
+            auto end = FindEscape(text, pos);
+            if (end > pos) {
+                Write(text.substr(pos, end - pos));
+            }
+            if (end >= text.size()) {
+                break;
+            }
+            auto c = static_cast<unsigned char>(text[end]);
+            switch (c) {
+            case '"': Write("\\\""); break;
+            case '\\': Write("\\\\"); break;
+            case '\n': Write("\\n"); break;
+            case '\r': Write("\\r"); break;
+            case '\t': Write("\\t"); break;
+            default: {
+                char escaped[6] = { '\\', 'u', '0', '0', hex[c >> 4], hex[c & 15] };
+                Write(std::string_view(escaped, 6));
+                break;
+            }
+            }
+            pos = end + 1;
+        }
     }
     void JsonBuilder::BeginExternalObject(std::string_view name) {
         if (mNestingItemCount.back() > 1) {
-            *mJson << ",";
+            Write(',');
             NewLine();
             Indent();
         }
         BeginNesting();
         if (!name.empty()) {
-            *mJson << "\"" << name << "\":";
+            WriteName(name);
         }
     }
 
@@ -34,15 +149,15 @@ namespace l::serialization {
 
     void JsonBuilder::Begin(std::string_view name, bool array) {
         if (mNestingItemCount.back() > 1) {
-            *mJson << ",";
+            Write(',');
             NewLine();
             Indent();
         }
         BeginNesting();
         if (!name.empty()) {
-            *mJson << "\"" << name << "\":";
+            WriteName(name);
         }
-        *mJson << (array ? "[" : "{");
+        Write(array ? '[' : '{');
         NewLine();
         Indent();
     }
@@ -51,44 +166,54 @@ namespace l::serialization {
         mNestingItemCount.back()++;
         NewLine();
         Indent();
-        *mJson << (array ? "]" : "}");
+        Write(array ? ']' : '}');
     }
     void JsonBuilder::AddString(std::string_view name, std::string_view data) {
         if (mNestingItemCount.back() > 1) {
-            *mJson << ",";
+            Write(',');
             Indent();
         }
         mNestingItemCount.back()++;
         if (!name.empty()) {
-            *mJson << "\"" << name << "\":";
+            WriteName(name);
         }
-        *mJson << "\"" << data << "\"";
+        Write('"');
+        WriteEscaped(data);
+        Write('"');
     }
     void JsonBuilder::AddString(std::string_view name, std::function<void(std::stringstream& json)> dataGenerator) {
         if (mNestingItemCount.back() > 1) {
-            *mJson << ",";
+            Write(',');
             Indent();
         }
         mNestingItemCount.back()++;
         if (!name.empty()) {
-            *mJson << "\"" << name << "\":";
+            WriteName(name);
         }
-        *mJson << "\"";
-        dataGenerator(*mJson);
-        *mJson << "\"";
+        Write('"');
+        // generators need a stream, only this call allocates in buffer mode
+        std::stringstream data;
+        dataGenerator(data);
+        WriteEscaped(data.view());
+        Write('"');
     }
     void JsonBuilder::AddJson(std::string_view json) {
         if (json.empty()) {
             return;
         }
         if (mNestingItemCount.back() > 1) {
-            *mJson << ",";
+            Write(',');
             Indent();
         }
         mNestingItemCount.back()++;
-        *mJson << json;
+        Write(json);
     }
     void JsonBuilder::Reset() {
+        if (mBuffer != nullptr) {
+            mBuffer->clear();
+        }
+        mFixedSize = 0;
+        mOverflow = false;
         mJson->str("");
         mJson->clear();
     }
@@ -96,14 +221,14 @@ namespace l::serialization {
         if (!mPretty) {
             return;
         }
-        *mJson << "\n";
+        Write('\n');
     }
     void JsonBuilder::Indent() {
         if (!mPretty) {
             return;
         }
         for (size_t i = 1; i < mNestingItemCount.size(); i++) {
-            *mJson << "  ";
+            Write("  ");
         }
     }
     void JsonBuilder::BeginNesting() {
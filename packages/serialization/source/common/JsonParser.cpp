@@ -5,8 +5,139 @@
 
 #include <logging/LoggingAll.h>
 
+#include <charconv>
+
 namespace l::serialization {
 
+    void JsonIndex::Reset(const char* json, const jsmntok_t* tokens, int32_t count) {
+        mJson = json;
+        mTokens = tokens;
+        mCount = count;
+        mHasSpans = false;
+        mTables.clear();
+        mEntries.clear();
+    }
+
+    void JsonIndex::BuildSpans() {
+        // Tokens are in pre order so a subtree ends when all children of its root are done. The stack holds the
+        // open containers with their remaining child count (objects count keys and values separately).
+        mSpans.resize(static_cast<size_t>(mCount));
+        mStack.clear();
+        for (int32_t i = 0; i < mCount; i++) {
+            const auto& token = mTokens[i];
+            int32_t children = 0;
+            if (token.type & JSMN_OBJECT) {
+                children = token.size * 2;
+            }
+            else if (token.type & JSMN_ARRAY) {
+                children = token.size;
+            }
+
+            if (children > 0) {
+                mStack.push_back(i);
+                mStack.push_back(children);
+                continue;
+            }
+
+            mSpans[i] = 1;
+            while (!mStack.empty() && --mStack.back() == 0) {
+                mStack.pop_back();
+                auto container = mStack.back();
+                mStack.pop_back();
+                mSpans[container] = i + 1 - container;
+            }
+        }
+        // A truncated token array leaves containers open, let them span to the end
+        while (!mStack.empty()) {
+            mStack.pop_back();
+            auto container = mStack.back();
+            mStack.pop_back();
+            mSpans[container] = mCount - container;
+        }
+        mHasSpans = true;
+    }
+
+    int32_t JsonIndex::Span(const jsmntok_t* token) {
+        auto offset = token - mTokens;
+        if (offset < 0 || offset >= mCount) {
+            return JsonValue::skip(token);
+        }
+        if (!mHasSpans) {
+            BuildSpans();
+        }
+        return mSpans[offset];
+    }
+
+    JsonIndex::HashTable& JsonIndex::BuildHashTable(int32_t object) {
+        auto& table = mTables[object];
+        int32_t keys = mTokens[object].size;
+        int32_t capacity = 16;
+        while (capacity < keys * 2) {
+            capacity *= 2;
+        }
+        table.mStart = static_cast<int32_t>(mEntries.size());
+        table.mMask = capacity - 1;
+        mEntries.resize(mEntries.size() + capacity);
+
+        int32_t keyToken = object + 1;
+        for (int32_t i = 0; i < keys && keyToken + 1 < mCount; i++) {
+            const auto& key = mTokens[keyToken];
+            auto hash = l::string::fnv1a_32(std::string_view(mJson + key.start, static_cast<size_t>(key.end - key.start)));
+            auto slot = hash & table.mMask;
+            while (mEntries[table.mStart + slot].mKeyToken >= 0) {
+                slot = (slot + 1) & table.mMask;
+            }
+            // First key wins on duplicates, same as a linear scan
+            mEntries[table.mStart + slot] = { hash, keyToken };
+            keyToken += 1 + mSpans[keyToken + 1];
+        }
+        return table;
+    }
+
+    const jsmntok_t* JsonIndex::Find(const jsmntok_t* object, std::string_view key) {
+        auto offset = static_cast<int32_t>(object - mTokens);
+        if (!mHasSpans) {
+            BuildSpans();
+        }
+
+        int32_t keys = object->size;
+        if (keys < kHashIndexMinKeys) {
+            int32_t keyToken = offset + 1;
+            for (int32_t i = 0; i < keys && keyToken + 1 < mCount; i++) {
+                const auto& k = mTokens[keyToken];
+                if (std::string_view(mJson + k.start, static_cast<size_t>(k.end - k.start)) == key) {
+                    return &mTokens[keyToken + 1];
+                }
+                keyToken += 1 + mSpans[keyToken + 1];
+            }
+            return nullptr;
+        }
+
+        if (mTables.empty()) {
+            mTables.resize(static_cast<size_t>(mCount));
+        }
+        auto* table = &mTables[offset];
+        if (table->mStart < 0) {
+            table = &BuildHashTable(offset);
+        }
+
+        auto hash = l::string::fnv1a_32(key);
+        auto slot = hash & table->mMask;
+        for (;;) {
+            const auto& entry = mEntries[table->mStart + slot];
+            if (entry.mKeyToken < 0) {
+                return nullptr;
+            }
+            if (entry.mHash == hash) {
+                const auto& k = mTokens[entry.mKeyToken];
+                if (std::string_view(mJson + k.start, static_cast<size_t>(k.end - k.start)) == key) {
+                    return &mTokens[entry.mKeyToken + 1];
+                }
+            }
+            slot = (slot + 1) & table->mMask;
+        }
+    }
+
     bool JsonValue::valid() const { return mTokens && mCount > 0; }
 
     jsmntype_t JsonValue::type() const {
@@ -22,69 +153,127 @@ namespace l::serialization {
         return { mJson + mTokens[0].start, static_cast<size_t>(mTokens[0].end - mTokens[0].start) };
     }
 
+    std::string JsonValue::as_unescaped_string() const {
+        auto text = as_string();
+        auto escape = text.find('\\');
+        if (escape == std::string_view::npos) {
+            return std::string(text);
+        }
+        std::string out(text.substr(0, escape));
+        out.reserve(text.size());
+        for (size_t i = escape; i < text.size(); i++) {
+            if (text[i] != '\\' || i + 1 >= text.size()) {
+                out += text[i];
+                continue;
+            }
+            auto c = text[++i];
+            switch (c) {
+            case 'b': out += '\b'; break;
+            case 'f': out += '\f'; break;
+            case 'n': out += '\n'; break;
+            case 'r': out += '\r'; break;
+            case 't': out += '\t'; break;
+            case 'u': {
+                uint32_t code = 0;
+                if (i + 4 >= text.size() || std::from_chars(text.data() + i + 1, text.data() + i + 5, code, 16).ptr != text.data() + i + 5) {
+                    out += c;
+                    break;
+                }
+                i += 4;
+                // utf-8, surrogate pairs are not combined
+                if (code < 0x80) {
+                    out += static_cast<char>(code);
+                }
+                else if (code < 0x800) {
+                    out += static_cast<char>(0xc0 | (code >> 6));
+                    out += static_cast<char>(0x80 | (code & 0x3f));
+                }
+                else {
+                    out += static_cast<char>(0xe0 | (code >> 12));
+                    out += static_cast<char>(0x80 | ((code >> 6) & 0x3f));
+                    out += static_cast<char>(0x80 | (code & 0x3f));
+                }
+                break;
+            }
+            default: out += c; break; // '"', '\\' and '/'
+            }
+        }
+        return out;
+    }
+
     bool JsonValue::as_bool() const {
         auto s = as_string();
         return s == "true";
     }
 
     double JsonValue::as_double() const {
-        return std::atof(as_string().data());
+        return l::string::to_number<double>(as_string());
     }
 
     float JsonValue::as_float() const {
-        return static_cast<float>(std::atof(as_string().data()));
+        return l::string::to_number<float>(as_string());
     }
 
     int8_t JsonValue::as_int8() const {
-        return static_cast<int8_t>(std::strtol(as_string().data(), nullptr, 10));
+        return static_cast<int8_t>(l::string::to_number<int32_t>(as_string()));
     }
 
     int16_t JsonValue::as_int16() const {
-        return static_cast<int16_t>(std::strtol(as_string().data(), nullptr, 10));
+        return static_cast<int16_t>(l::string::to_number<int32_t>(as_string()));
     }
 
     int32_t JsonValue::as_int32() const {
-        return std::strtol(as_string().data(), nullptr, 10);
+        return l::string::to_number<int32_t>(as_string());
     }
 
     int64_t JsonValue::as_int64() const {
-        return std::strtoll(as_string().data(), nullptr, 10);
+        return l::string::to_number<int64_t>(as_string());
     }
 
     uint8_t JsonValue::as_uint8() const {
-        return static_cast<int8_t>(std::strtoul(as_string().data(), nullptr, 10));
+        return static_cast<uint8_t>(l::string::to_number<uint32_t>(as_string()));
     }
 
     uint16_t JsonValue::as_uint16() const {
-        return static_cast<int16_t>(std::strtoul(as_string().data(), nullptr, 10));
+        return static_cast<uint16_t>(l::string::to_number<uint32_t>(as_string()));
     }
 
     uint32_t JsonValue::as_uint32() const {
-        return std::strtoul(as_string().data(), nullptr, 10);
+        return l::string::to_number<uint32_t>(as_string());
     }
 
     uint64_t JsonValue::as_uint64() const {
-        return std::strtoull(as_string().data(), nullptr, 10);
+        return l::string::to_number<uint64_t>(as_string());
     }
 
     JsonIterator JsonValue::as_array() const {
         assert(type() & JSMN_ARRAY);
-        return JsonIterator(mJson, mTokens + 1, mCount - 1);
+        return JsonIterator(mJson, mTokens + 1, span(mTokens) - 1, mIndex);
     }
 
-    JsonValue JsonValue::get(const std::string_view& key) const {
-        assert(type() & JSMN_OBJECT);
-        int i = 1;
-        while (i + 1 < mCount) {
-            auto k = std::string_view(mJson + mTokens[i].start, mTokens[i].end - mTokens[i].start);
-            int val_span = skip(&mTokens[i + 1]);
-
+    const jsmntok_t* JsonValue::find(const std::string_view& key) const {
+        if (mIndex) {
+            return mIndex->Find(mTokens, key);
+        }
+        // Pairs are counted from the object size so the scan never runs into the siblings that follow the object
+        const jsmntok_t* cur = mTokens + 1;
+        for (int i = 0; i < mTokens[0].size; i++) {
+            auto k = std::string_view(mJson + cur->start, static_cast<size_t>(cur->end - cur->start));
             if (k == key) {
-                return JsonValue(mJson, &mTokens[i + 1], val_span);
+                return cur + 1;
             }
-            i += 1 + val_span;
+            cur += 1 + skip(cur + 1);
         }
-        return {};
+        return nullptr;
+    }
+
+    JsonValue JsonValue::get(const std::string_view& key) const {
+        assert(type() & JSMN_OBJECT);
+        auto value = find(key);
+        if (value == nullptr) {
+            return {};
+        }
+        return JsonValue(mJson, value, span(value), mIndex);
     }
 
     const char* JsonValue::start_ptr() const {
@@ -92,12 +281,12 @@ namespace l::serialization {
     }
 
     const char* JsonValue::end_ptr() const {
-        const jsmntok_t* end = mTokens + skip(mTokens);
+        const jsmntok_t* end = mTokens + span(mTokens);
         return mJson + end[-1].end;
     }
 
     const jsmntok_t* JsonValue::end_token() const {
-        return mTokens + skip(mTokens);
+        return mTokens + span(mTokens);
     }
 
     bool JsonValue::has(jsmntype_t t) const {
@@ -106,17 +295,13 @@ namespace l::serialization {
 
     bool JsonValue::has_key(const std::string_view& key) const {
         if (!has(JSMN_OBJECT)) return false;
-        int i = 1;
-        while (i + 1 < mCount) {
-            auto k = std::string_view(mJson + mTokens[i].start, mTokens[i].end - mTokens[i].start);
-            if (k == key) return true;
-            i += 1 + skip(&mTokens[i + 1]);
-        }
-        return false;
+        return find(key) != nullptr;
     }
 
     bool JsonValue::is_null(const std::string_view& key) const {
-        return has_key(key) && get(key).has(JSMN_PRIMITIVE) && get(key).as_string() == "null";
+        if (!has(JSMN_OBJECT)) return false;
+        auto value = find(key);
+        return value != nullptr && value->type == JSMN_PRIMITIVE && std::string_view(mJson + value->start, static_cast<size_t>(value->end - value->start)) == "null";
     }
 
     int JsonValue::size() const {
@@ -136,13 +321,11 @@ namespace l::serialization {
         const jsmntok_t* current = mTokens + 1;
         int i = 0;
         while (i < index) {
-            int skip_n = skip(current);
-            current += skip_n;
+            current += span(current);
             ++i;
         }
 
-        int span = skip(current);
-        return JsonValue(mJson, current, span);
+        return JsonValue(mJson, current, span(current), mIndex);
     }
 
 }
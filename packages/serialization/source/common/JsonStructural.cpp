@@ -0,0 +1,256 @@
+#include <serialization/JsonStructural.h>
+
+#include <logging/LoggingAll.h>
+
+#include <bit>
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define L_JSON_SSE2
+#endif
+
+namespace {
+    constexpr size_t kBlockSize = 64;
+    constexpr uint64_t kEvenBits = 0x5555555555555555ull;
+
+    struct BlockMasks {
+        uint64_t mQuote = 0;
+        uint64_t mBackslash = 0;
+        uint64_t mOperator = 0;
+        uint64_t mWhitespace = 0;
+    };
+
+#if defined(__AVX2__)
+    inline uint64_t Match32(__m256i v, char c) {
+        return static_cast<uint32_t>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(v, _mm256_set1_epi8(c))));
+    }
+
+    void Classify(const char* block, BlockMasks& masks) {
+        masks = {};
+        for (size_t i = 0; i < kBlockSize; i += 32) {
+            __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(block + i));
+            masks.mQuote |= Match32(v, '"') << i;
+            masks.mBackslash |= Match32(v, '\\') << i;
+            masks.mOperator |= (Match32(v, '{') | Match32(v, '}') | Match32(v, '[') | Match32(v, ']') | Match32(v, ':') | Match32(v, ',')) << i;
+            masks.mWhitespace |= (Match32(v, ' ') | Match32(v, '\t') | Match32(v, '\n') | Match32(v, '\r')) << i;
+        }
+    }
+#elif defined(L_JSON_SSE2)
+    inline uint64_t Match16(__m128i v, char c) {
+        return static_cast<uint32_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(v, _mm_set1_epi8(c))));
+    }
+
+    void Classify(const char* block, BlockMasks& masks) {
+        masks = {};
+        for (size_t i = 0; i < kBlockSize; i += 16) {
+            __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block + i));
+            masks.mQuote |= Match16(v, '"') << i;
+            masks.mBackslash |= Match16(v, '\\') << i;
+            masks.mOperator |= (Match16(v, '{') | Match16(v, '}') | Match16(v, '[') | Match16(v, ']') | Match16(v, ':') | Match16(v, ',')) << i;
+            masks.mWhitespace |= (Match16(v, ' ') | Match16(v, '\t') | Match16(v, '\n') | Match16(v, '\r')) << i;
+        }
+    }
+#else
+    void Classify(const char* block, BlockMasks& masks) {
+        masks = {};
+        for (size_t i = 0; i < kBlockSize; i++) {
+            uint64_t bit = 1ull << i;
+            switch (block[i]) {
+            case '"': masks.mQuote |= bit; break;
+            case '\\': masks.mBackslash |= bit; break;
+            case '{': case '}': case '[': case ']': case ':': case ',': masks.mOperator |= bit; break;
+            case ' ': case '\t': case '\n': case '\r': masks.mWhitespace |= bit; break;
+            default: break;
+            }
+        }
+    }
+#endif
+
+    // Bit i is set if an odd number of bits are set at or below i
+    inline uint64_t PrefixXor(uint64_t bits) {
+        bits ^= bits << 1;
+        bits ^= bits << 2;
+        bits ^= bits << 4;
+        bits ^= bits << 8;
+        bits ^= bits << 16;
+        bits ^= bits << 32;
+        return bits;
+    }
+
+    // Characters escaped by an odd length backslash run, carrying a run that ends a block into the next one
+    inline uint64_t FindEscaped(uint64_t backslash, uint64_t& prevEscaped) {
+        backslash &= ~prevEscaped;
+        uint64_t followsEscape = (backslash << 1) | prevEscaped;
+        uint64_t oddSequenceStarts = backslash & ~kEvenBits & ~followsEscape;
+        uint64_t sequencesStartingOnEvenBits = oddSequenceStarts + backslash;
+        prevEscaped = sequencesStartingOnEvenBits < oddSequenceStarts ? 1 : 0;
+        uint64_t invertMask = sequencesStartingOnEvenBits << 1;
+        return (kEvenBits ^ invertMask) & followsEscape;
+    }
+
+    inline bool IsPrimitiveEnd(char c) {
+        switch (c) {
+        case ' ': case '\t': case '\n': case '\r': case ',': case ']': case '}': case ':':
+            return true;
+        default:
+            return false;
+        }
+    }
+}
+
+namespace l::serialization {
+
+    bool JsonStructural::BuildIndex(const char* json, size_t size) {
+        if (mIndex.size() < size + kBlockSize) {
+            mIndex.resize(size + kBlockSize);
+        }
+        mIndexCount = 0;
+
+        uint64_t prevEscaped = 0;
+        uint64_t prevInString = 0;
+        uint64_t prevScalar = 0;
+        uint32_t* out = mIndex.data();
+        char tail[kBlockSize];
+
+        for (size_t base = 0; base < size; base += kBlockSize) {
+            const char* block = json + base;
+            if (size - base < kBlockSize) {
+                memset(tail, ' ', kBlockSize);
+                memcpy(tail, block, size - base);
+                block = tail;
+            }
+
+            BlockMasks masks;
+            Classify(block, masks);
+
+            uint64_t quotes = masks.mQuote & ~FindEscaped(masks.mBackslash, prevEscaped);
+            uint64_t inString = PrefixXor(quotes) ^ prevInString; // opening quote and string body
+            prevInString = static_cast<uint64_t>(static_cast<int64_t>(inString) >> 63);
+
+            uint64_t scalar = ~(masks.mOperator | masks.mWhitespace | masks.mQuote);
+            uint64_t scalarStart = scalar & ~((scalar << 1) | prevScalar);
+            prevScalar = scalar >> 63;
+
+            uint64_t structurals = ((masks.mOperator | scalarStart) & ~inString) | quotes;
+            while (structurals != 0) {
+                *out++ = static_cast<uint32_t>(base + std::countr_zero(structurals));
+                structurals &= structurals - 1;
+            }
+        }
+        mIndexCount = static_cast<size_t>(out - mIndex.data());
+        mUnterminatedString = prevInString != 0;
+        return !mUnterminatedString;
+    }
+
+    int32_t JsonStructural::BuildTokens(const char* json, size_t size, jsmntok_t* tokens, uint32_t numTokens) {
+        // Mirrors the token layout of jsmn: objects count their keys, keys count their value and toksuper is the
+        // token the next value is attached to
+        uint32_t toknext = 0;
+        int32_t toksuper = -1;
+        mStack.clear();
+
+        auto alloc = [&](jsmntype_t type, int start, int end) -> jsmntok_t* {
+            if (toknext >= numTokens) {
+                return nullptr;
+            }
+            auto& token = tokens[toknext++];
+            token.type = type;
+            token.start = start;
+            token.end = end;
+            token.size = 0;
+#ifdef JSMN_PARENT_LINKS
+            token.parent = toksuper;
+#endif
+            if (toksuper != -1) {
+                tokens[toksuper].size++;
+            }
+            return &token;
+            };
+
+        const uint32_t* index = mIndex.data();
+        for (size_t i = 0; i < mIndexCount; i++) {
+            auto pos = index[i];
+            switch (json[pos]) {
+            case '{':
+            case '[': {
+                auto type = json[pos] == '{' ? JSMN_OBJECT : JSMN_ARRAY;
+                if (alloc(type, static_cast<int>(pos), -1) == nullptr) {
+                    return JSMN_ERROR_NOMEM;
+                }
+                toksuper = static_cast<int32_t>(toknext - 1);
+                mStack.push_back(toksuper);
+                break;
+            }
+            case '}':
+            case ']': {
+                auto type = json[pos] == '}' ? JSMN_OBJECT : JSMN_ARRAY;
+                if (mStack.empty() || tokens[mStack.back()].type != type) {
+                    return JSMN_ERROR_INVAL;
+                }
+                tokens[mStack.back()].end = static_cast<int>(pos + 1);
+                mStack.pop_back();
+                toksuper = mStack.empty() ? -1 : mStack.back();
+                break;
+            }
+            case '"': {
+                if (i + 1 >= mIndexCount) {
+                    return JSMN_ERROR_PART;
+                }
+                auto end = index[++i];
+                if (alloc(JSMN_STRING, static_cast<int>(pos + 1), static_cast<int>(end)) == nullptr) {
+                    return JSMN_ERROR_NOMEM;
+                }
+                break;
+            }
+            case ':':
+                if (toknext == 0) {
+                    return JSMN_ERROR_INVAL;
+                }
+                toksuper = static_cast<int32_t>(toknext - 1);
+                break;
+            case ',':
+                if (toksuper != -1 && tokens[toksuper].type != JSMN_ARRAY && tokens[toksuper].type != JSMN_OBJECT) {
+                    toksuper = mStack.empty() ? -1 : mStack.back();
+                }
+                break;
+            default: {
+                auto end = static_cast<size_t>(pos);
+                while (end < size && !IsPrimitiveEnd(json[end])) {
+                    end++;
+                }
+                if (alloc(JSMN_PRIMITIVE, static_cast<int>(pos), static_cast<int>(end)) == nullptr) {
+                    return JSMN_ERROR_NOMEM;
+                }
+                break;
+            }
+            }
+        }
+
+        if (mUnterminatedString || !mStack.empty()) {
+            return JSMN_ERROR_PART;
+        }
+        return static_cast<int32_t>(toknext);
+    }
+
+    int32_t JsonStructural::Parse(const char* json, size_t size, jsmntok_t* tokens, uint32_t numTokens) {
+        if (!BuildIndex(json, size)) {
+            return JSMN_ERROR_PART;
+        }
+        return BuildTokens(json, size, tokens, numTokens);
+    }
+
+    int32_t JsonStructural::Parse(const char* json, size_t size, std::vector<jsmntok_t>& tokens, bool growTokens) {
+        if (!BuildIndex(json, size)) {
+            return JSMN_ERROR_PART;
+        }
+        // Every token starts at a structural position so the index count bounds the token count
+        if (growTokens && tokens.size() < mIndexCount) {
+            tokens.resize(mIndexCount);
+        }
+        return BuildTokens(json, size, tokens.data(), static_cast<uint32_t>(tokens.size()));
+    }
+}
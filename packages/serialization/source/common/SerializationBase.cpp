@@ -7,6 +7,7 @@
 #include <array>
 #include <iostream>
 #include <ctime>
+#include <cstring>
 
 namespace l::serialization {
 	const int32_t kHeaderIdentifier = 0x00defa00; // storage base file identifier
@@ -23,6 +24,15 @@ namespace l::serialization {
 		return true;
 	}
 
+	bool HeaderValidity::Peek(std::span<const unsigned char> data) {
+		if (data.size() < 4 * 2) {
+			return false;
+		}
+		memcpy(&mIdentifier, data.data(), sizeof(mIdentifier));
+		memcpy(&mVersion, data.data() + sizeof(mIdentifier), sizeof(mVersion));
+		return true;
+	}
+
 	bool HeaderValidity::IsIdentifierValid() {
 		return mIdentifier == kHeaderIdentifier;
 	}
@@ -42,6 +52,14 @@ namespace l::serialization {
 		return true;
 	}
 
+	bool TinyHeaderValidity::Peek(std::span<const unsigned char> data) {
+		if (data.size() < 4) {
+			return false;
+		}
+		memcpy(&mHeader, data.data(), sizeof(mHeader));
+		return true;
+	}
+
 	bool TinyHeaderValidity::IsIdentifierValid() {
 		return (mHeader & kTinyHeaderIdentifier) == kTinyHeaderIdentifier;
 	}
@@ -85,6 +103,30 @@ namespace l::serialization {
 	}
 
 	void SerializationBase::LoadArchiveData(std::vector<unsigned char>& data) {
+		if (mUseTinyHeader) {
+
+		}
+		else {
+			if (!ValidateHeader(data)) {
+				return;
+			}
+			zpp::serializer::memory_input_archive in(data);
+			in(*this);
+		}
+	}
+
+	bool SerializationBase::LoadArchiveData(std::span<const unsigned char> data) {
+		if (mUseTinyHeader) {
+			return false;
+		}
+		if (!ValidateHeader(data)) {
+			return false;
+		}
+		ViewLoadArchive in(data);
+		return in(*this);
+	}
+
+	bool SerializationBase::ValidateHeader(std::span<const unsigned char> data) {
 		// data should have identifier, but doesn't, or should not have identifier - don't load identifier (this is fine since we can determine if identifier is present or not)
 		//   data should not have version - fine
 		//   data should have version but doesn't - error (we can't know this)
@@ -95,48 +137,42 @@ namespace l::serialization {
 		//   no - (data should have version but doesn't - error (we can't know this)) - it must be there
 		//   data should have version and does - load version
 
-		if (mUseTinyHeader) {
-
+		HeaderValidity headerValidity;
+		bool peekSuccessful = headerValidity.Peek(data);
+		if (mExpectIdentifier) {
+			if (!peekSuccessful || !headerValidity.IsIdentifierValid()) {
+				LOG(LogError) << "Expected serialization identifier: " << headerValidity.mIdentifier << " (version: " << headerValidity.mVersion << ")";
+				return false;
+			}
+			if (!peekSuccessful || !headerValidity.IsVersionValid(mLatestVersion)) {
+				LOG(LogError) << "Expected serialization version: " << headerValidity.mVersion << " (identifier: " << headerValidity.mIdentifier << ")";
+				return false;
+			}
+			mUseIdentifier = true; // if identifier is expected, we should continue using it even if user didn't not set it
+			mExpectIdentifier = true;
+			mExpectVersion = true;
+			mUseVersion = true;
 		}
-		else {
-			HeaderValidity headerValidity;
-			bool peekSuccessful = headerValidity.Peek(data);
-			if (mExpectIdentifier) {
-				if (!peekSuccessful || !headerValidity.IsIdentifierValid()) {
-					LOG(LogError) << "Expected serialization identifier: " << headerValidity.mIdentifier << " (version: " << headerValidity.mVersion << ")";
-					return;
-				}
-				if (!peekSuccessful || !headerValidity.IsVersionValid(mLatestVersion)) {
-					LOG(LogError) << "Expected serialization version: " << headerValidity.mVersion << " (identifier: " << headerValidity.mIdentifier << ")";
-					return;
-				}
-				mUseIdentifier = true; // if identifier is expected, we should continue using it even if user didn't not set it
-				mExpectIdentifier = true;
-				mExpectVersion = true;
-				mUseVersion = true;
+		else if (peekSuccessful && headerValidity.IsIdentifierValid()) {
+			mUseIdentifier = true;
+			mExpectIdentifier = true;
+			
+			if (!headerValidity.IsVersionValid(mLatestVersion)) {
+				LOG(LogError) << "Expected serialization version: " << headerValidity.mVersion;
+				return false;
 			}
-			else if (peekSuccessful && headerValidity.IsIdentifierValid()) {
-				mUseIdentifier = true;
-				mExpectIdentifier = true;
-				
-				if (!headerValidity.IsVersionValid(mLatestVersion)) {
-					LOG(LogError) << "Expected serialization version: " << headerValidity.mVersion;
-					return;
-				}
 
-				mExpectVersion = true;
-				mUseVersion = true;
-			}
-			else if (mExpectVersion) {
-				if (!peekSuccessful || !headerValidity.IsVersionValid(mLatestVersion)) {
-					return;
-				}
-				mExpectIdentifier = false;
-				mUseVersion = true; // if version is expected, we should continue using it even if user didn't not set it
+			mExpectVersion = true;
+			mUseVersion = true;
+		}
+		else if (mExpectVersion) {
+			if (!peekSuccessful || !headerValidity.IsVersionValid(mLatestVersion)) {
+				return false;
 			}
-			zpp::serializer::memory_input_archive in(data);
-			in(*this);
+			mExpectIdentifier = false;
+			mUseVersion = true; // if version is expected, we should continue using it even if user didn't not set it
 		}
+		return true;
 	}
 
 	void SerializationBase::GetArchiveData(std::vector<unsigned char>& data) {
@@ -144,11 +180,20 @@ namespace l::serialization {
 		out(*this);
 	}
 
+	size_t SerializationBase::GetArchiveData(std::span<unsigned char> data) {
+		ViewSaveArchive out(data);
+		if (!out(*this)) {
+			return 0;
+		}
+		return out.GetSize();
+	}
+
 	int32_t SerializationBase::GetVersion() const {
 		return mVersion;
 	}
 
-	void SerializationBase::SaveHandler(SaveArchive& saveArchive) const {
+	template<class Archive>
+	void SerializationBase::SaveHeader(Archive& saveArchive) const {
 		if (mUseTinyHeader) {
 
 		}
@@ -167,10 +212,10 @@ namespace l::serialization {
 				saveArchive(mFiletype);
 			}
 		}
-		Save(saveArchive);
 	}
 
-	void SerializationBase::LoadHandler(LoadArchive& loadArchive) {
+	template<class Archive>
+	void SerializationBase::LoadHeader(Archive& loadArchive) {
 		if (mUseTinyHeader) {
 
 		}
@@ -187,10 +232,46 @@ namespace l::serialization {
 				loadArchive(mFiletype);
 			}
 		}
+	}
+
+	void SerializationBase::SaveHandler(SaveArchive& saveArchive) const {
+		SaveHeader(saveArchive);
+		Save(saveArchive);
+	}
+
+	void SerializationBase::LoadHandler(LoadArchive& loadArchive) {
+		LoadHeader(loadArchive);
 		Load(loadArchive);
 		UpgradeToLatest();
 	}
 
+	void SerializationBase::SaveHandler(ViewSaveArchive& saveArchive) const {
+		SaveHeader(saveArchive);
+		if (SaveView(saveArchive)) {
+			return;
+		}
+		// zpp only writes to vectors, one per thread keeps the fallback from allocating once it has warmed up
+		thread_local std::vector<unsigned char> scratch;
+		scratch.clear();
+		zpp::serializer::memory_output_archive out(scratch);
+		Save(*reinterpret_cast<SaveArchive*>(&out));
+		auto p = saveArchive.Allocate(scratch.size());
+		if (p != nullptr && !scratch.empty()) {
+			memcpy(p, scratch.data(), scratch.size());
+		}
+	}
+
+	void SerializationBase::LoadHandler(ViewLoadArchive& loadArchive) {
+		LoadHeader(loadArchive);
+		if (!LoadView(loadArchive)) {
+			// zpp reads the rest of the view in place, the offset of loadArchive isn't advanced
+			auto remaining = loadArchive.GetRemaining();
+			zpp::serializer::memory_view_input_archive in(remaining.data(), remaining.size());
+			Load(*reinterpret_cast<LoadArchive*>(&in));
+		}
+		UpgradeToLatest();
+	}
+
 	void SerializationBase::UpgradeToLatest() {
 		mLatestVersion = mVersion > mLatestVersion ? mVersion : mLatestVersion;
 		if (mUseVersion) {
@@ -0,0 +1,462 @@
+#include "serialization/TimeSeriesCodec.h"
+
+#include "logging/LoggingAll.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace {
+	const uint32_t kMagic = 0x4353544c; // "LTSC"
+	const uint16_t kVersion = 1;
+	const uint16_t kFlagTimestamps = 1;
+	const size_t kHeaderSize = 4 + 2 + 2 + 4 + 4 + 8 + 4;
+
+	template<class T>
+	void WriteRaw(unsigned char* dst, size_t& offset, T value) {
+		memcpy(dst + offset, &value, sizeof(T));
+		offset += sizeof(T);
+	}
+
+	template<class T>
+	T ReadRaw(const unsigned char* src, size_t& offset) {
+		T value;
+		memcpy(&value, src + offset, sizeof(T));
+		offset += sizeof(T);
+		return value;
+	}
+
+	// Most significant bit first
+	class BitWriter {
+	public:
+		BitWriter(std::vector<unsigned char>& out) : mOut(out) {}
+
+		void Write(uint64_t value, int32_t bits) {
+			if (bits > 32) {
+				Write(value >> 32, bits - 32);
+				bits = 32;
+			}
+			mBuffer = (mBuffer << bits) | (value & ((1ull << bits) - 1));
+			mCount += bits;
+			while (mCount >= 8) {
+				mCount -= 8;
+				mOut.push_back(static_cast<unsigned char>(mBuffer >> mCount));
+			}
+		}
+
+		void Flush() {
+			if (mCount > 0) {
+				mOut.push_back(static_cast<unsigned char>(mBuffer << (8 - mCount)));
+				mCount = 0;
+			}
+		}
+
+	protected:
+		std::vector<unsigned char>& mOut;
+		uint64_t mBuffer = 0;
+		int32_t mCount = 0;
+	};
+
+	class BitReader {
+	public:
+		BitReader(std::span<const unsigned char> data) : mData(data) {}
+
+		uint64_t Read(int32_t bits) {
+			if (bits > 32) {
+				auto high = Read(bits - 32);
+				return (high << 32) | Read(32);
+			}
+			while (mCount < bits) {
+				if (mOffset >= mData.size()) {
+					mError = true;
+					return 0;
+				}
+				mBuffer = (mBuffer << 8) | mData[mOffset++];
+				mCount += 8;
+			}
+			mCount -= bits;
+			return (mBuffer >> mCount) & ((1ull << bits) - 1);
+		}
+
+		bool ReadBit() {
+			return Read(1) != 0;
+		}
+
+		bool HasError() const {
+			return mError;
+		}
+
+	protected:
+		std::span<const unsigned char> mData;
+		size_t mOffset = 0;
+		uint64_t mBuffer = 0;
+		int32_t mCount = 0;
+		bool mError = false;
+	};
+
+	// Delta-of-delta in zigzag form: '0' for a regular interval, then '10' + 7, '110' + 9, '1110' + 12,
+	// '11110' + 32 and '11111' + 64 bits. Arithmetic wraps so any int64 sequence round trips.
+	void EncodeTimestamps(const int64_t* timestamps, size_t rows, std::vector<unsigned char>& out) {
+		BitWriter writer(out);
+		auto prev = static_cast<uint64_t>(timestamps[0]);
+		uint64_t prevDelta = 0;
+		writer.Write(prev, 64);
+		for (size_t i = 1; i < rows; i++) {
+			auto current = static_cast<uint64_t>(timestamps[i]);
+			auto delta = current - prev;
+			auto dod = l::serialization::zigzag_encode(static_cast<int64_t>(delta - prevDelta));
+			if (dod == 0) {
+				writer.Write(0, 1);
+			}
+			else if (dod < (1ull << 7)) {
+				writer.Write(0b10, 2);
+				writer.Write(dod, 7);
+			}
+			else if (dod < (1ull << 9)) {
+				writer.Write(0b110, 3);
+				writer.Write(dod, 9);
+			}
+			else if (dod < (1ull << 12)) {
+				writer.Write(0b1110, 4);
+				writer.Write(dod, 12);
+			}
+			else if (dod < (1ull << 32)) {
+				writer.Write(0b11110, 5);
+				writer.Write(dod, 32);
+			}
+			else {
+				writer.Write(0b11111, 5);
+				writer.Write(dod, 64);
+			}
+			prev = current;
+			prevDelta = delta;
+		}
+		writer.Flush();
+	}
+
+	bool DecodeTimestamps(std::span<const unsigned char> stream, size_t rows, int64_t* timestamps) {
+		BitReader reader(stream);
+		auto prev = reader.Read(64);
+		uint64_t prevDelta = 0;
+		timestamps[0] = static_cast<int64_t>(prev);
+		for (size_t i = 1; i < rows; i++) {
+			uint64_t dod = 0;
+			if (reader.ReadBit()) {
+				if (!reader.ReadBit()) {
+					dod = reader.Read(7);
+				}
+				else if (!reader.ReadBit()) {
+					dod = reader.Read(9);
+				}
+				else if (!reader.ReadBit()) {
+					dod = reader.Read(12);
+				}
+				else if (!reader.ReadBit()) {
+					dod = reader.Read(32);
+				}
+				else {
+					dod = reader.Read(64);
+				}
+			}
+			prevDelta += static_cast<uint64_t>(l::serialization::zigzag_decode(dod));
+			prev += prevDelta;
+			timestamps[i] = static_cast<int64_t>(prev);
+		}
+		return !reader.HasError();
+	}
+
+	// Gorilla XOR coding on the float bits: '0' for a repeated value, '10' + the meaningful bits when they fit the
+	// previous leading/trailing zero window, otherwise '11' + 5 bits leading zeros + 5 bits length - 1 + the bits
+	void EncodeFloats(const float* values, size_t rows, size_t stride, std::vector<unsigned char>& out) {
+		BitWriter writer(out);
+		auto prev = std::bit_cast<uint32_t>(values[0]);
+		int32_t prevLeading = -1;
+		int32_t prevTrailing = 0;
+		writer.Write(prev, 32);
+		for (size_t i = 1; i < rows; i++) {
+			auto current = std::bit_cast<uint32_t>(values[i * stride]);
+			auto xored = current ^ prev;
+			if (xored == 0) {
+				writer.Write(0, 1);
+			}
+			else {
+				auto leading = std::countl_zero(xored);
+				auto trailing = std::countr_zero(xored);
+				if (prevLeading >= 0 && leading >= prevLeading && trailing >= prevTrailing) {
+					writer.Write(0b10, 2);
+					writer.Write(xored >> prevTrailing, 32 - prevLeading - prevTrailing);
+				}
+				else {
+					auto length = 32 - leading - trailing;
+					writer.Write(0b11, 2);
+					writer.Write(static_cast<uint64_t>(leading), 5);
+					writer.Write(static_cast<uint64_t>(length - 1), 5);
+					writer.Write(xored >> trailing, length);
+					prevLeading = leading;
+					prevTrailing = trailing;
+				}
+			}
+			prev = current;
+		}
+		writer.Flush();
+	}
+
+	bool DecodeFloats(std::span<const unsigned char> stream, size_t rows, float* values, size_t stride) {
+		BitReader reader(stream);
+		auto prev = static_cast<uint32_t>(reader.Read(32));
+		int32_t prevLeading = 0;
+		int32_t prevTrailing = 0;
+		values[0] = std::bit_cast<float>(prev);
+		for (size_t i = 1; i < rows; i++) {
+			if (reader.ReadBit()) {
+				if (reader.ReadBit()) {
+					prevLeading = static_cast<int32_t>(reader.Read(5));
+					auto length = static_cast<int32_t>(reader.Read(5)) + 1;
+					prevTrailing = 32 - prevLeading - length;
+					if (prevTrailing < 0) {
+						return false;
+					}
+				}
+				auto bits = static_cast<uint32_t>(reader.Read(32 - prevLeading - prevTrailing));
+				prev ^= bits << prevTrailing;
+			}
+			values[i * stride] = std::bit_cast<float>(prev);
+		}
+		return !reader.HasError();
+	}
+
+	bool ReadStream(std::span<const unsigned char> block, size_t& offset, std::span<const unsigned char>& stream) {
+		uint64_t size = 0;
+		if (!l::serialization::varint_decode(block, offset, size) || size > block.size() - offset) {
+			return false;
+		}
+		stream = block.subspan(offset, static_cast<size_t>(size));
+		offset += static_cast<size_t>(size);
+		return true;
+	}
+}
+
+namespace l::serialization {
+
+	size_t varint_encode(uint64_t value, std::vector<unsigned char>& out) {
+		size_t count = 1;
+		for (; value >= 0x80; value >>= 7, count++) {
+			out.push_back(static_cast<unsigned char>(value | 0x80));
+		}
+		out.push_back(static_cast<unsigned char>(value));
+		return count;
+	}
+
+	bool varint_decode(std::span<const unsigned char> data, size_t& offset, uint64_t& value) {
+		uint64_t result = 0;
+		for (int32_t shift = 0; shift < 64; shift += 7) {
+			if (offset >= data.size()) {
+				return false;
+			}
+			auto byte = data[offset++];
+			result |= static_cast<uint64_t>(byte & 0x7f) << shift;
+			if ((byte & 0x80) == 0) {
+				value = result;
+				return true;
+			}
+		}
+		return false;
+	}
+
+	TimeSeriesWriter::TimeSeriesWriter(int32_t columns, bool timestamps, int32_t rowsPerBlock) :
+		mColumns(columns),
+		mTimestamps(timestamps),
+		mRowsPerBlock(rowsPerBlock)
+	{
+		ASSERT(columns > 0 && rowsPerBlock > 0);
+		mBlockTimestamps.reserve(timestamps ? static_cast<size_t>(rowsPerBlock) : 0);
+		mBlockValues.reserve(static_cast<size_t>(rowsPerBlock) * columns);
+	}
+
+	void TimeSeriesWriter::Append(int64_t timestamp, std::span<const float> row) {
+		ASSERT(row.size() == static_cast<size_t>(mColumns));
+		if (mTimestamps) {
+			mBlockTimestamps.push_back(timestamp);
+		}
+		mBlockValues.insert(mBlockValues.end(), row.begin(), row.end());
+		mRowCount++;
+		if (mBlockValues.size() == static_cast<size_t>(mRowsPerBlock) * mColumns) {
+			FlushBlock();
+		}
+	}
+
+	void TimeSeriesWriter::Append(std::span<const float> row) {
+		ASSERT(!mTimestamps);
+		Append(0, row);
+	}
+
+	void TimeSeriesWriter::Append(std::span<const int64_t> timestamps, std::span<const float> values) {
+		auto rows = values.size() / mColumns;
+		ASSERT(!mTimestamps || timestamps.size() == rows);
+		for (size_t i = 0; i < rows; i++) {
+			Append(mTimestamps ? timestamps[i] : 0, values.subspan(i * mColumns, mColumns));
+		}
+	}
+
+	void TimeSeriesWriter::FlushBlock() {
+		auto rows = mBlockValues.size() / mColumns;
+		if (rows == 0) {
+			return;
+		}
+		mBlockOffsets.push_back(mBody.size());
+		varint_encode(rows, mBody);
+		auto appendStream = [&]() {
+			varint_encode(mStream.size(), mBody);
+			mBody.insert(mBody.end(), mStream.begin(), mStream.end());
+			mStream.clear();
+			};
+		if (mTimestamps) {
+			EncodeTimestamps(mBlockTimestamps.data(), rows, mStream);
+			appendStream();
+		}
+		for (int32_t column = 0; column < mColumns; column++) {
+			EncodeFloats(mBlockValues.data() + column, rows, static_cast<size_t>(mColumns), mStream);
+			appendStream();
+		}
+		mBlockTimestamps.clear();
+		mBlockValues.clear();
+	}
+
+	void TimeSeriesWriter::Finish(std::vector<unsigned char>& out) {
+		FlushBlock();
+
+		auto base = out.size();
+		auto dataOffset = kHeaderSize + mBlockOffsets.size() * sizeof(uint64_t);
+		out.resize(base + dataOffset);
+		auto dst = out.data() + base;
+		size_t offset = 0;
+		WriteRaw(dst, offset, kMagic);
+		WriteRaw(dst, offset, kVersion);
+		WriteRaw(dst, offset, static_cast<uint16_t>(mTimestamps ? kFlagTimestamps : 0));
+		WriteRaw(dst, offset, static_cast<uint32_t>(mColumns));
+		WriteRaw(dst, offset, static_cast<uint32_t>(mRowsPerBlock));
+		WriteRaw(dst, offset, mRowCount);
+		WriteRaw(dst, offset, static_cast<uint32_t>(mBlockOffsets.size()));
+		for (auto blockOffset : mBlockOffsets) {
+			WriteRaw(dst, offset, static_cast<uint64_t>(blockOffset + dataOffset));
+		}
+		out.insert(out.end(), mBody.begin(), mBody.end());
+
+		mRowCount = 0;
+		mBlockOffsets.clear();
+		mBody.clear();
+	}
+
+	bool TimeSeriesReader::Load(std::span<const unsigned char> data) {
+		mData = {};
+		if (data.size() < kHeaderSize) {
+			return false;
+		}
+		size_t offset = 0;
+		auto magic = ReadRaw<uint32_t>(data.data(), offset);
+		auto version = ReadRaw<uint16_t>(data.data(), offset);
+		auto flags = ReadRaw<uint16_t>(data.data(), offset);
+		auto columns = ReadRaw<uint32_t>(data.data(), offset);
+		auto rowsPerBlock = ReadRaw<uint32_t>(data.data(), offset);
+		auto rowCount = ReadRaw<uint64_t>(data.data(), offset);
+		auto blockCount = ReadRaw<uint32_t>(data.data(), offset);
+		if (magic != kMagic || version != kVersion) {
+			LOG(LogError) << "Not a time series codec stream";
+			return false;
+		}
+		if (columns == 0 || columns > 0xffff || rowsPerBlock == 0 || rowsPerBlock > 0x7fffffff ||
+			blockCount != (rowCount + rowsPerBlock - 1) / rowsPerBlock ||
+			(data.size() - kHeaderSize) / sizeof(uint64_t) < blockCount) {
+			LOG(LogError) << "Corrupt time series header";
+			return false;
+		}
+
+		mData = data;
+		mColumns = static_cast<int32_t>(columns);
+		mTimestamps = (flags & kFlagTimestamps) != 0;
+		mRowsPerBlock = static_cast<int32_t>(rowsPerBlock);
+		mRowCount = rowCount;
+		mBlockCount = static_cast<int32_t>(blockCount);
+		mIndexOffset = kHeaderSize;
+		return true;
+	}
+
+	int32_t TimeSeriesReader::DecodeBlock(int32_t block, int64_t* timestamps, float* values) {
+		if (block < 0 || block >= mBlockCount) {
+			return -1;
+		}
+		size_t indexOffset = mIndexOffset + static_cast<size_t>(block) * sizeof(uint64_t);
+		auto start = ReadRaw<uint64_t>(mData.data(), indexOffset);
+		auto end = block + 1 < mBlockCount ? ReadRaw<uint64_t>(mData.data(), indexOffset) : mData.size();
+		if (start > end || end > mData.size()) {
+			return -1;
+		}
+		auto data = mData.subspan(static_cast<size_t>(start), static_cast<size_t>(end - start));
+
+		// every block but the last is full, a stored count that disagrees would decode past the caller's buffers
+		auto expectedRows = std::min(static_cast<uint64_t>(mRowsPerBlock), mRowCount - static_cast<uint64_t>(block) * mRowsPerBlock);
+		size_t offset = 0;
+		uint64_t rows = 0;
+		if (!varint_decode(data, offset, rows) || rows != expectedRows) {
+			return -1;
+		}
+		std::span<const unsigned char> stream;
+		if (mTimestamps) {
+			if (!ReadStream(data, offset, stream)) {
+				return -1;
+			}
+			if (timestamps != nullptr && !DecodeTimestamps(stream, rows, timestamps)) {
+				return -1;
+			}
+		}
+		if (values != nullptr) {
+			for (int32_t column = 0; column < mColumns; column++) {
+				if (!ReadStream(data, offset, stream) || !DecodeFloats(stream, rows, values + column, static_cast<size_t>(mColumns))) {
+					return -1;
+				}
+			}
+		}
+		return static_cast<int32_t>(rows);
+	}
+
+	bool TimeSeriesReader::Read(uint64_t firstRow, uint64_t count, int64_t* timestamps, float* values) {
+		if (firstRow > mRowCount || count > mRowCount - firstRow) {
+			return false;
+		}
+		auto rowsPerBlock = static_cast<uint64_t>(mRowsPerBlock);
+		auto row = firstRow;
+		auto end = firstRow + count;
+		while (row < end) {
+			auto block = static_cast<int32_t>(row / rowsPerBlock);
+			auto blockStart = static_cast<uint64_t>(block) * rowsPerBlock;
+			auto blockEnd = std::min(blockStart + rowsPerBlock, mRowCount);
+			auto copyEnd = std::min(blockEnd, end);
+			auto outTimestamps = timestamps != nullptr && mTimestamps ? timestamps + (row - firstRow) : nullptr;
+			auto outValues = values != nullptr ? values + (row - firstRow) * mColumns : nullptr;
+
+			if (row == blockStart && copyEnd == blockEnd) {
+				// whole block, decode straight into the output
+				if (DecodeBlock(block, outTimestamps, outValues) != static_cast<int32_t>(blockEnd - blockStart)) {
+					return false;
+				}
+			}
+			else {
+				mScratchTimestamps.resize(static_cast<size_t>(rowsPerBlock));
+				mScratchValues.resize(static_cast<size_t>(rowsPerBlock) * mColumns);
+				if (DecodeBlock(block, mScratchTimestamps.data(), mScratchValues.data()) != static_cast<int32_t>(blockEnd - blockStart)) {
+					return false;
+				}
+				auto first = static_cast<size_t>(row - blockStart);
+				auto rows = static_cast<size_t>(copyEnd - row);
+				if (outTimestamps != nullptr) {
+					memcpy(outTimestamps, mScratchTimestamps.data() + first, rows * sizeof(int64_t));
+				}
+				if (outValues != nullptr) {
+					memcpy(outValues, mScratchValues.data() + first * mColumns, rows * mColumns * sizeof(float));
+				}
+			}
+			row = copyEnd;
+		}
+		return true;
+	}
+}
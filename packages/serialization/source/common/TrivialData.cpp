@@ -5,25 +5,23 @@
 #include <string>
 #include <vector>
 #include <sstream>
+#include <iterator>
+
+namespace {
+	const char kEscapeChar = '\"';
+}
 
 namespace l::serialization {
 
 	std::vector<std::string> ParseTrivialData(std::stringstream& data, std::string_view separators) {
+		std::string text(std::istreambuf_iterator<char>(data), {});
+		auto fields = ParseTrivialData(std::string_view(text), separators);
 
 		std::vector<std::string> out;
-
-		for (std::string line; std::getline(data, line, '\n');) {
-			auto elements = l::string::split(line, separators);
-			int32_t count = 0;
-			for (auto it : elements) {
-				out.push_back(std::string(it));
-				count++;
-			}
-			if (count % 2 != 0) {
-				out.push_back("");
-			}
+		out.reserve(fields.size());
+		for (auto field : fields) {
+			out.emplace_back(field);
 		}
-		ASSERT(out.size() % 2 == 0);
 		return out;
 	}
 
@@ -41,4 +39,94 @@ namespace l::serialization {
 		return map;
 	}
 
+	std::vector<std::string_view> ParseTrivialData(std::string_view data, std::string_view separators) {
+
+		std::vector<std::string_view> out;
+
+		TrivialDataReader reader(data, separators);
+		while (reader.Next()) {
+			auto fields = reader.GetFields();
+			out.insert(out.end(), fields.begin(), fields.end());
+			if (fields.size() % 2 != 0) {
+				out.emplace_back();
+			}
+		}
+		ASSERT(out.size() % 2 == 0);
+		return out;
+	}
+
+	std::unordered_map<uint32_t, std::string_view> ParseTrivialDataMap(std::string_view data, std::string_view separators) {
+
+		std::unordered_map<uint32_t, std::string_view> map;
+
+		TrivialDataReader reader(data, separators);
+		while (reader.Next()) {
+			auto fields = reader.GetFields();
+			for (size_t i = 0; i < fields.size(); i += 2) {
+				map[l::string::string_id(fields[i])] = i + 1 < fields.size() ? fields[i + 1] : std::string_view();
+			}
+		}
+
+		return map;
+	}
+
+	TrivialDataReader::TrivialDataReader(std::string_view data, std::string_view separators) :
+		mData(data),
+		mDelimiters(std::string(separators) + kEscapeChar)
+	{}
+
+	bool TrivialDataReader::Next() {
+		mFields.clear();
+		if (mPos >= mData.size()) {
+			return false;
+		}
+		if (mStarted) {
+			mRow++;
+		}
+		mStarted = true;
+
+		auto end = mData.find('\n', mPos);
+		if (end == std::string_view::npos) {
+			end = mData.size();
+		}
+		auto line = mData.substr(mPos, end - mPos);
+		mPos = end + 1;
+
+		auto insert = [this, &line](size_t start, size_t count) {
+			if (count > 0) {
+				mFields.emplace_back(line.data() + start, count);
+			}
+		};
+
+		// inside an escaped section only the escape character ends the field
+		bool escape = false;
+		size_t start = 0;
+		for (size_t i = 0;; i++) {
+			i = escape ? line.find(kEscapeChar, i) : mDelimiters.find(line, i);
+			if (i >= line.size()) {
+				break;
+			}
+			insert(start, i - start);
+			start = i + 1;
+			if (line[i] == kEscapeChar) {
+				escape = !escape;
+			}
+		}
+		if (start < line.size()) {
+			insert(start, line.size() - start);
+		}
+		return true;
+	}
+
+	size_t ParseTrivialDataRows(std::string_view data, std::string_view separators, const std::function<bool(size_t row, std::span<const std::string_view> fields)>& onRow) {
+		TrivialDataReader reader(data, separators);
+		size_t rows = 0;
+		while (reader.Next()) {
+			rows++;
+			if (!onRow(reader.GetRow(), reader.GetFields())) {
+				break;
+			}
+		}
+		return rows;
+	}
 }
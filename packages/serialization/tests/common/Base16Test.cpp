@@ -3,6 +3,9 @@
 
 #include "serialization/Base16.h"
 
+#include <array>
+#include <vector>
+
 TEST(Base16, Basic) {
 
 	auto message = "test#!%14+,<?=";
@@ -32,3 +35,81 @@ TEST(Base16, RandomInput) {
 	return 0;
 }
 
+TEST(Base16, PreSizedOutput) {
+	for (size_t len = 0; len < 200; len++) {
+		std::vector<unsigned char> message(len);
+		for (auto& c : message) {
+			c = static_cast<unsigned char>(std::rand() % 256);
+		}
+		for (bool lowercase : { true, false }) {
+			std::string encoded(l::serialization::base16_encoded_size(len), ' ');
+			TEST_EQ(l::serialization::base16_encode(message, encoded, lowercase), encoded.size(), "");
+			std::string reference;
+			const char* digits = lowercase ? "0123456789abcdef" : "0123456789ABCDEF";
+			for (auto c : message) {
+				reference += digits[c >> 4];
+				reference += digits[c & 0xf];
+			}
+			TEST_TRUE(encoded == reference, encoded);
+
+			std::vector<unsigned char> decoded(len);
+			auto result = l::serialization::base16_decode(encoded, decoded);
+			TEST_TRUE(result.valid(), encoded);
+			TEST_EQ(result.mSize, len, "");
+			TEST_TRUE(decoded == message, "");
+		}
+	}
+
+	// the pointer version writes one byte per character pair
+	std::array<unsigned char, 3> dst = {};
+	l::serialization::base16_decode(dst.data(), "0aFf10");
+	TEST_EQ(dst[0], 0x0a, "");
+	TEST_EQ(dst[1], 0xff, "");
+	TEST_EQ(dst[2], 0x10, "");
+	return 0;
+}
+
+TEST(Base16, Validation) {
+	std::array<unsigned char, 64> dst;
+	std::string valid = "000102030405060708090a0b0c0d0e0f101112131415161718191A1B1C1D1E1F2021";
+	for (size_t pos : { 0, 7, 33, 50, 67 }) {
+		std::string invalid = valid;
+		invalid[pos] = 'g';
+		auto result = l::serialization::base16_decode(invalid, dst);
+		TEST_FALSE(result.valid(), invalid);
+		TEST_EQ(result.mErrorPosition, pos, invalid);
+		TEST_EQ(result.mSize, pos / 2, "");
+	}
+
+	auto odd = l::serialization::base16_decode("abc", dst);
+	TEST_EQ(odd.mErrorPosition, 2u, "");
+	TEST_EQ(odd.mSize, 1u, "");
+
+	std::array<unsigned char, 1> small;
+	auto overflow = l::serialization::base16_decode("abcd", small);
+	TEST_EQ(overflow.mErrorPosition, 2u, "");
+	return 0;
+}
+
+PERF_TEST(Base16, CodecTimings) {
+	std::vector<unsigned char> message(1 << 20);
+	for (auto& c : message) {
+		c = static_cast<unsigned char>(std::rand() % 256);
+	}
+	std::string encoded(l::serialization::base16_encoded_size(message.size()), ' ');
+	std::vector<unsigned char> decoded(message.size());
+	{
+		PERF_TIMER("Base16::Encode1MB");
+		for (int i = 0; i < 100; i++) {
+			l::serialization::base16_encode(message, encoded);
+		}
+	}
+	{
+		PERF_TIMER("Base16::Decode1MB");
+		for (int i = 0; i < 100; i++) {
+			l::serialization::base16_decode(encoded, decoded);
+		}
+	}
+	TEST_TRUE(decoded == message, "");
+	return 0;
+}
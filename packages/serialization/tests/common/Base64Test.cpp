@@ -3,6 +3,10 @@
 
 #include "serialization/Base64.h"
 
+#include <algorithm>
+#include <array>
+#include <vector>
+
 TEST(Base64, Basic) {
 
 	auto message = "test#!%14+,<?=";
@@ -32,3 +36,116 @@ TEST(Base64, RandomInput) {
 	return 0;
 }
 
+TEST(Base64, PreSizedOutput) {
+	// every length around the vector block sizes, checked against the RFC 4648 test vectors and a bitwise reference
+	std::string_view vectors[][2] = { {"", ""}, {"f", "Zg=="}, {"fo", "Zm8="}, {"foo", "Zm9v"}, {"foob", "Zm9vYg=="}, {"fooba", "Zm9vYmE="}, {"foobar", "Zm9vYmFy"} };
+	for (auto& vector : vectors) {
+		TEST_TRUE(l::serialization::base64_encode(vector[0]) == vector[1], vector[1]);
+		TEST_TRUE(l::serialization::base64_decode(vector[1]) == vector[0], vector[0]);
+	}
+
+	const char* alphabet = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+	for (size_t len = 0; len < 200; len++) {
+		std::vector<unsigned char> message(len);
+		for (auto& c : message) {
+			c = static_cast<unsigned char>(std::rand() % 256);
+		}
+
+		std::string reference;
+		uint32_t value = 0;
+		int32_t bits = 0;
+		for (auto c : message) {
+			value = (value << 8) | c;
+			bits += 8;
+			while (bits >= 6) {
+				bits -= 6;
+				reference += alphabet[(value >> bits) & 0x3f];
+			}
+		}
+		if (bits > 0) {
+			reference += alphabet[(value << (6 - bits)) & 0x3f];
+		}
+		while (reference.size() % 4) {
+			reference += '=';
+		}
+
+		std::string encoded(l::serialization::base64_encoded_size(len), ' ');
+		auto written = l::serialization::base64_encode(message, encoded);
+		TEST_EQ(written, encoded.size(), "");
+		TEST_TRUE(encoded == reference, reference);
+
+		std::vector<unsigned char> decoded(l::serialization::base64_decoded_size(encoded.size()));
+		auto result = l::serialization::base64_decode(encoded, decoded);
+		TEST_TRUE(result.valid(), encoded);
+		TEST_EQ(result.mSize, len, "");
+		TEST_TRUE(std::equal(message.begin(), message.end(), decoded.begin()), "");
+
+		// the exact size is enough, the vector stores back off near the end
+		std::vector<unsigned char> exact(len);
+		TEST_TRUE(l::serialization::base64_decode(encoded, exact).valid(), "");
+		TEST_TRUE(exact == message, "");
+	}
+	return 0;
+}
+
+TEST(Base64, Validation) {
+	std::array<unsigned char, 128> dst;
+	std::string valid = "QUJDREVGR0hJSktMTU5PUFFSU1RVVldYWVphYmNkZWZnaGlqa2xtbm9wcXJzdHV2d3h5eg==";
+
+	for (size_t pos : { 0, 5, 31, 40, 70 }) {
+		std::string invalid = valid;
+		invalid[pos] = '*';
+		auto result = l::serialization::base64_decode(invalid, dst);
+		TEST_FALSE(result.valid(), invalid);
+		TEST_EQ(result.mErrorPosition, pos, invalid);
+		TEST_EQ(result.mSize, pos * 6 / 8, "");
+	}
+
+	auto unpadded = l::serialization::base64_decode("Zm9vYg", dst);
+	TEST_TRUE(unpadded.valid(), "");
+	TEST_EQ(unpadded.mSize, 4u, "");
+
+	auto dangling = l::serialization::base64_decode("Zm9vY", dst);
+	TEST_EQ(dangling.mErrorPosition, 4u, "");
+	auto earlyPadding = l::serialization::base64_decode("Zg==Zm8=", dst);
+	TEST_EQ(earlyPadding.mErrorPosition, 2u, "");
+	auto misplacedPadding = l::serialization::base64_decode("Z===", dst);
+	TEST_EQ(misplacedPadding.mErrorPosition, 1u, "");
+	auto whitespace = l::serialization::base64_decode("Zm9v\nYg==", dst);
+	TEST_EQ(whitespace.mErrorPosition, 4u, "");
+
+	// running out of space is an error at the first character that didn't fit
+	std::array<unsigned char, 2> small;
+	auto overflow = l::serialization::base64_decode("Zm9vYmFy", small);
+	TEST_FALSE(overflow.valid(), "");
+	TEST_EQ(overflow.mSize, 2u, "");
+	TEST_EQ(overflow.mErrorPosition, 3u, "");
+
+	std::array<char, 4> smallText;
+	std::array<unsigned char, 4> data = { 1, 2, 3, 4 };
+	TEST_EQ(l::serialization::base64_encode(data, smallText), 0u, "");
+	return 0;
+}
+
+PERF_TEST(Base64, CodecTimings) {
+	std::vector<unsigned char> message(1 << 20);
+	for (auto& c : message) {
+		c = static_cast<unsigned char>(std::rand() % 256);
+	}
+	std::string encoded(l::serialization::base64_encoded_size(message.size()), ' ');
+	std::vector<unsigned char> decoded(message.size());
+	{
+		PERF_TIMER("Base64::Encode1MB");
+		for (int i = 0; i < 100; i++) {
+			l::serialization::base64_encode(message, encoded);
+		}
+	}
+	{
+		PERF_TIMER("Base64::Decode1MB");
+		for (int i = 0; i < 100; i++) {
+			l::serialization::base64_decode(encoded, decoded);
+		}
+	}
+	TEST_TRUE(decoded == message, "");
+	return 0;
+}
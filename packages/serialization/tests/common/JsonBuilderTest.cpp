@@ -0,0 +1,118 @@
+#include "testing/Test.h"
+#include "logging/Log.h"
+
+#include "serialization/JsonBuilder.h"
+#include "serialization/JsonParser.h"
+
+#include <array>
+#include <string>
+
+namespace {
+	void BuildOrder(l::serialization::JsonBuilder& json, int32_t i) {
+		json.Begin("");
+		{
+			json.AddString("symbol", "BTCUSDT");
+			json.AddString("side", i % 2 == 0 ? "BUY" : "SELL");
+			json.AddNumber("quantity", 0.001f * static_cast<float>(i + 1));
+			json.AddNumber("price", 97431.99 + i);
+			json.AddNumber("timestamp", int64_t(1731096600000) + i, true);
+			json.Begin("flags", true);
+			{
+				json.AddNumber("", i);
+				json.AddNumber("", -i);
+			}
+			json.End(true);
+		}
+		json.End();
+	}
+}
+
+TEST(JsonBuilder, BufferModes) {
+	std::stringstream stream;
+	l::serialization::JsonBuilder streamBuilder;
+	streamBuilder.SetStream(&stream);
+	BuildOrder(streamBuilder, 3);
+
+	std::string buffer;
+	l::serialization::JsonBuilder builder;
+	builder.SetBuffer(&buffer);
+	BuildOrder(builder, 3);
+	TEST_TRUE(buffer == stream.str(), buffer);
+	TEST_TRUE(builder.GetView() == buffer, "");
+
+	std::string_view expected = "{\"symbol\":\"BTCUSDT\",\"side\":\"SELL\",\"quantity\":0.004,\"price\":97434.99,\"timestamp\":\"1731096600003\",\"flags\":[3,-3]}";
+	TEST_TRUE(buffer == expected, buffer);
+
+	std::array<char, 256> fixed;
+	l::serialization::JsonBuilder fixedBuilder;
+	fixedBuilder.SetBuffer(std::span<char>(fixed));
+	BuildOrder(fixedBuilder, 3);
+	TEST_FALSE(fixedBuilder.HasOverflow(), "");
+	TEST_TRUE(fixedBuilder.GetView() == expected, "");
+
+	std::array<char, 16> small;
+	l::serialization::JsonBuilder smallBuilder;
+	smallBuilder.SetBuffer(std::span<char>(small));
+	BuildOrder(smallBuilder, 3);
+	TEST_TRUE(smallBuilder.HasOverflow(), "");
+	TEST_TRUE(smallBuilder.GetView() == expected.substr(0, 16), "");
+
+	std::string precise;
+	l::serialization::JsonBuilder preciseBuilder;
+	preciseBuilder.SetBuffer(&precise);
+	preciseBuilder.SetFloatPrecision(2);
+	preciseBuilder.AddNumber("", 0.125);
+	preciseBuilder.AddNumber("", 1e-7f);
+	TEST_TRUE(precise == "0.12,0.00", precise);
+	return 0;
+}
+
+TEST(JsonBuilder, Escaping) {
+	std::string text = "quote\" backslash\\ newline\n tab\t bell\x07 and a long run without anything to escape";
+	std::string buffer;
+	l::serialization::JsonBuilder builder;
+	builder.SetBuffer(&buffer);
+	builder.Begin("");
+	builder.AddString("te\"xt", text);
+	builder.AddNumber("shortest", 0.1);
+	builder.AddNumber("float", 3.3f);
+	builder.AddString("generated", [](std::stringstream& json) {
+		json << "say \"hi\"";
+		});
+	builder.End();
+
+	TEST_TRUE(buffer.find("\\u0007") != std::string::npos, buffer);
+
+	l::serialization::JsonParser<16> parser;
+	auto [result, error] = parser.LoadJson(buffer.c_str(), buffer.size());
+	TEST_TRUE(result, buffer);
+	auto root = parser.GetRoot();
+	TEST_TRUE(root.get("te\\\"xt").as_unescaped_string() == text, "");
+	TEST_TRUE(root.get("shortest").as_string() == "0.1", "");
+	TEST_TRUE(root.get("float").as_string() == "3.3", "");
+	TEST_EQ(root.get("float").as_float(), 3.3f, "");
+	TEST_TRUE(root.get("generated").as_unescaped_string() == "say \"hi\"", "");
+	return 0;
+}
+
+PERF_TEST(JsonBuilder, BuilderTimings) {
+	{
+		PERF_TIMER("JsonBuilder::Stream");
+		l::serialization::JsonBuilder builder;
+		for (int i = 0; i < 100000; i++) {
+			builder.Reset();
+			BuildOrder(builder, i);
+		}
+	}
+	{
+		PERF_TIMER("JsonBuilder::Buffer");
+		std::string buffer;
+		l::serialization::JsonBuilder builder;
+		builder.SetBuffer(&buffer);
+		for (int i = 0; i < 100000; i++) {
+			builder.Reset();
+			BuildOrder(builder, i);
+		}
+	}
+	return 0;
+}
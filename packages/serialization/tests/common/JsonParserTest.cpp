@@ -0,0 +1,288 @@
+#include "testing/Test.h"
+#include "logging/Log.h"
+
+#include "serialization/JsonParser.h"
+
+#include <memory>
+#include <string>
+
+namespace {
+	std::string CreateCandleArray(int32_t count) {
+		std::string json = "[";
+		for (int32_t i = 0; i < count; i++) {
+			if (i > 0) {
+				json += ",";
+			}
+			json += "{\"t\":" + std::to_string(1731096600 + i * 60) + ",\"o\":0.5,\"c\":-1.25e2,\"s\":\"BTCUSDT\",\"x\":true}";
+		}
+		json += "]";
+		return json;
+	}
+
+	// Recorded from the Binance kline and partial depth streams
+	const std::string_view kKlinePayload = R"({"stream":"solusdt@kline_1m","data":{"e":"kline","E":1731096660008,"s":"SOLUSDT","k":{"t":1731096600000,"T":1731096659999,"s":"SOLUSDT","i":"1m","f":907535417,"L":907535829,"o":"198.06000000","c":"198.11000000","h":"198.13000000","l":"198.05000000","v":"1120.61900000","n":413,"x":true,"q":"221996.99474000","V":"697.87600000","Q":"138250.44373000","B":"0"}}})";
+	const std::string_view kDepthPayload = R"({"lastUpdateId":57103592233,"bids":[["97431.99000000","2.84627000"],["97431.98000000","0.00040000"],["97431.95000000","0.00010000"],["97431.94000000","0.00016000"],["97431.73000000","0.00018000"],["97431.72000000","0.05000000"],["97431.60000000","0.00018000"],["97431.53000000","0.11000000"],["97431.52000000","0.00016000"],["97431.50000000","0.05770000"]],"asks":[["97432.00000000","3.27102000"],["97432.01000000","0.00300000"],["97432.02000000","0.00060000"],["97432.11000000","0.00030000"],["97432.15000000","0.00200000"],["97432.16000000","0.00040000"],["97432.40000000","0.00020000"],["97432.44000000","0.00800000"],["97432.50000000","0.03020000"],["97432.51000000","0.00300000"]]})";
+
+	bool SameTokens(std::string_view json) {
+		std::vector<jsmntok_t> expected(json.size() + 1);
+		jsmn_parser parser;
+		jsmn_init(&parser);
+		auto count = jsmn_parse(&parser, json.data(), json.size(), expected.data(), static_cast<unsigned int>(expected.size()));
+
+		std::vector<jsmntok_t> tokens;
+		l::serialization::JsonStructural structural;
+		auto result = structural.Parse(json.data(), json.size(), tokens, true);
+		if (count < 0 || result != count) {
+			LOG(LogError) << "Token count " << result << " expected " << count << " for " << json;
+			return count < 0 && result < 0;
+		}
+		for (int i = 0; i < count; i++) {
+			const auto& a = expected[i];
+			const auto& b = tokens[i];
+			if (a.type != b.type || a.start != b.start || a.end != b.end || a.size != b.size) {
+				LOG(LogError) << "Token " << i << " differs for " << json;
+				return false;
+			}
+		}
+		return true;
+	}
+}
+
+TEST(JsonParser, GrowableTokens) {
+	auto json = CreateCandleArray(500);
+
+	l::serialization::JsonParser<64> fixedParser;
+	auto [fixedResult, fixedError] = fixedParser.LoadJson(json.c_str(), json.size());
+	TEST_FALSE(fixedResult, "");
+	TEST_EQ(fixedError, JSMN_ERROR_NOMEM, "");
+
+	l::serialization::JsonStreamParser<64> parser;
+	auto [result, error] = parser.LoadJson(json.c_str(), json.size());
+	TEST_TRUE(result, "Error: " + std::to_string(error));
+	TEST_EQ(parser.GetTokenCount(), 1 + 500 * 11, "");
+	TEST_TRUE(parser.GetTokenCapacity() >= parser.GetTokenCount(), "");
+
+	auto root = parser.GetRoot();
+	TEST_EQ(root.size(), 500, "");
+	auto last = root[499];
+	TEST_EQ(last.get("t").as_int32(), 1731096600 + 499 * 60, "");
+	TEST_TRUE(last.get("s").as_string() == "BTCUSDT", "");
+
+	// reuse with a smaller document
+	std::string small = "{\"a\":1}";
+	auto [smallResult, smallError] = parser.LoadJson(small.c_str(), small.size());
+	TEST_TRUE(smallResult, "");
+	TEST_EQ(parser.GetTokenCount(), 3, "");
+	return 0;
+}
+
+TEST(JsonParser, IncrementalParsing) {
+	auto json = CreateCandleArray(20);
+
+	for (size_t chunk : {1, 3, 7, 64}) {
+		l::serialization::JsonStreamParser<16> parser;
+		std::string buffer;
+		bool done = false;
+		for (size_t pos = 0; pos < json.size(); pos += chunk) {
+			buffer.append(json, pos, chunk);
+			auto [result, error] = parser.ResumeJson(buffer.c_str(), buffer.size());
+			if (result) {
+				done = true;
+				TEST_TRUE(pos + chunk >= json.size(), "");
+				break;
+			}
+			TEST_EQ(error, JSMN_ERROR_PART, "");
+			TEST_TRUE(parser.IsPending(), "");
+		}
+		TEST_TRUE(done, "");
+		TEST_FALSE(parser.IsPending(), "");
+
+		auto root = parser.GetRoot();
+		TEST_EQ(root.size(), 20, "");
+		auto candle = root[7];
+		TEST_EQ(candle.get("t").as_int32(), 1731096600 + 7 * 60, "");
+		TEST_FUZZY(candle.get("c").as_double(), -125.0, 0.0000001, "");
+		TEST_TRUE(candle.get("x").as_bool(), "");
+	}
+
+	// a number split between two frames is not cut short
+	l::serialization::JsonStreamParser<16> parser;
+	std::string frame = "{\"price\":12";
+	auto [partResult, partError] = parser.ResumeJson(frame.c_str(), frame.size());
+	TEST_FALSE(partResult, "");
+	frame += "345.5}";
+	auto [result, error] = parser.ResumeJson(frame.c_str(), frame.size());
+	TEST_TRUE(result, "");
+	TEST_FUZZY(parser.GetRoot().get("price").as_double(), 12345.5, 0.0000001, "");
+	return 0;
+}
+
+TEST(JsonParser, IndexedNavigation) {
+	std::string json = "{\"nested\":{\"a\":[1,{\"b\":2},3],\"c\":null},\"after\":4";
+	for (int32_t i = 0; i < 40; i++) {
+		json += ",\"key" + std::to_string(i) + "\":{\"v\":" + std::to_string(i) + "}";
+	}
+	json += ",\"key7\":\"duplicate\"}";
+
+	l::serialization::JsonParser<500> parser;
+	auto [result, error] = parser.LoadJson(json.c_str(), json.size());
+	TEST_TRUE(result, "");
+
+	auto root = parser.GetRoot();
+	TEST_EQ(root.span(root.end_token() - 1), 1, "");
+	TEST_EQ(root.get("after").as_int32(), 4, "");
+	TEST_EQ(root.get("key0").get("v").as_int32(), 0, "");
+	TEST_EQ(root.get("key39").get("v").as_int32(), 39, "");
+	TEST_EQ(root.get("key7").get("v").as_int32(), 7, "");
+	TEST_FALSE(root.has_key("key40"), "");
+	TEST_FALSE(root.has_key("v"), "");
+	TEST_TRUE(root.get("nested").is_null("c"), "");
+
+	// values from an iterator only see their own subtree
+	auto nested = root.get("nested");
+	auto array = nested.get("a");
+	TEST_EQ(array.size(), 3, "");
+	auto it = array.as_array();
+	int count = 0;
+	while (it.has_next()) {
+		auto value = it.next();
+		if (count == 1) {
+			TEST_EQ(value.get("b").as_int32(), 2, "");
+			TEST_FALSE(value.has_key("c"), "");
+		}
+		count++;
+	}
+	TEST_EQ(count, 3, "");
+	TEST_EQ(array[2].as_int32(), 3, "");
+	TEST_EQ(array.end_ptr()[-1], '3', "");
+	return 0;
+}
+
+TEST(JsonParser, StructuralIndex) {
+	TEST_TRUE(SameTokens(kKlinePayload), "");
+	TEST_TRUE(SameTokens(kDepthPayload), "");
+	TEST_TRUE(SameTokens(CreateCandleArray(50)), "");
+	TEST_TRUE(SameTokens(" [ 1 , -2.5e3 ,true,null , \"\" , {} , [ ] ] "), "");
+
+	// escapes and strings crossing 64 byte block boundaries
+	for (size_t pad = 0; pad < 70; pad++) {
+		std::string json = "{\"" + std::string(pad, 'a') + "\\\\\":\"x\\\"}\\\\\",\"b\":[\"" + std::string(pad, '\\') + std::string(pad, '\\') + "\",2]}";
+		TEST_TRUE(SameTokens(json), json);
+		l::serialization::JsonSimdParser<> parser;
+		auto [result, error] = parser.LoadJson(json.c_str(), json.size());
+		TEST_TRUE(result, json);
+		TEST_EQ(parser.GetRoot().get("b")[1].as_int32(), 2, json);
+	}
+
+	// random structure built from pieces that are valid json values
+	const char* pieces[] = { "1", "\"a\\\"b\"", "true", "null", "-0.5", "\"\\\\\"", "\"{[:,]}\"" };
+	for (int i = 0; i < 200; i++) {
+		std::string json = "[";
+		int depth = 1;
+		int count = 0;
+		while (json.size() < 300) {
+			if (count > 0) {
+				json += std::rand() % 3 == 0 ? " , " : ",";
+			}
+			switch (std::rand() % 4) {
+			case 0: json += "["; depth++; count = 0; continue;
+			case 1: json += "{\"k\":"; json += pieces[std::rand() % 7]; json += "}"; break;
+			default: json += pieces[std::rand() % 7]; break;
+			}
+			count++;
+			if (depth > 1 && std::rand() % 4 == 0) {
+				json += "]";
+				depth--;
+			}
+		}
+		for (; depth > 0; depth--) {
+			json += "]";
+		}
+		TEST_TRUE(SameTokens(json), json);
+	}
+
+	l::serialization::JsonSimdParser<> parser;
+	std::string bad = "{\"a\":[1,2}";
+	auto [badResult, badError] = parser.LoadJson(bad.c_str(), bad.size());
+	TEST_FALSE(badResult, "");
+	TEST_EQ(badError, JSMN_ERROR_INVAL, "");
+	std::string partial = "{\"a\":\"unterminated";
+	auto [partResult, partError] = parser.LoadJson(partial.c_str(), partial.size());
+	TEST_FALSE(partResult, "");
+	TEST_EQ(partError, JSMN_ERROR_PART, "");
+
+	l::serialization::JsonParser<10, false, l::serialization::JsonBackend::Simd> fixedParser;
+	auto [fixedResult, fixedError] = fixedParser.LoadJson(kKlinePayload.data(), kKlinePayload.size());
+	TEST_FALSE(fixedResult, "");
+	TEST_EQ(fixedError, JSMN_ERROR_NOMEM, "");
+
+	auto [result, error] = parser.LoadJson(kKlinePayload.data(), kKlinePayload.size());
+	TEST_TRUE(result, "");
+	auto k = parser.GetRoot().get("data").get("k");
+	TEST_EQ(k.get("n").as_int32(), 413, "");
+	TEST_FUZZY(k.get("c").as_double(), 198.11, 0.0000001, "");
+	return 0;
+}
+
+PERF_TEST(JsonParser, BackendTimings) {
+	auto candles = CreateCandleArray(1000);
+	std::string_view payloads[] = { kKlinePayload, kDepthPayload, candles };
+	const char* names[] = { "Kline", "Depth", "Candles" };
+	const int iterations[] = { 20000, 20000, 100 };
+
+	for (size_t p = 0; p < 3; p++) {
+		auto payload = payloads[p];
+		size_t tokens = 0;
+		{
+			PERF_TIMER(std::string("JsonParser::Jsmn::") + names[p]);
+			l::serialization::JsonStreamParser<> parser;
+			for (int i = 0; i < iterations[p]; i++) {
+				parser.LoadJson(payload.data(), payload.size());
+				tokens += parser.GetTokenCount();
+			}
+		}
+		{
+			PERF_TIMER(std::string("JsonParser::Simd::") + names[p]);
+			l::serialization::JsonSimdParser<> parser;
+			for (int i = 0; i < iterations[p]; i++) {
+				parser.LoadJson(payload.data(), payload.size());
+				tokens -= parser.GetTokenCount();
+			}
+		}
+		TEST_EQ(tokens, 0u, "");
+	}
+	return 0;
+}
+
+PERF_TEST(JsonParser, ParserTimings) {
+	auto json = CreateCandleArray(1000);
+
+	{
+		PERF_TIMER("JsonParser::FixedTokens");
+		auto parser = std::make_unique<l::serialization::JsonParser<12000>>();
+		for (int i = 0; i < 100; i++) {
+			parser->LoadJson(json.c_str(), json.size());
+		}
+	}
+	{
+		PERF_TIMER("JsonParser::GrowableTokens");
+		l::serialization::JsonStreamParser<> parser;
+		for (int i = 0; i < 100; i++) {
+			parser.LoadJson(json.c_str(), json.size());
+		}
+	}
+	{
+		auto parser = std::make_unique<l::serialization::JsonParser<12000>>();
+		parser->LoadJson(json.c_str(), json.size());
+		auto root = parser->GetRoot();
+		PERF_TIMER("JsonParser::RandomAccess");
+		int64_t sum = 0;
+		for (int i = 0; i < 100; i++) {
+			for (int j = 0; j < 1000; j += 7) {
+				sum += root[j].get("t").as_int64();
+			}
+		}
+		TEST_TRUE(sum > 0, "");
+	}
+	return 0;
+}
@@ -0,0 +1,172 @@
+#include "testing/Test.h"
+#include "logging/Log.h"
+
+#include "serialization/JsonReflection.h"
+
+#include <array>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace l::serialization;
+
+namespace {
+	const std::string_view kKlinePayload = R"({"stream":"solusdt@kline_1m","data":{"e":"kline","E":1731096660008,"s":"SOLUSDT","k":{"t":1731096600000,"T":1731096659999,"s":"SOLUSDT","i":"1m","f":907535417,"L":907535829,"o":"198.06000000","c":"198.11000000","h":"198.13000000","l":"198.05000000","v":"1120.61900000","n":413,"x":true,"q":"221996.99474000","V":"697.87600000","Q":"138250.44373000","B":"0"}}})";
+	const std::string_view kDepthPayload = R"({"lastUpdateId":57103592233,"bids":[["97431.99000000","2.84627000"],["97431.98000000","0.00040000"],["97431.95000000","0.00010000"]],"asks":[["97432.00000000","3.27102000"],["97432.01000000","0.00300000"]]})";
+
+	struct Candle {
+		int64_t mOpenTime = 0;
+		int64_t mCloseTime = 0;
+		float mOpen = 0.0f;
+		float mClose = 0.0f;
+		float mHigh = 0.0f;
+		float mLow = 0.0f;
+		float mVolume = 0.0f;
+		int32_t mTrades = 0;
+		bool mClosed = false;
+		std::string mInterval;
+
+		static constexpr auto kJsonFields = std::make_tuple(
+			json_field("t", &Candle::mOpenTime),
+			json_field("T", &Candle::mCloseTime),
+			json_field("o", &Candle::mOpen),
+			json_field("c", &Candle::mClose),
+			json_field("h", &Candle::mHigh),
+			json_field("l", &Candle::mLow),
+			json_field("v", &Candle::mVolume),
+			json_field("n", &Candle::mTrades),
+			json_field("x", &Candle::mClosed),
+			json_field("i", &Candle::mInterval));
+	};
+
+	struct KlineEvent {
+		std::string_view mType;
+		int64_t mEventTime = 0;
+		std::string_view mSymbol;
+		Candle mCandle;
+
+		static constexpr auto kJsonFields = std::make_tuple(
+			json_field("e", &KlineEvent::mType),
+			json_field("E", &KlineEvent::mEventTime),
+			json_field("s", &KlineEvent::mSymbol),
+			json_field("k", &KlineEvent::mCandle));
+	};
+
+	struct KlineStream {
+		std::string mStream;
+		KlineEvent mData;
+
+		static constexpr auto kJsonFields = std::make_tuple(
+			json_field("stream", &KlineStream::mStream),
+			json_field("data", &KlineStream::mData));
+	};
+
+	struct Depth {
+		uint64_t mLastUpdateId = 0;
+		std::vector<std::array<double, 2>> mBids;
+		std::vector<std::array<double, 2>> mAsks;
+
+		static constexpr auto kJsonFields = std::make_tuple(
+			json_field("lastUpdateId", &Depth::mLastUpdateId),
+			json_field("bids", &Depth::mBids),
+			json_field("asks", &Depth::mAsks));
+	};
+}
+
+TEST(JsonReflection, DecodeKline) {
+	JsonParser<100> parser;
+	auto [result, error] = parser.LoadJson(kKlinePayload.data(), kKlinePayload.size());
+	TEST_TRUE(result, "");
+
+	KlineStream kline;
+	TEST_TRUE(json_decode(parser.GetRoot(), kline), "");
+	TEST_TRUE(kline.mStream == "solusdt@kline_1m", "");
+	TEST_TRUE(kline.mData.mType == "kline", "");
+	TEST_TRUE(kline.mData.mSymbol == "SOLUSDT", "");
+	TEST_EQ(kline.mData.mEventTime, 1731096660008, "");
+
+	auto& candle = kline.mData.mCandle;
+	TEST_EQ(candle.mOpenTime, 1731096600000, "");
+	TEST_EQ(candle.mCloseTime, 1731096659999, "");
+	TEST_FUZZY(candle.mOpen, 198.06f, 0.0001f, "");
+	TEST_FUZZY(candle.mClose, 198.11f, 0.0001f, "");
+	TEST_FUZZY(candle.mVolume, 1120.619f, 0.001f, "");
+	TEST_EQ(candle.mTrades, 413, "");
+	TEST_TRUE(candle.mClosed, "");
+	TEST_TRUE(candle.mInterval == "1m", "");
+
+	// same payload through the accessor chains
+	auto k = parser.GetRoot().get("data").get("k");
+	TEST_EQ(k.get("t").as_int64(), candle.mOpenTime, "");
+	TEST_EQ(k.get("c").as_float(), candle.mClose, "");
+	return 0;
+}
+
+TEST(JsonReflection, DecodeDepth) {
+	JsonSimdParser<> parser;
+	auto [result, error] = parser.LoadJson(kDepthPayload.data(), kDepthPayload.size());
+	TEST_TRUE(result, "");
+
+	Depth depth;
+	TEST_TRUE(json_decode(parser.GetRoot(), depth), "");
+	TEST_EQ(depth.mLastUpdateId, 57103592233ull, "");
+	TEST_EQ(depth.mBids.size(), 3u, "");
+	TEST_EQ(depth.mAsks.size(), 2u, "");
+	TEST_FUZZY(depth.mBids[0][0], 97431.99, 0.0000001, "");
+	TEST_FUZZY(depth.mBids[2][1], 0.0001, 0.0000001, "");
+	TEST_FUZZY(depth.mAsks[1][1], 0.003, 0.0000001, "");
+
+	// conversion failures are reported, other fields are still decoded
+	std::string bad = "{\"lastUpdateId\":\"abc\",\"bids\":[[\"1\",\"2\"]],\"unknown\":{\"bids\":1}}";
+	auto [badResult, badError] = parser.LoadJson(bad.c_str(), bad.size());
+	TEST_TRUE(badResult, "");
+	Depth badDepth;
+	TEST_FALSE(json_decode(parser.GetRoot(), badDepth), "");
+	TEST_EQ(badDepth.mBids.size(), 1u, "");
+	TEST_FUZZY(badDepth.mBids[0][1], 2.0, 0.0000001, "");
+
+	// bools only decode from bool literals
+	for (std::string_view closed : { "\"true\"", "{\"a\":1}", "[true]", "null" }) {
+		std::string text = "{\"x\":" + std::string(closed) + "}";
+		auto [closedResult, closedError] = parser.LoadJson(text.c_str(), text.size());
+		TEST_TRUE(closedResult, text);
+		Candle candle;
+		TEST_FALSE(json_decode(parser.GetRoot(), candle), text);
+		TEST_FALSE(candle.mClosed, text);
+	}
+	return 0;
+}
+
+PERF_TEST(JsonReflection, DecodeTimings) {
+	JsonParser<100> parser;
+	parser.LoadJson(kKlinePayload.data(), kKlinePayload.size());
+	auto k = parser.GetRoot().get("data").get("k");
+	double sum = 0.0;
+	{
+		PERF_TIMER("JsonReflection::AccessorChains");
+		for (int i = 0; i < 100000; i++) {
+			Candle candle;
+			candle.mOpenTime = k.get("t").as_int64();
+			candle.mCloseTime = k.get("T").as_int64();
+			candle.mOpen = k.get("o").as_float();
+			candle.mClose = k.get("c").as_float();
+			candle.mHigh = k.get("h").as_float();
+			candle.mLow = k.get("l").as_float();
+			candle.mVolume = k.get("v").as_float();
+			candle.mTrades = k.get("n").as_int32();
+			candle.mClosed = k.get("x").as_bool();
+			candle.mInterval = k.get("i").as_string();
+			sum += candle.mClose;
+		}
+	}
+	{
+		PERF_TIMER("JsonReflection::Decode");
+		for (int i = 0; i < 100000; i++) {
+			Candle candle;
+			json_decode(k, candle);
+			sum -= candle.mClose;
+		}
+	}
+	TEST_FUZZY(sum, 0.0, 0.0000001, "");
+	return 0;
+}
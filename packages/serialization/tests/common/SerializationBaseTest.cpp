@@ -4,6 +4,8 @@
 #include <logging/String.h>
 
 #include <memory>
+#include <span>
+#include <algorithm>
 #include <filesystem>
 
 using namespace l;
@@ -147,6 +149,63 @@ TEST(SerializationBase, Basics) {
 
 
 
+class Trades : public SerializationBase {
+public:
+	static const int32_t LatestVersion = 1;
+
+	Trades(bool viewArchive = false) : SerializationBase(0, LatestVersion, true, false, true), mViewArchive(viewArchive) {}
+	virtual ~Trades() = default;
+
+	virtual void Save(SaveArchive& archive) const {
+		archive(mSymbol, mPrices);
+	}
+	virtual void Load(LoadArchive& archive) {
+		archive(mSymbol, mPrices);
+	}
+	virtual bool SaveView(ViewSaveArchive& archive) const {
+		return mViewArchive && archive(mSymbol, mPrices);
+	}
+	virtual bool LoadView(ViewLoadArchive& archive) {
+		return mViewArchive && archive(mSymbol, mPrices);
+	}
+
+	bool mViewArchive = false;
+	std::string mSymbol;
+	std::vector<double> mPrices;
+};
+
+TEST(SerializationBase, ViewArchives) {
+	Trades trades;
+	trades.mSymbol = "BTCUSDT";
+	trades.mPrices = { 97431.99, 97432.0, 97432.01 };
+
+	std::vector<unsigned char> data;
+	trades.GetArchiveData(data);
+
+	// both the zpp fallback and the view archive write the same bytes into a pre-reserved span
+	for (bool viewArchive : { false, true }) {
+		Trades source(viewArchive);
+		source.mSymbol = trades.mSymbol;
+		source.mPrices = trades.mPrices;
+
+		std::vector<unsigned char> reserved(256);
+		auto size = source.GetArchiveData(std::span<unsigned char>(reserved));
+		TEST_EQ(size, data.size(), "");
+		TEST_TRUE(std::equal(data.begin(), data.end(), reserved.begin()), "");
+
+		std::vector<unsigned char> small(8);
+		TEST_EQ(source.GetArchiveData(std::span<unsigned char>(small)), 0u, "");
+
+		// loading reads the view in place
+		Trades target(viewArchive);
+		TEST_TRUE(target.LoadArchiveData(std::span<const unsigned char>(reserved.data(), size)), "");
+		TEST_EQ(target.GetVersion(), Trades::LatestVersion, "");
+		TEST_TRUE(target.mSymbol == "BTCUSDT", "");
+		TEST_TRUE(target.mPrices == trades.mPrices, "");
+	}
+	return 0;
+}
+
 class point {
 public:
 	point() = default;
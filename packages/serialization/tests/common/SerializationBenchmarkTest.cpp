@@ -0,0 +1,653 @@
+#include "testing/Test.h"
+#include "logging/Log.h"
+
+#include "serialization/JsonBuilder.h"
+#include "serialization/JsonParser.h"
+#include "serialization/JsonReflection.h"
+#include "serialization/SerializationBase.h"
+#include "serialization/ViewArchive.h"
+#include <jsonxx/jsonxx.h>
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <new>
+#include <string>
+#include <tuple>
+#include <vector>
+
+/*
+Compares the json (JsonBuilder with jsmn or the simd structural parser), jsonxx, zpp, SerializationBase and view archive
+formats on payloads shaped like our real data. Every combination reports encoded size, encode/decode time and heap
+allocations per operation, the results are logged and written to serialization_benchmark.json in the working directory.
+*/
+
+using namespace l::serialization;
+
+namespace {
+	std::atomic<uint64_t> sAllocations = 0;
+}
+
+// Counts heap allocations of the whole test binary, only the benchmark reads the counter. The deletes are kept out of
+// line since gcc flags free() on memory from an inlined replacement operator new as a mismatch.
+void* operator new(std::size_t size) {
+	sAllocations.fetch_add(1, std::memory_order_relaxed);
+	if (auto p = std::malloc(size > 0 ? size : 1)) {
+		return p;
+	}
+	throw std::bad_alloc();
+}
+void* operator new[](std::size_t size) {
+	return operator new(size);
+}
+[[gnu::noinline]] void operator delete(void* p) noexcept {
+	std::free(p);
+}
+[[gnu::noinline]] void operator delete[](void* p) noexcept {
+	std::free(p);
+}
+[[gnu::noinline]] void operator delete(void* p, std::size_t) noexcept {
+	std::free(p);
+}
+[[gnu::noinline]] void operator delete[](void* p, std::size_t) noexcept {
+	std::free(p);
+}
+
+namespace {
+	struct Candle {
+		int64_t mTime = 0;
+		float mOpen = 0.0f;
+		float mHigh = 0.0f;
+		float mLow = 0.0f;
+		float mClose = 0.0f;
+		float mVolume = 0.0f;
+
+		bool operator==(const Candle&) const = default;
+
+		friend zpp::serializer::access;
+		template <typename Archive, typename Self>
+		static void serialize(Archive& archive, Self& self) {
+			archive(self.mTime, self.mOpen, self.mHigh, self.mLow, self.mClose, self.mVolume);
+		}
+
+		static constexpr auto kJsonFields = std::make_tuple(
+			json_field("t", &Candle::mTime),
+			json_field("o", &Candle::mOpen),
+			json_field("h", &Candle::mHigh),
+			json_field("l", &Candle::mLow),
+			json_field("c", &Candle::mClose),
+			json_field("v", &Candle::mVolume));
+	};
+
+	struct Candles {
+		std::string mSymbol;
+		std::string mInterval;
+		std::vector<Candle> mCandles;
+
+		bool operator==(const Candles&) const = default;
+
+		friend zpp::serializer::access;
+		template <typename Archive, typename Self>
+		static void serialize(Archive& archive, Self& self) {
+			archive(self.mSymbol, self.mInterval, self.mCandles);
+		}
+
+		static constexpr auto kJsonFields = std::make_tuple(
+			json_field("symbol", &Candles::mSymbol),
+			json_field("interval", &Candles::mInterval),
+			json_field("candles", &Candles::mCandles));
+	};
+
+	struct Level {
+		double mPrice = 0.0;
+		double mQuantity = 0.0;
+
+		bool operator==(const Level&) const = default;
+
+		friend zpp::serializer::access;
+		template <typename Archive, typename Self>
+		static void serialize(Archive& archive, Self& self) {
+			archive(self.mPrice, self.mQuantity);
+		}
+
+		static constexpr auto kJsonFields = std::make_tuple(
+			json_field("p", &Level::mPrice),
+			json_field("q", &Level::mQuantity));
+	};
+
+	struct OrderBook {
+		std::string mSymbol;
+		int64_t mUpdateId = 0;
+		std::vector<Level> mBids;
+		std::vector<Level> mAsks;
+
+		bool operator==(const OrderBook&) const = default;
+
+		friend zpp::serializer::access;
+		template <typename Archive, typename Self>
+		static void serialize(Archive& archive, Self& self) {
+			archive(self.mSymbol, self.mUpdateId, self.mBids, self.mAsks);
+		}
+
+		static constexpr auto kJsonFields = std::make_tuple(
+			json_field("s", &OrderBook::mSymbol),
+			json_field("u", &OrderBook::mUpdateId),
+			json_field("b", &OrderBook::mBids),
+			json_field("a", &OrderBook::mAsks));
+	};
+
+	struct SchemaNode {
+		int32_t mId = 0;
+		int32_t mTypeId = 0;
+		std::string mName;
+		float mX = 0.0f;
+		float mY = 0.0f;
+		std::vector<float> mInputs;
+
+		bool operator==(const SchemaNode&) const = default;
+
+		friend zpp::serializer::access;
+		template <typename Archive, typename Self>
+		static void serialize(Archive& archive, Self& self) {
+			archive(self.mId, self.mTypeId, self.mName, self.mX, self.mY, self.mInputs);
+		}
+
+		static constexpr auto kJsonFields = std::make_tuple(
+			json_field("id", &SchemaNode::mId),
+			json_field("type", &SchemaNode::mTypeId),
+			json_field("name", &SchemaNode::mName),
+			json_field("x", &SchemaNode::mX),
+			json_field("y", &SchemaNode::mY),
+			json_field("inputs", &SchemaNode::mInputs));
+	};
+
+	struct SchemaLink {
+		int32_t mSourceNode = 0;
+		int32_t mSourceChannel = 0;
+		int32_t mTargetNode = 0;
+		int32_t mTargetChannel = 0;
+
+		bool operator==(const SchemaLink&) const = default;
+
+		friend zpp::serializer::access;
+		template <typename Archive, typename Self>
+		static void serialize(Archive& archive, Self& self) {
+			archive(self.mSourceNode, self.mSourceChannel, self.mTargetNode, self.mTargetChannel);
+		}
+
+		static constexpr auto kJsonFields = std::make_tuple(
+			json_field("sn", &SchemaLink::mSourceNode),
+			json_field("sc", &SchemaLink::mSourceChannel),
+			json_field("tn", &SchemaLink::mTargetNode),
+			json_field("tc", &SchemaLink::mTargetChannel));
+	};
+
+	struct Schema {
+		std::string mName;
+		int32_t mVersion = 0;
+		std::vector<SchemaNode> mNodes;
+		std::vector<SchemaLink> mLinks;
+
+		bool operator==(const Schema&) const = default;
+
+		friend zpp::serializer::access;
+		template <typename Archive, typename Self>
+		static void serialize(Archive& archive, Self& self) {
+			archive(self.mName, self.mVersion, self.mNodes, self.mLinks);
+		}
+
+		static constexpr auto kJsonFields = std::make_tuple(
+			json_field("name", &Schema::mName),
+			json_field("version", &Schema::mVersion),
+			json_field("nodes", &Schema::mNodes),
+			json_field("links", &Schema::mLinks));
+	};
+
+	struct Setting {
+		std::string mKey;
+		std::string mValue;
+		double mNumber = 0.0;
+		int32_t mFlags = 0;
+
+		bool operator==(const Setting&) const = default;
+
+		friend zpp::serializer::access;
+		template <typename Archive, typename Self>
+		static void serialize(Archive& archive, Self& self) {
+			archive(self.mKey, self.mValue, self.mNumber, self.mFlags);
+		}
+
+		static constexpr auto kJsonFields = std::make_tuple(
+			json_field("key", &Setting::mKey),
+			json_field("value", &Setting::mValue),
+			json_field("number", &Setting::mNumber),
+			json_field("flags", &Setting::mFlags));
+	};
+
+	struct ConfigSection {
+		std::string mName;
+		std::vector<Setting> mSettings;
+
+		bool operator==(const ConfigSection&) const = default;
+
+		friend zpp::serializer::access;
+		template <typename Archive, typename Self>
+		static void serialize(Archive& archive, Self& self) {
+			archive(self.mName, self.mSettings);
+		}
+
+		static constexpr auto kJsonFields = std::make_tuple(
+			json_field("name", &ConfigSection::mName),
+			json_field("settings", &ConfigSection::mSettings));
+	};
+
+	struct ConfigGroup {
+		std::string mName;
+		std::vector<ConfigSection> mSections;
+
+		bool operator==(const ConfigGroup&) const = default;
+
+		friend zpp::serializer::access;
+		template <typename Archive, typename Self>
+		static void serialize(Archive& archive, Self& self) {
+			archive(self.mName, self.mSections);
+		}
+
+		static constexpr auto kJsonFields = std::make_tuple(
+			json_field("name", &ConfigGroup::mName),
+			json_field("sections", &ConfigGroup::mSections));
+	};
+
+	struct NestedConfig {
+		std::string mName;
+		int32_t mVersion = 0;
+		std::vector<ConfigGroup> mGroups;
+
+		bool operator==(const NestedConfig&) const = default;
+
+		friend zpp::serializer::access;
+		template <typename Archive, typename Self>
+		static void serialize(Archive& archive, Self& self) {
+			archive(self.mName, self.mVersion, self.mGroups);
+		}
+
+		static constexpr auto kJsonFields = std::make_tuple(
+			json_field("name", &NestedConfig::mName),
+			json_field("version", &NestedConfig::mVersion),
+			json_field("groups", &NestedConfig::mGroups));
+	};
+
+	// Deterministic so sizes are comparable between runs
+	class Random {
+	public:
+		uint32_t Next() {
+			mState = mState * 1664525u + 1013904223u;
+			return mState >> 8;
+		}
+		int32_t Next(int32_t range) {
+			return static_cast<int32_t>(Next() % static_cast<uint32_t>(range));
+		}
+	protected:
+		uint32_t mState = 12345;
+	};
+
+	Candles CreateCandles(size_t count) {
+		Random random;
+		Candles candles{ "BTCUSDT", "1m", {} };
+		int64_t time = 1731096600000;
+		float price = 97431.99f;
+		for (size_t i = 0; i < count; i++) {
+			auto open = price;
+			price = std::round((price + static_cast<float>(random.Next(201) - 100) * 0.01f) * 100.0f) / 100.0f;
+			candles.mCandles.push_back({ time, open, std::max(open, price) + 0.5f, std::min(open, price) - 0.5f, price, static_cast<float>(random.Next(100000)) * 0.001f });
+			time += 60000;
+		}
+		return candles;
+	}
+
+	OrderBook CreateOrderBook(size_t depth) {
+		Random random;
+		OrderBook book{ "BTCUSDT", 5404297001, {}, {} };
+		for (size_t i = 0; i < depth; i++) {
+			book.mBids.push_back({ 97431.99 - static_cast<double>(i) * 0.01, static_cast<double>(random.Next(100000)) * 0.00001 });
+			book.mAsks.push_back({ 97432.00 + static_cast<double>(i) * 0.01, static_cast<double>(random.Next(100000)) * 0.00001 });
+		}
+		return book;
+	}
+
+	Schema CreateSchema(int32_t nodes) {
+		Random random;
+		Schema schema{ "TestNodeGroup", 3, {}, {} };
+		for (int32_t i = 0; i < nodes; i++) {
+			SchemaNode node{ i, random.Next(80), "Node " + std::to_string(i), static_cast<float>(random.Next(2000)), static_cast<float>(random.Next(1000)), {} };
+			for (int32_t j = random.Next(4); j >= 0; j--) {
+				node.mInputs.push_back(static_cast<float>(random.Next(1000)) * 0.25f);
+			}
+			schema.mNodes.push_back(std::move(node));
+			if (i > 0) {
+				schema.mLinks.push_back({ random.Next(i), 0, i, random.Next(3) });
+			}
+		}
+		return schema;
+	}
+
+	NestedConfig CreateConfig(int32_t groups) {
+		Random random;
+		NestedConfig config{ "ltools", 2, {} };
+		for (int32_t i = 0; i < groups; i++) {
+			ConfigGroup group{ "group_" + std::to_string(i), {} };
+			for (int32_t j = 0; j < 8; j++) {
+				ConfigSection section{ "section_" + std::to_string(j), {} };
+				for (int32_t k = 0; k < 6; k++) {
+					section.mSettings.push_back({ "setting_" + std::to_string(k), k % 2 == 0 ? "https://api.example.com/v3/stream" : "enabled", static_cast<double>(random.Next(10000)) * 0.5, random.Next(16) });
+				}
+				group.mSections.push_back(std::move(section));
+			}
+			config.mGroups.push_back(std::move(group));
+		}
+		return config;
+	}
+
+	// Generic json and jsonxx encoders over kJsonFields, decoding json goes through json_decode
+	template<class T>
+	void EncodeJson(JsonBuilder& builder, std::string_view name, const T& value) {
+		if constexpr (std::is_arithmetic_v<T>) {
+			builder.AddNumber(name, value);
+		}
+		else if constexpr (std::is_same_v<T, std::string>) {
+			builder.AddString(name, value);
+		}
+		else if constexpr (reflection::IsVector<T>::value) {
+			builder.Begin(name, true);
+			for (auto& element : value) {
+				EncodeJson(builder, "", element);
+			}
+			builder.End(true);
+		}
+		else {
+			builder.Begin(name);
+			std::apply([&](auto&... fields) {
+				(EncodeJson(builder, fields.mName, value.*(fields.mMember)), ...);
+				}, T::kJsonFields);
+			builder.End();
+		}
+	}
+
+	template<class T>
+	auto EncodeJsonxx(const T& value) {
+		if constexpr (std::is_arithmetic_v<T>) {
+			return jsonxx::Value(static_cast<jsonxx::Number>(value));
+		}
+		else if constexpr (std::is_same_v<T, std::string>) {
+			return jsonxx::Value(value);
+		}
+		else if constexpr (reflection::IsVector<T>::value) {
+			jsonxx::Array array;
+			for (auto& element : value) {
+				array << EncodeJsonxx(element);
+			}
+			return jsonxx::Value(array);
+		}
+		else {
+			jsonxx::Object object;
+			std::apply([&](auto&... fields) {
+				((object << std::string(fields.mName) << EncodeJsonxx(value.*(fields.mMember))), ...);
+				}, T::kJsonFields);
+			return object;
+		}
+	}
+
+	template<class T>
+	bool DecodeJsonxx(jsonxx::Object& object, T& out);
+
+	template<class T>
+	bool DecodeJsonxxElement(jsonxx::Array& array, unsigned index, T& out) {
+		if constexpr (std::is_arithmetic_v<T>) {
+			if (!array.has<jsonxx::Number>(index)) {
+				return false;
+			}
+			out = static_cast<T>(array.get<jsonxx::Number>(index));
+			return true;
+		}
+		else {
+			return array.has<jsonxx::Object>(index) && DecodeJsonxx(array.get<jsonxx::Object>(index), out);
+		}
+	}
+
+	template<class T>
+	bool DecodeJsonxxMember(jsonxx::Object& object, const std::string& key, T& out) {
+		if constexpr (std::is_arithmetic_v<T>) {
+			if (!object.has<jsonxx::Number>(key)) {
+				return false;
+			}
+			out = static_cast<T>(object.get<jsonxx::Number>(key));
+			return true;
+		}
+		else if constexpr (std::is_same_v<T, std::string>) {
+			if (!object.has<jsonxx::String>(key)) {
+				return false;
+			}
+			out = object.get<jsonxx::String>(key);
+			return true;
+		}
+		else if constexpr (reflection::IsVector<T>::value) {
+			if (!object.has<jsonxx::Array>(key)) {
+				return false;
+			}
+			auto& array = object.get<jsonxx::Array>(key);
+			out.resize(array.size());
+			bool result = true;
+			for (size_t i = 0; i < out.size(); i++) {
+				result &= DecodeJsonxxElement(array, static_cast<unsigned>(i), out[i]);
+			}
+			return result;
+		}
+		else {
+			return object.has<jsonxx::Object>(key) && DecodeJsonxx(object.get<jsonxx::Object>(key), out);
+		}
+	}
+
+	template<class T>
+	bool DecodeJsonxx(jsonxx::Object& object, T& out) {
+		return std::apply([&](auto&... fields) {
+			return (DecodeJsonxxMember(object, std::string(fields.mName), out.*(fields.mMember)) && ...);
+			}, T::kJsonFields);
+	}
+
+	template<class T>
+	class BenchmarkArchive : public SerializationBase {
+	public:
+		static const int32_t LatestVersion = 1;
+
+		BenchmarkArchive() : SerializationBase(0, LatestVersion, true, false, true) {}
+		virtual ~BenchmarkArchive() = default;
+
+		virtual void Save(SaveArchive& archive) const {
+			archive(mPayload);
+		}
+		virtual void Load(LoadArchive& archive) {
+			archive(mPayload);
+		}
+
+		T mPayload;
+	};
+
+	struct BenchmarkResult {
+		std::string mPayload;
+		std::string mFormat;
+		int32_t mIterations = 0;
+		size_t mSize = 0;
+		double mEncodeSeconds = 0.0;
+		double mDecodeSeconds = 0.0;
+		double mEncodeAllocations = 0.0;
+		double mDecodeAllocations = 0.0;
+	};
+
+	std::vector<BenchmarkResult>& GetResults() {
+		static std::vector<BenchmarkResult> results;
+		return results;
+	}
+
+	// encode() returns the encoded size, decode() returns true if the payload round tripped
+	template<class Encode, class Decode>
+	bool Measure(std::string_view payload, std::string_view format, int32_t iterations, Encode&& encode, Decode&& decode) {
+		BenchmarkResult result{ std::string(payload), std::string(format), iterations };
+
+		// first round trip warms the buffers up and validates the format
+		result.mSize = encode();
+		if (result.mSize == 0 || !decode()) {
+			LOG(LogError) << payload << "/" << format << " failed to round trip";
+			return false;
+		}
+
+		std::string encodeName = result.mPayload + "::" + result.mFormat + "::Encode";
+		std::string decodeName = result.mPayload + "::" + result.mFormat + "::Decode";
+		{
+			PERF_TIMER(encodeName);
+			auto allocations = sAllocations.load(std::memory_order_relaxed);
+			for (int32_t i = 0; i < iterations; i++) {
+				encode();
+			}
+			result.mEncodeAllocations = static_cast<double>(sAllocations.load(std::memory_order_relaxed) - allocations) / iterations;
+		}
+		{
+			PERF_TIMER(decodeName);
+			auto allocations = sAllocations.load(std::memory_order_relaxed);
+			for (int32_t i = 0; i < iterations; i++) {
+				decode();
+			}
+			result.mDecodeAllocations = static_cast<double>(sAllocations.load(std::memory_order_relaxed) - allocations) / iterations;
+		}
+		result.mEncodeSeconds = PERF_TIMER_RESULT(encodeName).mSeconds / iterations;
+		result.mDecodeSeconds = PERF_TIMER_RESULT(decodeName).mSeconds / iterations;
+
+		auto megabytes = static_cast<double>(result.mSize) / (1024.0 * 1024.0);
+		LOG(LogInfo) << payload << "/" << format << ": " << result.mSize << " bytes, encode " << megabytes / result.mEncodeSeconds << " MB/s (" << result.mEncodeAllocations << " allocs), decode " << megabytes / result.mDecodeSeconds << " MB/s (" << result.mDecodeAllocations << " allocs)";
+		GetResults().push_back(std::move(result));
+		return true;
+	}
+
+	template<class T>
+	bool MeasurePayload(std::string_view name, const T& payload, int32_t iterations) {
+		bool result = true;
+
+		// json written by JsonBuilder into a reused buffer and read back by jsmn and the structural parser
+		std::string json;
+		T jsonDecoded;
+		auto encodeJson = [&]() {
+			json.clear();
+			JsonBuilder builder;
+			builder.SetBuffer(&json);
+			EncodeJson(builder, "", payload);
+			return json.size();
+		};
+		JsonStreamParser<> jsmnParser;
+		result &= Measure(name, "JsonJsmn", iterations, encodeJson, [&]() {
+			auto [ok, count] = jsmnParser.LoadJson(json.data(), json.size());
+			return ok && json_decode(jsmnParser.GetRoot(), jsonDecoded) && jsonDecoded == payload;
+			});
+		JsonSimdParser<> simdParser;
+		result &= Measure(name, "JsonSimd", iterations, encodeJson, [&]() {
+			auto [ok, count] = simdParser.LoadJson(json.data(), json.size());
+			return ok && json_decode(simdParser.GetRoot(), jsonDecoded) && jsonDecoded == payload;
+			});
+
+		// jsonxx builds a document tree both ways
+		std::string jsonxxText;
+		T jsonxxDecoded;
+		result &= Measure(name, "Jsonxx", iterations, [&]() {
+			jsonxxText = EncodeJsonxx(payload).json();
+			return jsonxxText.size();
+			}, [&]() {
+				jsonxx::Object object;
+				return object.parse(jsonxxText) && DecodeJsonxx(object, jsonxxDecoded) && jsonxxDecoded == payload;
+				});
+
+		// zpp binary straight from the payload
+		std::vector<unsigned char> zppData;
+		T zppDecoded;
+		result &= Measure(name, "Zpp", iterations, [&]() {
+			zppData.clear();
+			zpp::serializer::memory_output_archive out(zppData);
+			out(payload);
+			return zppData.size();
+			}, [&]() {
+				zpp::serializer::memory_view_input_archive in(zppData.data(), zppData.size());
+				in(zppDecoded);
+				return zppDecoded == payload;
+				});
+
+		// zpp behind the versioned SerializationBase header
+		std::vector<unsigned char> archiveData;
+		BenchmarkArchive<T> source;
+		BenchmarkArchive<T> target;
+		source.mPayload = payload;
+		result &= Measure(name, "SerializationBase", iterations, [&]() {
+			archiveData.clear();
+			source.GetArchiveData(archiveData);
+			return archiveData.size();
+			}, [&]() {
+				return target.LoadArchiveData(std::span<const unsigned char>(archiveData)) && target.mPayload == payload;
+				});
+
+		// same wire layout as zpp through the span/view archives
+		std::vector<unsigned char> viewData(zppData.size());
+		T viewDecoded;
+		result &= Measure(name, "ViewArchive", iterations, [&]() {
+			SpanOutputArchive out(viewData);
+			return out(payload) ? out.GetSize() : 0;
+			}, [&]() {
+				ViewInputArchive in(viewData);
+				return in(viewDecoded) && viewDecoded == payload;
+				});
+
+		return result;
+	}
+
+	bool WriteResults(std::string_view path) {
+		JsonBuilder builder(true);
+		builder.Begin("");
+		builder.Begin("results", true);
+		for (auto& result : GetResults()) {
+			auto megabytes = static_cast<double>(result.mSize) / (1024.0 * 1024.0);
+			builder.Begin("");
+			builder.AddString("payload", result.mPayload);
+			builder.AddString("format", result.mFormat);
+			builder.AddNumber("iterations", result.mIterations);
+			builder.AddNumber("size", result.mSize);
+			builder.AddNumber("encode_seconds", result.mEncodeSeconds);
+			builder.AddNumber("decode_seconds", result.mDecodeSeconds);
+			builder.AddNumber("encode_mb_per_second", megabytes / result.mEncodeSeconds);
+			builder.AddNumber("decode_mb_per_second", megabytes / result.mDecodeSeconds);
+			builder.AddNumber("encode_allocations", result.mEncodeAllocations);
+			builder.AddNumber("decode_allocations", result.mDecodeAllocations);
+			builder.End();
+		}
+		builder.End(true);
+		builder.End();
+
+		std::ofstream file(std::string(path), std::ios::binary | std::ios::trunc);
+		if (!file) {
+			LOG(LogWarning) << "Failed to open " << path;
+			return false;
+		}
+		auto json = builder.GetView();
+		file.write(json.data(), static_cast<std::streamsize>(json.size()));
+		return file.good();
+	}
+}
+
+PERF_TEST(SerializationBenchmark, Formats) {
+	GetResults().clear();
+
+	TEST_TRUE(MeasurePayload("Candles", CreateCandles(5000), 20), "");
+	TEST_TRUE(MeasurePayload("OrderBook", CreateOrderBook(1000), 20), "");
+	TEST_TRUE(MeasurePayload("Schema", CreateSchema(500), 20), "");
+	TEST_TRUE(MeasurePayload("NestedConfig", CreateConfig(16), 20), "");
+	TEST_EQ(GetResults().size(), 24u, "");
+
+	TEST_TRUE(WriteResults("serialization_benchmark.json"), "");
+	return 0;
+}
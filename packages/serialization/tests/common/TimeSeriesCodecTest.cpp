@@ -0,0 +1,194 @@
+#include "testing/Test.h"
+#include "logging/Log.h"
+
+#include "serialization/TimeSeriesCodec.h"
+
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+using namespace l::serialization;
+
+namespace {
+	// One minute candles as open, close, high, low, volume with a random walk price and a few gaps
+	void CreateCandles(size_t count, std::vector<int64_t>& timestamps, std::vector<float>& values) {
+		timestamps.clear();
+		values.clear();
+		int64_t time = 1731096600000;
+		float price = 97431.99f;
+		for (size_t i = 0; i < count; i++) {
+			time += i % 500 == 499 ? 7 * 60000 : 60000;
+			auto open = price;
+			price = std::round((price + static_cast<float>(std::rand() % 201 - 100) * 0.01f) * 100.0f) / 100.0f;
+			timestamps.push_back(time);
+			values.insert(values.end(), { open, price, std::max(open, price) + 0.5f, std::min(open, price) - 0.5f, static_cast<float>(std::rand() % 1000) * 0.001f });
+		}
+	}
+
+	bool SameBits(const std::vector<float>& a, const std::vector<float>& b) {
+		return a.size() == b.size() && memcmp(a.data(), b.data(), a.size() * sizeof(float)) == 0;
+	}
+}
+
+TEST(TimeSeriesCodec, VarintZigzag) {
+	static_assert(zigzag_encode(0) == 0 && zigzag_encode(-1) == 1 && zigzag_encode(1) == 2 && zigzag_encode(-2) == 3);
+	static_assert(zigzag_decode(zigzag_encode(std::numeric_limits<int64_t>::min())) == std::numeric_limits<int64_t>::min());
+
+	std::vector<unsigned char> data;
+	std::vector<uint64_t> values = { 0, 1, 127, 128, 16383, 16384, 1731096600000, std::numeric_limits<uint64_t>::max() };
+	size_t expected = 0;
+	for (auto value : values) {
+		expected += varint_encode(value, data);
+	}
+	TEST_EQ(data.size(), expected, "");
+	TEST_EQ(data.size(), 1u + 1u + 1u + 2u + 2u + 3u + 6u + 10u, "");
+
+	size_t offset = 0;
+	for (auto value : values) {
+		uint64_t decoded = 0;
+		TEST_TRUE(varint_decode(data, offset, decoded), "");
+		TEST_EQ(decoded, value, "");
+	}
+	uint64_t decoded = 0;
+	TEST_FALSE(varint_decode(data, offset, decoded), "");
+	std::vector<unsigned char> truncated = { 0x80, 0x80 };
+	offset = 0;
+	TEST_FALSE(varint_decode(truncated, offset, decoded), "");
+	return 0;
+}
+
+TEST(TimeSeriesCodec, RoundTrip) {
+	std::vector<int64_t> timestamps;
+	std::vector<float> values;
+	CreateCandles(10000, timestamps, values);
+
+	TimeSeriesWriter writer(5, true, 1024);
+	writer.Append(timestamps, values);
+	std::vector<unsigned char> data;
+	writer.Finish(data);
+
+	auto raw = timestamps.size() * sizeof(int64_t) + values.size() * sizeof(float);
+	LOG(LogInfo) << "Compressed " << raw << " to " << data.size() << " bytes";
+	TEST_TRUE(data.size() * 2 < raw, "");
+
+	TimeSeriesReader reader;
+	TEST_TRUE(reader.Load(data), "");
+	TEST_EQ(reader.GetRowCount(), 10000u, "");
+	TEST_EQ(reader.GetColumnCount(), 5, "");
+	TEST_EQ(reader.GetBlockCount(), 10, "");
+
+	std::vector<int64_t> decodedTimestamps(timestamps.size());
+	std::vector<float> decodedValues(values.size());
+	TEST_TRUE(reader.Read(0, reader.GetRowCount(), decodedTimestamps.data(), decodedValues.data()), "");
+	TEST_TRUE(decodedTimestamps == timestamps, "");
+	TEST_TRUE(SameBits(decodedValues, values), "");
+
+	// random access across block boundaries decodes only the blocks involved
+	for (uint64_t first : { 0u, 1000u, 1023u, 1024u, 5000u, 9990u }) {
+		uint64_t count = std::min<uint64_t>(1500, 10000 - first);
+		std::vector<int64_t> t(count);
+		std::vector<float> v(count * 5);
+		TEST_TRUE(reader.Read(first, count, t.data(), v.data()), "");
+		TEST_EQ(t.front(), timestamps[first], "");
+		TEST_EQ(t.back(), timestamps[first + count - 1], "");
+		TEST_TRUE(memcmp(v.data(), values.data() + first * 5, v.size() * sizeof(float)) == 0, "");
+	}
+	TEST_FALSE(reader.Read(9999, 2, nullptr, decodedValues.data()), "");
+
+	// the writer can be reused after Finish
+	writer.Append(timestamps[0], std::span<const float>(values.data(), 5));
+	std::vector<unsigned char> single;
+	writer.Finish(single);
+	TEST_TRUE(reader.Load(single), "");
+	TEST_EQ(reader.GetRowCount(), 1u, "");
+	return 0;
+}
+
+TEST(TimeSeriesCodec, EdgeValues) {
+	std::vector<float> values = { 0.0f, -0.0f, 1.0f, std::numeric_limits<float>::infinity(), -std::numeric_limits<float>::infinity(),
+		std::numeric_limits<float>::quiet_NaN(), std::numeric_limits<float>::denorm_min(), std::numeric_limits<float>::max(),
+		std::numeric_limits<float>::lowest(), 1.0f, 1.0f, 1.0f, 3.3f };
+	std::vector<int64_t> timestamps = { 0, std::numeric_limits<int64_t>::max(), std::numeric_limits<int64_t>::min(), -1, 1, 1, 1,
+		2, 1000000, 1000001, 1000002, 1000003, 5 };
+
+	TimeSeriesWriter writer(1, true, 4);
+	writer.Append(timestamps, values);
+	std::vector<unsigned char> data;
+	writer.Finish(data);
+
+	TimeSeriesReader reader;
+	TEST_TRUE(reader.Load(data), "");
+	std::vector<int64_t> decodedTimestamps(timestamps.size());
+	std::vector<float> decodedValues(values.size());
+	TEST_TRUE(reader.Read(0, timestamps.size(), decodedTimestamps.data(), decodedValues.data()), "");
+	TEST_TRUE(decodedTimestamps == timestamps, "");
+	TEST_TRUE(SameBits(decodedValues, values), "");
+
+	// a corrupt row count is rejected before anything is decoded into the output, the index follows the 28 byte header
+	uint64_t lastBlock = 0;
+	memcpy(&lastBlock, data.data() + 28 + 3 * sizeof(uint64_t), sizeof(lastBlock));
+	TEST_EQ(data[static_cast<size_t>(lastBlock)], 1, "The last block holds a single row");
+	auto corrupt = data;
+	corrupt[static_cast<size_t>(lastBlock)] = 4;
+	TEST_TRUE(reader.Load(corrupt), "");
+	TEST_EQ(reader.DecodeBlock(3, decodedTimestamps.data() + 12, decodedValues.data() + 12), -1, "");
+	TEST_FALSE(reader.Read(0, timestamps.size(), decodedTimestamps.data(), decodedValues.data()), "");
+
+	// values only
+	TimeSeriesWriter valueWriter(1, false);
+	for (auto& value : values) {
+		valueWriter.Append(std::span<const float>(&value, 1));
+	}
+	data.clear();
+	valueWriter.Finish(data);
+	TEST_TRUE(reader.Load(data), "");
+	TEST_FALSE(reader.HasTimestamps(), "");
+	std::fill(decodedValues.begin(), decodedValues.end(), 0.0f);
+	TEST_EQ(reader.DecodeBlock(0, nullptr, decodedValues.data()), static_cast<int32_t>(values.size()), "");
+	TEST_TRUE(SameBits(decodedValues, values), "");
+
+	// truncated data is rejected rather than read past
+	TEST_FALSE(reader.Load(std::span<const unsigned char>(data).first(10)), "");
+	TEST_TRUE(reader.Load(std::span<const unsigned char>(data).first(data.size() - 3)), "");
+	TEST_EQ(reader.DecodeBlock(0, nullptr, decodedValues.data()), -1, "");
+	return 0;
+}
+
+PERF_TEST(TimeSeriesCodec, CodecTimings) {
+	std::vector<int64_t> timestamps;
+	std::vector<float> values;
+	CreateCandles(100000, timestamps, values);
+
+	std::vector<unsigned char> data;
+	{
+		PERF_TIMER("TimeSeriesCodec::Encode100k");
+		for (int i = 0; i < 10; i++) {
+			data.clear();
+			TimeSeriesWriter writer(5);
+			writer.Append(timestamps, values);
+			writer.Finish(data);
+		}
+	}
+	std::vector<int64_t> decodedTimestamps(timestamps.size());
+	std::vector<float> decodedValues(values.size());
+	{
+		PERF_TIMER("TimeSeriesCodec::Decode100k");
+		for (int i = 0; i < 10; i++) {
+			TimeSeriesReader reader;
+			reader.Load(data);
+			reader.Read(0, reader.GetRowCount(), decodedTimestamps.data(), decodedValues.data());
+		}
+	}
+	{
+		PERF_TIMER("TimeSeriesCodec::RandomRows");
+		TimeSeriesReader reader;
+		reader.Load(data);
+		for (int i = 0; i < 1000; i++) {
+			auto first = static_cast<uint64_t>(std::rand() % 99000);
+			reader.Read(first, 100, decodedTimestamps.data(), decodedValues.data());
+		}
+	}
+	TEST_TRUE(decodedTimestamps.size() == timestamps.size(), "");
+	return 0;
+}
@@ -0,0 +1,125 @@
+#include "testing/Test.h"
+#include "logging/Log.h"
+
+#include "serialization/TrivialData.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace l::serialization;
+
+TEST(TrivialData, ViewParity) {
+	std::string text = "telegram_token=abc:123\ntelegram_chat_id=-42\n\nlonely\nquoted=\"a=b c\"\nlast=1";
+
+	std::stringstream stream(text);
+	auto copies = ParseTrivialData(stream, "=\n");
+	auto views = ParseTrivialData(std::string_view(text), "=\n");
+	TEST_EQ(copies.size(), views.size(), "");
+	for (size_t i = 0; i < copies.size(); i++) {
+		TEST_TRUE(copies[i] == views[i], "");
+		if (!views[i].empty()) {
+			TEST_TRUE(views[i].data() >= text.data() && views[i].data() < text.data() + text.size(), "Fields should point into the buffer");
+		}
+	}
+	TEST_EQ(views.size(), 10u, "");
+	TEST_TRUE(views[7] == "a=b c", "");
+
+	auto map = ParseTrivialDataMap(std::string_view(text), "=\n");
+	TEST_TRUE(map[l::string::string_id("telegram_chat_id")] == "-42", "");
+	TEST_TRUE(map[l::string::string_id("lonely")].empty(), "");
+	TEST_TRUE(map[l::string::string_id("last")] == "1", "");
+
+	std::stringstream empty;
+	TEST_TRUE(ParseTrivialData(empty, "=\n").empty(), "");
+	TEST_TRUE(ParseTrivialData(std::string_view(), "=\n").empty(), "");
+	return 0;
+}
+
+TEST(TrivialData, RowsAndValues) {
+	std::string_view text = "1731096600000, 97431.99, 97433.5, 10\n1731096660000, 97433.5, x, 11\n\n1731096720000,97430.25,97429,12\n";
+
+	std::vector<size_t> rowIndices;
+	std::vector<size_t> counts;
+	auto rows = ParseTrivialDataRows(text, ", ", [&](size_t row, std::span<const std::string_view> fields) {
+		rowIndices.push_back(row);
+		counts.push_back(fields.size());
+		return true;
+		});
+	TEST_EQ(rows, 4u, "");
+	TEST_TRUE(rowIndices == std::vector<size_t>({ 0, 1, 2, 3 }), "");
+	TEST_TRUE(counts == std::vector<size_t>({ 4, 4, 0, 4 }), "");
+
+	rows = ParseTrivialDataRows(text, ", ", [](size_t row, std::span<const std::string_view>) {
+		return row < 1;
+		});
+	TEST_EQ(rows, 2u, "The callback should be able to stop the parse");
+
+	TrivialDataReader reader(text, ", ");
+	TEST_TRUE(reader.Next(), "");
+	int64_t time = 0;
+	float price = 0.0f;
+	TEST_TRUE(reader.GetValue(0, time), "");
+	TEST_TRUE(reader.GetValue(1, price), "");
+	TEST_EQ(time, 1731096600000, "");
+	TEST_FUZZY(price, 97431.99f, 0.01f, "");
+	TEST_FALSE(reader.GetValue(4, price), "");
+	TEST_TRUE(reader.Next(), "");
+	float row[4];
+	TEST_EQ(reader.GetValues(std::span<float>(row)), 3u, "Non numeric fields are skipped");
+	TEST_FUZZY(row[2], 11.0f, 0.0001f, "");
+
+	std::vector<double> values;
+	TEST_EQ(ParseTrivialDataValues(text, ", ", values), 11u, "");
+	TEST_FUZZY(values.back(), 12.0, 0.0001, "");
+	return 0;
+}
+
+PERF_TEST(TrivialData, ParseTimings) {
+	std::string text;
+	for (int i = 0; i < 100000; i++) {
+		text += "key_" + std::to_string(i) + "=" + std::to_string(i * 0.25) + "\n";
+	}
+
+	size_t count = 0;
+	{
+		PERF_TIMER("TrivialData::Stringstream100k");
+		for (int i = 0; i < 10; i++) {
+			std::stringstream stream(text);
+			count += ParseTrivialData(stream, "=\n").size();
+		}
+	}
+	{
+		PERF_TIMER("TrivialData::View100k");
+		for (int i = 0; i < 10; i++) {
+			count += ParseTrivialData(std::string_view(text), "=\n").size();
+		}
+	}
+	{
+		PERF_TIMER("TrivialData::Rows100k");
+		for (int i = 0; i < 10; i++) {
+			ParseTrivialDataRows(text, "=\n", [&](size_t, std::span<const std::string_view> fields) {
+				count += fields.size();
+				return true;
+				});
+		}
+	}
+	{
+		PERF_TIMER("TrivialData::Values100k");
+		std::vector<double> values;
+		values.reserve(100000);
+		for (int i = 0; i < 10; i++) {
+			values.clear();
+			TrivialDataReader reader(text, "=\n");
+			while (reader.Next()) {
+				double value;
+				if (reader.GetValue(1, value)) {
+					values.push_back(value);
+				}
+			}
+		}
+		count += values.size();
+	}
+	TEST_EQ(count, 6100000u, "");
+	return 0;
+}
@@ -0,0 +1,171 @@
+#include "testing/Test.h"
+#include "logging/Log.h"
+
+#include "serialization/ViewArchive.h"
+
+#include <array>
+#include <cstring>
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace l::serialization;
+
+namespace {
+	struct Candle {
+		int64_t mTime = 0;
+		float mOpen = 0.0f;
+		float mClose = 0.0f;
+	};
+
+	struct Series {
+		std::string mSymbol;
+		int32_t mInterval = 0;
+		std::vector<Candle> mCandles;
+		std::vector<std::string> mTags;
+
+		template <typename Archive, typename Self>
+		static void serialize(Archive& archive, Self& self) {
+			archive(self.mSymbol, self.mInterval, self.mCandles, self.mTags);
+		}
+	};
+
+	struct SeriesView {
+		std::string_view mSymbol;
+		int32_t mInterval = 0;
+		std::span<const Candle> mCandles;
+		std::vector<std::string_view> mTags;
+
+		template <typename Archive, typename Self>
+		static void serialize(Archive& archive, Self& self) {
+			archive(self.mSymbol, self.mInterval, self.mCandles, self.mTags);
+		}
+	};
+
+	Series CreateSeries(int32_t count) {
+		Series series{ "BTCUSDT_PERP", 60, {}, { "spot", "binance" } };
+		for (int32_t i = 0; i < count; i++) {
+			series.mCandles.push_back({ 1731096600000 + i * 60000, 97431.0f + i, 97432.0f + i });
+		}
+		return series;
+	}
+}
+
+TEST(ViewArchive, RoundTrip) {
+	auto series = CreateSeries(100);
+
+	std::vector<unsigned char> buffer(4096);
+	SpanOutputArchive out(buffer);
+	TEST_TRUE(out(series), "");
+	// symbol, interval, candles and tags with their 32 bit counts
+	size_t expected = 4 + 12 + 4 + 4 + 100 * sizeof(Candle) + 4 + 4 + 4 + 4 + 7;
+	TEST_EQ(out.GetSize(), expected, "");
+
+	Series copy;
+	ViewInputArchive in(out.GetData());
+	TEST_TRUE(in(copy), "");
+	TEST_EQ(in.GetOffset(), expected, "");
+	TEST_TRUE(copy.mSymbol == series.mSymbol, "");
+	TEST_EQ(copy.mCandles.size(), 100u, "");
+	TEST_EQ(copy.mCandles[99].mTime, series.mCandles[99].mTime, "");
+	TEST_TRUE(copy.mTags == series.mTags, "");
+
+	// the same bytes mapped without materializing anything, the candles are 8 byte aligned in the buffer
+	SeriesView view;
+	ViewInputArchive viewIn(out.GetData());
+	TEST_TRUE(viewIn(view), "");
+	TEST_TRUE(view.mSymbol == "BTCUSDT_PERP", "");
+	TEST_EQ(view.mInterval, 60, "");
+	TEST_EQ(view.mCandles.size(), 100u, "");
+	TEST_TRUE(view.mSymbol.data() == reinterpret_cast<const char*>(buffer.data()) + 4, "");
+	TEST_TRUE(reinterpret_cast<const unsigned char*>(view.mCandles.data()) == buffer.data() + 24, "");
+	TEST_FUZZY(view.mCandles[42].mClose, 97474.0f, 0.0001f, "");
+	TEST_TRUE(view.mTags[1] == "binance", "");
+
+	// and written back from the view
+	std::vector<unsigned char> buffer2(4096);
+	SpanOutputArchive out2(buffer2);
+	TEST_TRUE(out2(view), "");
+	TEST_TRUE(std::equal(out.GetData().begin(), out.GetData().end(), out2.GetData().begin()), "");
+	return 0;
+}
+
+TEST(ViewArchive, Alignment) {
+	std::array<double, 4> values = { 1.5, 2.5, 3.5, 4.5 };
+	alignas(8) std::array<unsigned char, 64> buffer;
+	SpanOutputArchive out(std::span<unsigned char>(buffer).subspan(1));
+	out(std::span<const double>(values));
+
+	// the elements start at offset 5, a misaligned span gets an aligned copy kept by the archive
+	std::span<const double> mapped;
+	ViewInputArchive in(out.GetData());
+	TEST_TRUE(in(mapped), "");
+	TEST_EQ(mapped.size(), 4u, "");
+	TEST_TRUE(reinterpret_cast<uintptr_t>(mapped.data()) % alignof(double) == 0, "");
+	TEST_EQ(mapped[3], 4.5, "");
+	return 0;
+}
+
+TEST(ViewArchive, Bounds) {
+	auto series = CreateSeries(10);
+
+	// writing past the span is flagged, nothing beyond it is touched
+	std::vector<unsigned char> buffer(64, 0xcd);
+	SpanOutputArchive out(std::span<unsigned char>(buffer).first(32));
+	TEST_FALSE(out(series), "");
+	TEST_TRUE(out.HasOverflow(), "");
+	TEST_TRUE(out.GetSize() <= 32u, "");
+	TEST_EQ(buffer[32], 0xcd, "");
+
+	std::vector<unsigned char> full(1024);
+	SpanOutputArchive fullOut(full);
+	fullOut(series);
+
+	// truncated input and corrupt counts are errors
+	for (size_t size : { size_t(0), size_t(3), size_t(20), fullOut.GetSize() - 1 }) {
+		Series copy;
+		ViewInputArchive in(fullOut.GetData().first(size));
+		TEST_FALSE(in(copy), "");
+		TEST_TRUE(in.HasError(), "");
+	}
+	memset(full.data() + 20, 0xff, 4); // candle count
+	Series corrupt;
+	ViewInputArchive in(fullOut.GetData());
+	TEST_FALSE(in(corrupt), "");
+	return 0;
+}
+
+PERF_TEST(ViewArchive, ArchiveTimings) {
+	auto series = CreateSeries(10000);
+	std::vector<unsigned char> buffer(1 << 20);
+	size_t size = 0;
+	{
+		PERF_TIMER("ViewArchive::Save");
+		for (int i = 0; i < 1000; i++) {
+			SpanOutputArchive out(buffer);
+			out(series);
+			size = out.GetSize();
+		}
+	}
+	size_t count = 0;
+	{
+		PERF_TIMER("ViewArchive::LoadCopy");
+		for (int i = 0; i < 1000; i++) {
+			Series copy;
+			ViewInputArchive in(std::span<const unsigned char>(buffer).first(size));
+			in(copy);
+			count += copy.mCandles.size();
+		}
+	}
+	{
+		PERF_TIMER("ViewArchive::LoadMapped");
+		for (int i = 0; i < 1000; i++) {
+			SeriesView view;
+			ViewInputArchive in(std::span<const unsigned char>(buffer).first(size));
+			in(view);
+			count -= view.mCandles.size();
+		}
+	}
+	TEST_EQ(count, 0u, "");
+	return 0;
+}
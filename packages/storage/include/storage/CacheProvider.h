@@ -2,9 +2,17 @@
 
 #include <vector>
 #include <string_view>
+#include <span>
+#include <memory>
 
 namespace l::filecache {
 
+	// Read only view of stored block data, the holder keeps whatever backs the view alive
+	struct CacheDataView {
+		std::span<const unsigned char> mData;
+		std::shared_ptr<void> mHolder;
+	};
+
 	class ICacheProvider {
 	public:
 		ICacheProvider() = default;
@@ -15,5 +23,12 @@ namespace l::filecache {
 		virtual bool ProvideData(std::string_view, std::vector<unsigned char>&) {
 			return false;
 		};
+		virtual bool RemoveData(std::string_view) {
+			return false;
+		};
+		// Providers that can hand out their data without copying it override this, blocks then load from the view
+		virtual bool ProvideView(std::string_view, CacheDataView&) {
+			return false;
+		};
 	};
-}
\ No newline at end of file
+}
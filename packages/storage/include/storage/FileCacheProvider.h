@@ -7,6 +7,8 @@
 #include <mutex>
 #include <functional>
 #include <filesystem>
+#include <fstream>
+#include <unordered_set>
 
 #include <storage/CacheProvider.h>
 
@@ -24,17 +26,50 @@ namespace l::filecache {
 
 		virtual bool PersistData(std::string_view path, const std::vector<unsigned char>& data) override;
 		virtual bool ProvideData(std::string_view path, std::vector<unsigned char>& data) override;
+		virtual bool RemoveData(std::string_view path) override;
 
+		// Full recursive scan of a location, parses every file name
 		void ScanLocation(
 			std::string_view location, 
 			std::string_view extension, 
 			std::string_view cacheKey,
 			std::function<void(int32_t position, int32_t blockwidth)> handler);
+
+		// Lists the blocks of cacheKey at the provider location from a manifest that persist and remove keep up to
+		// date. The manifest is trusted as long as it was written after the last change to the directory, otherwise
+		// a full scan rebuilds it. Changes other processes make in subdirectories are not detected.
+		void ScanLocation(
+			std::string_view cacheKey,
+			std::function<void(int32_t position, int32_t blockwidth)> handler);
+
 	protected:
+		std::filesystem::path GetManifestPath() const;
+
+		// Called with the manifest mutex held
+		void LoadManifest();
+		void RebuildManifest();
+		void WriteManifest();
+		void AppendManifest(char op, std::string_view path);
+		void TouchManifest();
+
+		// Keeps the manifest in step with block files created, replaced or removed. A new block is journaled before
+		// its file is created, so a valid manifest lists every block file even when persists run concurrently. At
+		// worst it lists a block whose file was never written. Returns true if the block was new.
+		bool OnBlockPersisting(std::string_view path);
+		// Marks the manifest current again after a persist changed the directory
+		void OnBlockPersisted(bool directoryChanged);
+		void OnBlockRemoved(std::string_view path);
+
 		std::filesystem::path mLocation;
 		std::string mExtension;
 
 		std::mutex mFileMutex;
+
+		std::mutex mManifestMutex;
+		bool mManifestLoaded = false;
+		std::unordered_set<std::string> mBlocks;
+		std::ofstream mManifestJournal;
+		size_t mManifestLines = 0;
 	};
 
 }
\ No newline at end of file
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <span>
+#include <memory>
+#include <filesystem>
+
+#include <storage/FileCacheProvider.h>
+
+namespace l::filecache {
+
+	enum class MappedFileAccess {
+		Normal,
+		Sequential,
+		Random
+	};
+
+	// Read only memory mapping of a whole file, the view is valid until the mapping is closed
+	class MappedFile {
+	public:
+		MappedFile() = default;
+		~MappedFile() {
+			Close();
+		}
+		MappedFile(const MappedFile&) = delete;
+		MappedFile& operator=(const MappedFile&) = delete;
+
+		// The access pattern is passed on to the OS as a read ahead hint
+		bool Open(const std::filesystem::path& file, MappedFileAccess access = MappedFileAccess::Normal);
+		void Close();
+
+		bool IsOpen() const {
+			return mData != nullptr;
+		}
+		std::span<const unsigned char> GetData() const {
+			return std::span<const unsigned char>(mData, mSize);
+		}
+
+	protected:
+		const unsigned char* mData = nullptr;
+		size_t mSize = 0;
+	};
+
+	// File provider that loads blocks straight from mapped files instead of reading them into a vector. Blocks
+	// deserialize from the page cache, for trivially copyable data that is a single copy. Persisting writes a
+	// temporary file and renames it over the old one so mappings that are still open keep the previous contents.
+	class MappedFileCacheProvider : public FileCacheProvider {
+	public:
+		MappedFileCacheProvider() = default;
+		MappedFileCacheProvider(std::string_view location, std::string_view extension, MappedFileAccess access = MappedFileAccess::Sequential) :
+			FileCacheProvider(location, extension),
+			mAccess(access) {}
+		~MappedFileCacheProvider() = default;
+
+		virtual bool PersistData(std::string_view path, const std::vector<unsigned char>& data) override;
+		virtual bool ProvideData(std::string_view path, std::vector<unsigned char>& data) override;
+		virtual bool ProvideView(std::string_view path, CacheDataView& view) override;
+
+		// Maps a block file for direct reads, nullptr if it doesn't exist or is empty
+		std::shared_ptr<MappedFile> Map(std::string_view path);
+
+		void SetAccess(MappedFileAccess access) {
+			mAccess = access;
+		}
+
+	protected:
+		MappedFileAccess mAccess = MappedFileAccess::Sequential;
+	};
+
+}
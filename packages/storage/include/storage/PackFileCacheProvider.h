@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <string>
+#include <string_view>
+#include <map>
+#include <unordered_map>
+#include <mutex>
+#include <condition_variable>
+#include <memory>
+#include <filesystem>
+
+#include "concurrency/ExecutorService.h"
+
+#include <storage/CacheProvider.h>
+
+namespace l::filecache {
+
+	// Read only segment handle for positioned reads. There is no shared read position, so any number of threads can
+	// read through one handle without a lock.
+	class PackSegmentReader {
+	public:
+		PackSegmentReader() = default;
+		~PackSegmentReader() {
+			Close();
+		}
+		PackSegmentReader(const PackSegmentReader&) = delete;
+		PackSegmentReader& operator=(const PackSegmentReader&) = delete;
+
+		bool Open(const std::filesystem::path& file);
+		void Close();
+		bool Read(uint64_t offset, unsigned char* dst, size_t size) const;
+
+	protected:
+#ifdef BSYSTEM_PLATFORM_Windows
+		void* mHandle = nullptr;
+#else
+		int mFd = -1;
+#endif
+	};
+
+	// Segment handle for positioned writes, every call reports whether all of the bytes reached the file
+	class PackSegmentWriter {
+	public:
+		PackSegmentWriter() = default;
+		~PackSegmentWriter() {
+			Close();
+		}
+		PackSegmentWriter(const PackSegmentWriter&) = delete;
+		PackSegmentWriter& operator=(const PackSegmentWriter&) = delete;
+
+		// Creates the file if it doesn't exist
+		bool Open(const std::filesystem::path& file);
+		void Close();
+		bool Write(uint64_t offset, const void* src, size_t size);
+		bool Truncate(uint64_t size);
+		// Waits until the written data is on the disk
+		bool Sync();
+		uint64_t Size() const;
+
+	protected:
+#ifdef BSYSTEM_PLATFORM_Windows
+		void* mHandle = nullptr;
+#else
+		int mFd = -1;
+#endif
+	};
+
+	// Stores blocks as records appended to a few large segment files instead of one file per block. The index maps
+	// a block name, which is the cache key, block width and position, to its record and is rebuilt from the record
+	// headers on start. Rewriting or removing a block leaves a dead record behind, Compact moves the live records of
+	// mostly dead segments into the active one and deletes the old files.
+	class PackFileCacheProvider : public ICacheProvider {
+	public:
+		PackFileCacheProvider(std::string_view location, std::string_view extension = ".pack", uint64_t maxSegmentSize = 256 * 1024 * 1024);
+		~PackFileCacheProvider();
+
+		virtual bool PersistData(std::string_view path, const std::vector<unsigned char>& data) override;
+		virtual bool ProvideData(std::string_view path, std::vector<unsigned char>& data) override;
+		virtual bool RemoveData(std::string_view path) override;
+
+		bool HasData(std::string_view path);
+
+		size_t GetBlockCount();
+		size_t GetSegmentCount();
+		uint64_t GetTotalBytes();
+		uint64_t GetDeadBytes();
+
+		// Rewrites sealed segments where at least deadRatio of the bytes are dead. Returns the number of segments
+		// removed.
+		size_t Compact(float deadRatio = 0.5f);
+
+		// Queues Compact on the executor whenever a sealed segment passes deadRatio, nullptr turns it off. The
+		// executor has to outlive the provider or be shut down first.
+		void SetBackgroundCompaction(l::concurrency::ExecutorService* executor, float deadRatio = 0.5f);
+
+	protected:
+		struct Entry {
+			uint32_t mSegment = 0;
+			uint64_t mOffset = 0; // of the data
+			uint64_t mSize = 0;
+			uint64_t mRecordSize = 0;
+		};
+
+		struct Segment {
+			PackSegmentWriter mWriter;
+			std::shared_ptr<PackSegmentReader> mReader; // held by reads in flight, so compaction can drop the segment
+			uint64_t mSize = 0;
+			uint64_t mLiveBytes = 0;
+		};
+
+		// Shared with queued compactions so they can tell that the provider is gone
+		struct CompactionState {
+			std::mutex mMutex;
+			std::condition_variable mCondition;
+			bool mAlive = true;
+			bool mQueued = false;
+			int32_t mRunning = 0;
+		};
+
+		std::filesystem::path GetSegmentPath(uint32_t id);
+		Segment* OpenSegment(uint32_t id);
+		void ScanSegment(uint32_t id);
+
+		// Called with the mutex held. Nothing changes unless the whole record was written.
+		bool AppendRecord(std::string_view path, const unsigned char* data, uint64_t size);
+		void ApplyRecord(uint32_t segmentId, uint64_t offset, const std::string& path, uint64_t size);
+		std::shared_ptr<PackSegmentReader> GetReader(uint32_t id);
+		bool NeedsCompaction(float deadRatio);
+		bool CompactSegment(uint32_t id);
+
+		void QueueCompaction();
+
+		std::filesystem::path mLocation;
+		std::string mExtension;
+		uint64_t mMaxSegmentSize;
+
+		std::mutex mMutex;
+		std::map<uint32_t, Segment> mSegments;
+		uint32_t mActiveSegment = 0;
+		std::unordered_map<std::string, Entry> mIndex;
+		std::unordered_map<std::string, uint32_t> mTombstones; // removed blocks and the segment of the removal
+
+		l::concurrency::ExecutorService* mCompactionExecutor = nullptr;
+		float mCompactionRatio = 0.5f;
+		std::shared_ptr<CompactionState> mCompactionState = std::make_shared<CompactionState>();
+	};
+
+}
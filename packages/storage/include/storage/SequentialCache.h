@@ -1,19 +1,30 @@
 #pragma once
 
 #include <cstdint>
+#include <atomic>
+#include <concepts>
 #include <vector>
 #include <string>
 #include <string_view>
 #include <sstream>
 #include <map>
+#include <unordered_map>
+#include <unordered_set>
+#include <array>
 #include <mutex>
+#include <shared_mutex>
+#include <condition_variable>
 #include <memory>
 #include <optional>
+#include <span>
+#include <thread>
+#include <chrono>
 
 #include "logging/LoggingAll.h"
 #include "math/MathConstants.h"
 #include "various/serializer/Serializer.h"
 #include "concurrency/ObjectLock.h"
+#include "concurrency/ExecutorService.h"
 
 #include "LocalStore.h"
 
@@ -30,21 +41,50 @@ namespace l::filecache {
 		int32_t blockWidth, 
 		int32_t clampedPos);
 
+	// Memory held by the loaded blocks of a cache, a cache budget can forward its usage to a store wide parent budget
+	class CacheMemoryBudget {
+	public:
+		CacheMemoryBudget(CacheMemoryBudget* parent = nullptr) : mParent(parent) {}
+		~CacheMemoryBudget() = default;
+
+		// A limit of 0 is unlimited
+		void SetLimit(size_t bytes);
+		size_t GetLimit() const;
+		size_t GetUsage() const;
+		bool IsExceeded() const;
+		size_t GetExcess() const;
+
+		void Add(size_t bytes);
+		void Release(size_t bytes);
+
+	protected:
+		CacheMemoryBudget* mParent = nullptr;
+		std::atomic<size_t> mLimit = 0;
+		std::atomic<size_t> mUsage = 0;
+	};
+
+	// Data types can report their heap usage, otherwise a block is accounted as sizeof(T) plus the size of its last
+	// archive. Such blocks undercount until they are first loaded or persisted, so types with large heap data should
+	// implement GetMemoryUsage to be held to a budget.
+	template<class T>
+	concept HasMemoryUsage = requires(const T & data) { { data.GetMemoryUsage() } -> std::convertible_to<size_t>; };
+
 	template<class T>
 	class CacheBlock {
 	public:
 		CacheBlock() :
-			mPath(""),
 			mData(nullptr),
+			mPath(""),
 			mCacheProvider(nullptr),
 			mPersistOnDestruction(false)
 		{}
 
-		CacheBlock(std::string_view path, ICacheProvider* provider, bool noProvisioning = false, bool persistOnDestruction = false) :
-			mPath(path),
+		CacheBlock(std::string_view path, ICacheProvider* provider, bool noProvisioning = false, bool persistOnDestruction = false, CacheMemoryBudget* budget = nullptr) :
 			mData(nullptr),
+			mPath(path),
 			mCacheProvider(provider),
-			mPersistOnDestruction(persistOnDestruction)
+			mPersistOnDestruction(persistOnDestruction),
+			mBudget(budget)
 		{
 			if (!noProvisioning) {
 				ProvideData();
@@ -54,6 +94,9 @@ namespace l::filecache {
 			if (mPersistOnDestruction) {
 				PersistData();
 			}
+			if (mBudget != nullptr) {
+				mBudget->Release(mMemoryUsage);
+			}
 		}
 
 		friend zpp::serializer::access;
@@ -63,35 +106,216 @@ namespace l::filecache {
 		}
 
 		bool PersistData() {
-			if (!mCacheProvider) {
+			return Persist(true);
+		}
+
+		// Persists the data if it changed since it was loaded or persisted
+		bool PersistIfDirty() {
+			return Persist(false);
+		}
+
+		bool ProvideData() {
+			std::lock_guard lock(mDataMutex);
+			return ProvideLocked();
+		}
+
+		// Loads the block from the provider the first time it is asked for unless it already had data. A caller
+		// racing a background load waits for it instead of reading the same data again. Returns true if this call
+		// loaded the data.
+		bool ProvideOnce() {
+			if (mProvided) {
+				return false;
+			}
+			std::lock_guard lock(mDataMutex);
+			if (mProvided.exchange(true) || mData) {
 				return false;
 			}
+			return ProvideLocked();
+		}
 
-			std::vector<unsigned char> data;
-			GetArchiveData(data);
+		// True if the block was never loaded or its data was evicted
+		bool NeedsLoad() const {
+			return !mProvided || mEvicted;
+		}
 
-			std::lock_guard lock(mPathMutex);
-			return mCacheProvider->PersistData(mPath, data);
+		// Background load ahead of use. Unlike ProvideOnce it also reloads evicted data. Returns true if this call
+		// loaded the data.
+		bool Preload() {
+			if (!NeedsLoad()) {
+				return false;
+			}
+			std::lock_guard lock(mDataMutex);
+			if (mData) {
+				return false;
+			}
+			mReferenced = true;
+			if (mEvicted) {
+				return ProvideLocked();
+			}
+			if (mProvided.exchange(true)) {
+				return false;
+			}
+			return ProvideLocked();
 		}
 
-		bool ProvideData() {
+		bool GetArchiveData(std::vector<unsigned char>& data) {
+			std::lock_guard lock(mDataMutex);
+			return SaveArchive(data);
+		}
+
+		bool LoadArchiveData(std::vector<unsigned char>& data) {
+			std::lock_guard lock(mDataMutex);
+			return LoadArchive(data);
+		}
+
+		// Deserializes in place from a read only view, such as a mapped file, without an intermediate vector
+		bool LoadArchiveData(std::span<const unsigned char> data) {
+			std::lock_guard lock(mDataMutex);
+			return LoadArchive(data);
+		}
+
+		bool HasData() {
+			std::shared_lock lock(mDataMutex);
+			return mData != nullptr;
+		}
+
+		void AllocateBlockData(int32_t blockSize = 1) {
+			std::lock_guard lock(mDataMutex);
+			ReloadIfEvicted();
+			if (!mData) {
+				mData = std::make_unique<T>(blockSize);
+				mDirty = true;
+				mEvicted = false;
+				mProvided = true;
+				UpdateMemoryUsageLocked();
+			}
+		}
+
+		// Write access, the block is considered modified and is persisted before it is evicted
+		l::concurrency::ObjectLock<T, std::shared_mutex> Get() {
+			mDataMutex.lock();
+			ReloadIfEvicted();
+			mDirty = mData != nullptr;
+			return l::concurrency::ObjectLock<T, std::shared_mutex>(mDataMutex, mData.get());
+		}
+
+		// Read access, leaves the dirty state alone. Readers share the lock, only a reload after eviction takes it
+		// exclusively for a moment.
+		l::concurrency::SharedObjectLock<const T> Read() {
+			mReferenced = true;
+			mDataMutex.lock_shared();
+			if (!mData && mEvicted) {
+				mDataMutex.unlock_shared();
+				{
+					std::lock_guard lock(mDataMutex);
+					ReloadIfEvicted();
+				}
+				mDataMutex.lock_shared();
+			}
+			return l::concurrency::SharedObjectLock<const T>(mDataMutex, mData.get());
+		}
+
+		// Pinned blocks are never evicted, pins nest
+		void Pin() {
+			mPinCount++;
+			mReferenced = true;
+		}
+		void Unpin() {
+			ASSERT(mPinCount > 0);
+			mPinCount--;
+		}
+		bool IsPinned() const {
+			return mPinCount > 0;
+		}
+		bool IsDirty() const {
+			return mDirty;
+		}
+		bool IsEvicted() const {
+			return mEvicted;
+		}
+		bool IsProvided() const {
+			return mProvided;
+		}
+
+		size_t GetMemoryUsage() const {
+			return mMemoryUsage;
+		}
+
+		// Call after changing the size of the data so the budget sees it
+		void UpdateMemoryUsage() {
+			std::lock_guard lock(mDataMutex);
+			UpdateMemoryUsageLocked();
+		}
+
+		// CLOCK second chance, returns true if the block was referenced since the last sweep and clears the mark
+		bool ClearReferenced() {
+			return mReferenced.exchange(false);
+		}
+
+		// Drops the data unless the block is pinned or locked by a user. Dirty data is persisted first and stays if
+		// that fails. Returns the number of bytes released.
+		size_t Evict() {
+			if (IsPinned()) {
+				return 0;
+			}
+			std::unique_lock<std::shared_mutex> lock(mDataMutex, std::try_to_lock);
+			if (!lock.owns_lock() || !mData || IsPinned()) {
+				return 0;
+			}
+			if (mDirty) {
+				if (!mCacheProvider) {
+					return 0;
+				}
+				std::vector<unsigned char> data;
+				SaveArchive(data);
+				std::lock_guard pathLock(mPathMutex);
+				if (!mCacheProvider->PersistData(mPath, data)) {
+					return 0;
+				}
+				mDirty = false;
+			}
+			auto released = mMemoryUsage.load();
+			mData.reset();
+			mEvicted = true;
+			UpdateMemoryUsageLocked();
+			return released;
+		}
+
+	protected:
+		// The data lock is only held while the archive is written, so writers don't wait on the provider. The dirty
+		// flag is cleared and the path lock taken before the data lock is released, so a write made during the
+		// provider call dirties the block again and an older archive can't overwrite a newer one. A block that
+		// fails to persist stays dirty.
+		bool Persist(bool always) {
 			if (!mCacheProvider) {
 				return false;
 			}
 
 			std::vector<unsigned char> data;
-			{
-				std::lock_guard lock(mPathMutex);
-				if (!mCacheProvider->ProvideData(mPath, data)) {
-					return false;
+			std::unique_lock<std::shared_mutex> dataLock(mDataMutex);
+			if (!mData) {
+				return !always;
+			}
+			if (!always && !mDirty) {
+				return true;
+			}
+			if (!SaveArchive(data)) {
+				return false;
+			}
+			bool wasDirty = mDirty.exchange(false);
+			std::lock_guard pathLock(mPathMutex);
+			dataLock.unlock();
+			if (!mCacheProvider->PersistData(mPath, data)) {
+				if (wasDirty) {
+					mDirty = true;
 				}
-				LoadArchiveData(data);
+				return false;
 			}
 			return true;
 		}
 
-		bool GetArchiveData(std::vector<unsigned char>& data) {
-			std::lock_guard lock(mDataMutex);
+		// Called with the data mutex held
+		bool SaveArchive(std::vector<unsigned char>& data) {
 			if (!mData) {
 				return false;
 			}
@@ -100,56 +324,119 @@ namespace l::filecache {
 				auto sb = reinterpret_cast<l::serialization::SerializationBase*>(mData.get());
 				if (sb != nullptr) {
 					sb->GetArchiveData(data);
+					mArchiveSize = data.size();
+					UpdateMemoryUsageLocked();
 					return true;
 				}
 			}
 
 			zpp::serializer::memory_output_archive out(data);
 			out(*this);
+			mArchiveSize = data.size();
+			UpdateMemoryUsageLocked();
 
 			return true;
 		}
 
-		bool LoadArchiveData(std::vector<unsigned char>& data) {
-			if (data.size() > 0) {
-				std::lock_guard lock(mDataMutex);
-				if (!mData) {
-					mData = std::make_unique<T>();
-				}
-				if constexpr (std::is_base_of_v<l::serialization::SerializationBase, T>) {
-					auto sb = reinterpret_cast<l::serialization::SerializationBase*>(mData.get());
-					if (sb != nullptr) {
-						sb->LoadArchiveData(data);
-						return true;
-					}
+		bool LoadArchive(std::vector<unsigned char>& data) {
+			if (data.empty()) {
+				return false;
+			}
+			if (!mData) {
+				mData = std::make_unique<T>();
+			}
+			mArchiveSize = data.size();
+			mDirty = false;
+			mEvicted = false;
+			mProvided = true;
+			if constexpr (std::is_base_of_v<l::serialization::SerializationBase, T>) {
+				auto sb = reinterpret_cast<l::serialization::SerializationBase*>(mData.get());
+				if (sb != nullptr) {
+					sb->LoadArchiveData(data);
+					UpdateMemoryUsageLocked();
+					return true;
 				}
+			}
 
-				zpp::serializer::memory_input_archive in(data);
+			zpp::serializer::memory_input_archive in(data);
+			in(*this);
+			UpdateMemoryUsageLocked();
+			return true;
+		}
+
+		bool LoadArchive(std::span<const unsigned char> data) {
+			if (data.empty()) {
+				return false;
+			}
+			if (!mData) {
+				mData = std::make_unique<T>();
+			}
+			mArchiveSize = data.size();
+			mDirty = false;
+			mEvicted = false;
+			mProvided = true;
+			bool result = true;
+			if constexpr (std::is_base_of_v<l::serialization::SerializationBase, T>) {
+				auto sb = reinterpret_cast<l::serialization::SerializationBase*>(mData.get());
+				result = sb->LoadArchiveData(data);
+			}
+			else {
+				zpp::serializer::memory_view_input_archive in(data.data(), data.size());
 				in(*this);
-				return true;
 			}
-			return false;
+			UpdateMemoryUsageLocked();
+			return result;
 		}
 
-		bool HasData() {
-			std::lock_guard<std::mutex> lock(mDataMutex);
-			return mData != nullptr;
+		// Called with the data mutex held. Views are preferred so mapped data is deserialized without a copy.
+		bool ProvideLocked() {
+			if (!mCacheProvider) {
+				return false;
+			}
+			CacheDataView view;
+			std::vector<unsigned char> data;
+			bool hasView = false;
+			{
+				std::lock_guard lock(mPathMutex);
+				hasView = mCacheProvider->ProvideView(mPath, view);
+				if (!hasView && !mCacheProvider->ProvideData(mPath, data)) {
+					return false;
+				}
+			}
+			return hasView ? LoadArchive(view.mData) : LoadArchive(data);
 		}
 
-		void AllocateBlockData(int32_t blockSize = 1) {
-			std::lock_guard<std::mutex> lock(mDataMutex);
-			if (!mData) {
-				mData = std::make_unique<T>(blockSize);
+		// Called with the data mutex held
+		void ReloadIfEvicted() {
+			mReferenced = true;
+			if (mData || !mEvicted) {
+				return;
 			}
+			ProvideLocked();
 		}
 
-		l::concurrency::ObjectLock<T> Get() {
-			mDataMutex.lock();
-			return l::concurrency::ObjectLock<T>(mDataMutex, mData.get());
+		void UpdateMemoryUsageLocked() {
+			size_t usage = 0;
+			if (mData) {
+				if constexpr (HasMemoryUsage<T>) {
+					usage = mData->GetMemoryUsage();
+				}
+				else {
+					usage = sizeof(T) + mArchiveSize;
+				}
+			}
+			if (mBudget != nullptr) {
+				if (usage > mMemoryUsage) {
+					mBudget->Add(usage - mMemoryUsage);
+				}
+				else {
+					mBudget->Release(mMemoryUsage - usage);
+				}
+			}
+			mMemoryUsage = usage;
 		}
 
-	protected:
-		std::mutex mDataMutex;
+		std::shared_mutex mDataMutex;
 		std::unique_ptr<T> mData;
 
 		std::string mPath;
@@ -157,6 +444,263 @@ namespace l::filecache {
 		ICacheProvider* mCacheProvider;
 
 		bool mPersistOnDestruction;
+
+		CacheMemoryBudget* mBudget = nullptr;
+		std::atomic<size_t> mMemoryUsage = 0;
+		size_t mArchiveSize = 0;
+		std::atomic<int32_t> mPinCount = 0;
+		std::atomic_bool mReferenced = true;
+		std::atomic_bool mDirty = false;
+		std::atomic_bool mEvicted = false;
+		std::atomic_bool mProvided = false;
+	};
+
+	// Keeps a block pinned for the lifetime of the scope
+	template<class T>
+	class CacheBlockPin {
+	public:
+		CacheBlockPin(CacheBlock<T>* block) : mBlock(block) {
+			if (mBlock != nullptr) {
+				mBlock->Pin();
+			}
+		}
+		~CacheBlockPin() {
+			if (mBlock != nullptr) {
+				mBlock->Unpin();
+			}
+		}
+		CacheBlockPin(CacheBlockPin&& other) noexcept : mBlock(other.mBlock) {
+			other.mBlock = nullptr;
+		}
+		CacheBlockPin(const CacheBlockPin&) = delete;
+		CacheBlockPin& operator=(const CacheBlockPin&) = delete;
+		CacheBlockPin& operator=(CacheBlockPin&&) = delete;
+
+	protected:
+		CacheBlock<T>* mBlock = nullptr;
+	};
+
+	// Loads blocks from their provider on an executor. Loads that haven't started when the queue is closed are dropped
+	// and running ones are waited for, so queued blocks only have to outlive the queue.
+	class CacheLoadQueue {
+	public:
+		CacheLoadQueue() = default;
+		~CacheLoadQueue() {
+			Close();
+		}
+
+		void SetExecutor(l::concurrency::ExecutorService* executor) {
+			mExecutor = executor;
+		}
+		bool IsActive() const {
+			return mExecutor != nullptr;
+		}
+
+		// Queues blocks that were never loaded or were evicted, unless their load is already queued
+		template<class T>
+		bool Queue(CacheBlock<T>* cacheBlock) {
+			if (mExecutor == nullptr || !cacheBlock->NeedsLoad()) {
+				return false;
+			}
+			{
+				std::lock_guard<std::mutex> lock(mState->mMutex);
+				if (!mState->mQueued.insert(cacheBlock).second) {
+					return false;
+				}
+			}
+			auto queued = mExecutor->queueJob("cache load", [state = mState, cacheBlock](const l::concurrency::RunState&) {
+				{
+					std::lock_guard<std::mutex> lock(state->mMutex);
+					state->mQueued.erase(cacheBlock);
+					if (!state->mAlive) {
+						return l::concurrency::RunnableResult::CANCELLED;
+					}
+					state->mRunning++;
+				}
+				cacheBlock->Preload();
+				{
+					std::lock_guard<std::mutex> lock(state->mMutex);
+					state->mRunning--;
+				}
+				state->mCondition.notify_all();
+				return l::concurrency::RunnableResult::SUCCESS;
+				});
+			if (!queued) {
+				std::lock_guard<std::mutex> lock(mState->mMutex);
+				mState->mQueued.erase(cacheBlock);
+			}
+			return queued;
+		}
+
+		void Close() {
+			std::unique_lock<std::mutex> lock(mState->mMutex);
+			mState->mAlive = false;
+			mState->mCondition.wait(lock, [&]() {
+				return mState->mRunning == 0;
+				});
+		}
+
+	protected:
+		// Shared with the queued jobs so they can tell that the queue is closed
+		struct State {
+			std::mutex mMutex;
+			std::condition_variable mCondition;
+			bool mAlive = true;
+			int32_t mRunning = 0;
+			std::unordered_set<const void*> mQueued; // blocks with a load waiting to run
+		};
+
+		l::concurrency::ExecutorService* mExecutor = nullptr;
+		std::shared_ptr<State> mState = std::make_shared<State>();
+	};
+
+	// Write behind queue, blocks are persisted in batches by a background thread. A block queued again before its
+	// batch is taken is only written once. Batches are taken once batchSize blocks are waiting or the oldest has
+	// waited for delay, whichever comes first. Blocks that fail to persist stay dirty and are queued again after
+	// a delay that doubles with every failure, and get a last attempt when the queue goes away. Queued blocks have
+	// to outlive the queue.
+	template<class T>
+	class CacheWriteBehind {
+	public:
+		CacheWriteBehind(size_t batchSize = 64, std::chrono::milliseconds delay = std::chrono::milliseconds(100)) :
+			mBatchSize(batchSize > 0 ? batchSize : 1),
+			mDelay(delay)
+		{
+			mThread = std::thread(&CacheWriteBehind::Work, this);
+		}
+		~CacheWriteBehind() {
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				mStop = true;
+			}
+			mCondition.notify_all();
+			if (mThread.joinable()) {
+				mThread.join();
+			}
+		}
+
+		void Queue(CacheBlock<T>* cacheBlock) {
+			bool notify = false;
+			{
+				std::lock_guard<std::mutex> lock(mMutex);
+				if (!mQueued.insert(cacheBlock).second) {
+					return;
+				}
+				mQueue.push_back(cacheBlock);
+				mQueuedGeneration++;
+				notify = mQueue.size() >= mBatchSize;
+			}
+			if (notify) {
+				mCondition.notify_all();
+			}
+		}
+
+		// Barrier, returns when every block queued before the call had a persist attempt. Blocks that failed
+		// earlier are tried again right away. False while any block is still waiting for a successful persist.
+		bool Flush() {
+			std::unique_lock<std::mutex> lock(mMutex);
+			RequeueFailedLocked();
+			auto target = mQueuedGeneration;
+			mFlushGeneration = std::max(mFlushGeneration, target);
+			mCondition.notify_all();
+			mFlushed.wait(lock, [&]() {
+				return mPersistedGeneration >= target;
+				});
+			return mFailedBlocks.empty();
+		}
+
+		size_t GetQueued() {
+			std::lock_guard<std::mutex> lock(mMutex);
+			return mQueue.size();
+		}
+
+	protected:
+		// Moves the blocks that failed to persist back into the queue
+		void RequeueFailedLocked() {
+			for (auto cacheBlock : mFailedBlocks) {
+				if (mQueued.insert(cacheBlock).second) {
+					mQueue.push_back(cacheBlock);
+				}
+			}
+			if (!mFailedBlocks.empty()) {
+				mQueuedGeneration++;
+			}
+		}
+
+		void Work() {
+			std::vector<CacheBlock<T>*> batch;
+			std::vector<CacheBlock<T>*> failed;
+			auto retryDelay = mDelay;
+			auto retryTime = std::chrono::steady_clock::time_point::max();
+			bool lastAttempt = false;
+			std::unique_lock<std::mutex> lock(mMutex);
+			while (true) {
+				auto wakeTime = std::min(std::chrono::steady_clock::now() + mDelay, retryTime);
+				mCondition.wait_until(lock, wakeTime, [&]() {
+					return mStop || mQueue.size() >= mBatchSize || mFlushGeneration > mPersistedGeneration;
+					});
+				// failed blocks are tried again after a growing delay, and a last time when stopping
+				if (!mFailedBlocks.empty() && !lastAttempt && (mStop || std::chrono::steady_clock::now() >= retryTime)) {
+					RequeueFailedLocked();
+					retryTime = std::chrono::steady_clock::time_point::max();
+					lastAttempt = mStop;
+				}
+				if (mQueue.empty()) {
+					if (mStop) {
+						break;
+					}
+					continue;
+				}
+				batch.swap(mQueue);
+				mQueued.clear();
+				auto generation = mQueuedGeneration;
+				lock.unlock();
+
+				for (auto cacheBlock : batch) {
+					if (!cacheBlock->PersistIfDirty()) {
+						failed.push_back(cacheBlock);
+					}
+				}
+
+				lock.lock();
+				for (auto cacheBlock : batch) {
+					mFailedBlocks.erase(cacheBlock);
+				}
+				for (auto cacheBlock : failed) {
+					mFailedBlocks.insert(cacheBlock);
+				}
+				if (failed.empty()) {
+					retryDelay = mDelay;
+				}
+				else if (lastAttempt) {
+					LOG(LogError) << "Failed to persist " << failed.size() << " cache blocks before shutdown";
+				}
+				else {
+					LOG(LogWarning) << "Failed to persist " << failed.size() << " cache blocks, retrying in " << retryDelay.count() << "ms";
+					retryTime = std::chrono::steady_clock::now() + retryDelay;
+					retryDelay = std::min(retryDelay * 2, mDelay * 64);
+				}
+				batch.clear();
+				failed.clear();
+				mPersistedGeneration = generation;
+				mFlushed.notify_all();
+			}
+		}
+
+		size_t mBatchSize;
+		std::chrono::milliseconds mDelay;
+
+		std::mutex mMutex;
+		std::condition_variable mCondition;
+		std::condition_variable mFlushed;
+		std::vector<CacheBlock<T>*> mQueue;
+		std::unordered_set<CacheBlock<T>*> mQueued;
+		std::unordered_set<CacheBlock<T>*> mFailedBlocks; // dirty blocks whose last persist failed
+		uint64_t mQueuedGeneration = 0;
+		uint64_t mFlushGeneration = 0;
+		uint64_t mPersistedGeneration = 0;
+		bool mStop = false;
+		std::thread mThread;
 	};
 
 	template<class T>
@@ -165,10 +709,12 @@ namespace l::filecache {
 		SequentialCache(
 			std::string_view cacheKey, 
 			int32_t cacheBlockWidth, 
-			ICacheProvider* cacheProvider
+			ICacheProvider* cacheProvider,
+			CacheMemoryBudget* parentBudget = nullptr
 		) :
 			mCacheKey(cacheKey),
 			mCacheBlockWidth(cacheBlockWidth),
+			mBudget(parentBudget),
 			mCacheProvider(cacheProvider)
 		{
 			ASSERT(cacheBlockWidth > 0) << "Cache block width cannot be zero";
@@ -179,38 +725,124 @@ namespace l::filecache {
 		bool Has(int32_t position) {
 			auto clampedPos = GetClampedPosition(position, mCacheBlockWidth);
 
-			std::lock_guard<std::mutex> lock(mMutexCacheBlockMap);
-			auto it = mCacheBlockMap.find(clampedPos);
-			if (it != mCacheBlockMap.end()) {
-				return true;
-			}
-			return false;
+			auto& stripe = GetStripe(clampedPos);
+			std::shared_lock lock(stripe.mMutex);
+			return stripe.mBlocks.contains(clampedPos);
 		}
 
+		// Blocks are loaded outside the map lock so a slow provider only holds up callers of the same block
 		CacheBlock<T>* Get(int32_t position, bool noProvisioning = false) {
 			auto clampedPos = GetClampedPosition(position, mCacheBlockWidth);
 
-			std::lock_guard<std::mutex> lock(mMutexCacheBlockMap);
-			auto it = mCacheBlockMap.find(clampedPos);
-			if (it == mCacheBlockMap.end()) {
-				auto filename = GetCacheBlockName(mCacheKey, mCacheBlockWidth, clampedPos);
-				mCacheBlockMap.emplace(clampedPos, std::make_unique<CacheBlock<T>>(filename, mCacheProvider, noProvisioning));
-				it = mCacheBlockMap.find(clampedPos);
+			auto& stripe = GetStripe(clampedPos);
+			CacheBlock<T>* cacheBlock = nullptr;
+			{
+				std::shared_lock lock(stripe.mMutex);
+				auto it = stripe.mBlocks.find(clampedPos);
+				if (it != stripe.mBlocks.end()) {
+					cacheBlock = it->second.get();
+				}
+			}
+			if (cacheBlock == nullptr) {
+				std::lock_guard lock(stripe.mMutex);
+				cacheBlock = GetOrCreateLocked(stripe, clampedPos);
 			}
 
-			return it->second.get();
+			if (mBudget.IsExceeded()) {
+				CacheBlockPin<T> pin(cacheBlock);
+				Evict(mBudget.GetExcess());
+			}
+			if (!noProvisioning) {
+				cacheBlock->ProvideOnce();
+			}
+			return cacheBlock;
 		}
 
 		int32_t GetBlockWidth() {
 			return mCacheBlockWidth;
 		}
 
+		// Bytes of block data this cache may hold before unpinned blocks are evicted, 0 is unlimited
+		void SetMemoryBudget(size_t bytes) {
+			mBudget.SetLimit(bytes);
+			if (mBudget.IsExceeded()) {
+				Evict(mBudget.GetExcess());
+			}
+		}
+
+		size_t GetMemoryUsage() const {
+			return mBudget.GetUsage();
+		}
+
+		// Evicts unpinned blocks in CLOCK order until at least bytes are released or every block was visited twice.
+		// Candidates are picked under the clock lock and evicted after it is released, so persisting dirty blocks
+		// doesn't hold up block creation. Returns the number of bytes released.
+		size_t Evict(size_t bytes) {
+			size_t released = 0;
+			size_t visited = 0;
+			std::vector<CacheBlock<T>*> candidates;
+			while (released < bytes) {
+				candidates.clear();
+				{
+					std::lock_guard<std::mutex> lock(mClockMutex);
+					size_t expected = released;
+					for (; expected < bytes && visited < 2 * mClock.size(); visited++) {
+						if (mClockHand >= mClock.size()) {
+							mClockHand = 0;
+						}
+						auto cacheBlock = mClock[mClockHand++];
+						auto usage = cacheBlock->GetMemoryUsage();
+						if (usage == 0 || cacheBlock->IsPinned() || cacheBlock->ClearReferenced()) {
+							continue;
+						}
+						candidates.push_back(cacheBlock);
+						expected += usage;
+					}
+				}
+				if (candidates.empty()) {
+					break;
+				}
+				for (auto cacheBlock : candidates) {
+					released += cacheBlock->Evict();
+				}
+			}
+			return released;
+		}
+
 	protected:
+		// Neighbouring blocks land in different stripes so threads walking the same range rarely share a lock
+		static constexpr size_t kNumStripes = 16;
+
+		struct Stripe {
+			std::shared_mutex mMutex;
+			std::unordered_map<int32_t, std::unique_ptr<CacheBlock<T>>> mBlocks; // keyed by clamped position
+		};
+
+		Stripe& GetStripe(int32_t clampedPos) {
+			return mStripes[static_cast<uint32_t>(clampedPos / mCacheBlockWidth) % kNumStripes];
+		}
+
+		// Called with the stripe locked
+		CacheBlock<T>* GetOrCreateLocked(Stripe& stripe, int32_t clampedPos) {
+			auto it = stripe.mBlocks.find(clampedPos);
+			if (it == stripe.mBlocks.end()) {
+				auto filename = GetCacheBlockName(mCacheKey, mCacheBlockWidth, clampedPos);
+				it = stripe.mBlocks.emplace(clampedPos, std::make_unique<CacheBlock<T>>(filename, mCacheProvider, true, false, &mBudget)).first;
+
+				std::lock_guard<std::mutex> lock(mClockMutex);
+				mClock.push_back(it->second.get());
+			}
+			return it->second.get();
+		}
+
 		std::string mCacheKey;
 		int32_t mCacheBlockWidth;
 
-		std::map<int32_t, std::unique_ptr<CacheBlock<T>>> mCacheBlockMap;
-		std::mutex mMutexCacheBlockMap;
+		CacheMemoryBudget mBudget;
+		std::array<Stripe, kNumStripes> mStripes;
+		std::mutex mClockMutex;
+		std::vector<CacheBlock<T>*> mClock; // blocks in creation order, they live as long as the cache
+		size_t mClockHand = 0;
 		ICacheProvider* mCacheProvider;
 	};
 
@@ -220,11 +852,20 @@ namespace l::filecache {
 		SequentialCacheStore(ICacheProvider* cacheProvider = nullptr) :
 			mCacheProvider(cacheProvider)
 		{}
-		~SequentialCacheStore() = default;
+		~SequentialCacheStore() {
+			// pending writes are persisted before the blocks go away
+			mWriteBehind.reset();
+			mPrefetchQueue.Close();
+		}
 
 		bool Has(std::string_view cacheKey, int32_t position) {
-			std::unique_lock<std::mutex> lock(mMutexSequentialCacheMap);
-			auto it = mSequentialCacheMap.find(cacheKey.data());
+			// lookups don't intern, a key that was never interned has no cache
+			auto symbol = l::string::find_symbol(cacheKey);
+			if (symbol == 0) {
+				return false;
+			}
+			std::shared_lock lock(mMutexSequentialCacheMap);
+			auto it = mSequentialCacheMap.find(symbol);
 			if (it == mSequentialCacheMap.end()) {
 				return false;
 			}
@@ -235,8 +876,12 @@ namespace l::filecache {
 		}
 
 		int32_t GetBlockWidth(std::string_view cacheKey) {
-			std::unique_lock<std::mutex> lock(mMutexSequentialCacheMap);
-			auto it = mSequentialCacheMap.find(cacheKey.data());
+			auto symbol = l::string::find_symbol(cacheKey);
+			if (symbol == 0) {
+				return 0;
+			}
+			std::shared_lock lock(mMutexSequentialCacheMap);
+			auto it = mSequentialCacheMap.find(symbol);
 			if (it == mSequentialCacheMap.end()) {
 				return 0;
 			}
@@ -253,19 +898,7 @@ namespace l::filecache {
 			int32_t blockWidth,
 			std::function<bool(int32_t start, int32_t size, CacheBlock<T>*)> callback) {
 
-			std::unique_lock<std::mutex> lock(mMutexSequentialCacheMap);
-			auto it = mSequentialCacheMap.find(cacheKey.data());
-			if (it == mSequentialCacheMap.end()) {
-				mSequentialCacheMap.emplace(cacheKey.data(),
-					std::make_unique<SequentialCache<T>>(
-						cacheKey,
-						blockWidth,
-						mCacheProvider));
-				it = mSequentialCacheMap.find(cacheKey.data());
-			}
-
-			SequentialCache<T>* sequentialCacheMap = it->second.get();
-			lock.unlock();
+			SequentialCache<T>* sequentialCacheMap = GetOrCreateCache(cacheKey, blockWidth);
 
 			auto cacheBlockWidth = sequentialCacheMap->GetBlockWidth();
 			CacheBlock<T>* cacheBlock = nullptr;
@@ -273,9 +906,13 @@ namespace l::filecache {
 			beginPosition = GetClampedPosition(beginPosition, cacheBlockWidth);
 			if (beginPosition < endPosition) {
 				do {
-					cacheBlock = sequentialCacheMap->Get(beginPosition);
+					cacheBlock = GetBlock(sequentialCacheMap, beginPosition);
+					Prefetch(sequentialCacheMap, beginPosition, endPosition, true);
 					if (cacheBlock != nullptr) {
-						if (!callback(beginPosition, cacheBlockWidth, cacheBlock)) {
+						CacheBlockPin<T> pin(cacheBlock);
+						bool proceed = callback(beginPosition, cacheBlockWidth, cacheBlock);
+						QueueIfDirty(cacheBlock);
+						if (!proceed) {
 							break;
 						}
 					}
@@ -287,9 +924,13 @@ namespace l::filecache {
 			}
 			else {
 				do {
-					cacheBlock = sequentialCacheMap->Get(beginPosition);
+					cacheBlock = GetBlock(sequentialCacheMap, beginPosition);
+					Prefetch(sequentialCacheMap, beginPosition, endPosition, false);
 					if (cacheBlock != nullptr) {
-						if (!callback(beginPosition, cacheBlockWidth, cacheBlock)) {
+						CacheBlockPin<T> pin(cacheBlock);
+						bool proceed = callback(beginPosition, cacheBlockWidth, cacheBlock);
+						QueueIfDirty(cacheBlock);
+						if (!proceed) {
 							break;
 						}
 					}
@@ -310,35 +951,12 @@ namespace l::filecache {
 			int32_t blockWidth,
 			std::function<bool(int32_t, int32_t, CacheBlock<T>*, CacheBlock<T>*)> callback) {
 
-			std::unique_lock<std::mutex> lock(mMutexSequentialCacheMap);
-			auto it1 = mSequentialCacheMap.find(cacheKey1.data());
-			if (it1 == mSequentialCacheMap.end()) {
-				mSequentialCacheMap.emplace(cacheKey1.data(),
-					std::make_unique<SequentialCache<T>>(
-						cacheKey1,
-						blockWidth,
-						mCacheProvider));
-				it1 = mSequentialCacheMap.find(cacheKey1.data());
-			}
-
-			SequentialCache<T>* sequentialCacheMap1 = it1->second.get();
+			SequentialCache<T>* sequentialCacheMap1 = GetOrCreateCache(cacheKey1, blockWidth);
 			SequentialCache<T>* sequentialCacheMap2 = nullptr;
-
 			if (!cacheKey2.empty()) {
-				auto it2 = mSequentialCacheMap.find(cacheKey2.data());
-				if (it2 == mSequentialCacheMap.end()) {
-					mSequentialCacheMap.emplace(cacheKey2.data(),
-						std::make_unique<SequentialCache<T>>(
-							cacheKey2,
-							blockWidth,
-							mCacheProvider));
-					it2 = mSequentialCacheMap.find(cacheKey2.data());
-				}
-				sequentialCacheMap2 = it2->second.get();
+				sequentialCacheMap2 = GetOrCreateCache(cacheKey2, blockWidth);
 			}
 
-			lock.unlock();
-
 			auto cacheBlockWidth1 = sequentialCacheMap1->GetBlockWidth();
 			if (sequentialCacheMap2 != nullptr) {
 				auto cacheBlockWidth2 = sequentialCacheMap2->GetBlockWidth();
@@ -350,12 +968,19 @@ namespace l::filecache {
 			beginPosition = GetClampedPosition(beginPosition, cacheBlockWidth1);
 			if (beginPosition <= endPosition) {
 				do {
-					cacheBlock1 = sequentialCacheMap1->Get(beginPosition);
+					cacheBlock1 = GetBlock(sequentialCacheMap1, beginPosition);
+					Prefetch(sequentialCacheMap1, beginPosition, endPosition, true);
 					if (cacheBlock1 != nullptr) {
+						CacheBlockPin<T> pin1(cacheBlock1);
 						if (sequentialCacheMap2 != nullptr) {
-							cacheBlock2 = sequentialCacheMap2->Get(beginPosition);
+							cacheBlock2 = GetBlock(sequentialCacheMap2, beginPosition);
+							Prefetch(sequentialCacheMap2, beginPosition, endPosition, true);
 						}
-						if (!callback(beginPosition, cacheBlockWidth1, cacheBlock1, cacheBlock2)) {
+						CacheBlockPin<T> pin2(cacheBlock2);
+						bool proceed = callback(beginPosition, cacheBlockWidth1, cacheBlock1, cacheBlock2);
+						QueueIfDirty(cacheBlock1);
+						QueueIfDirty(cacheBlock2);
+						if (!proceed) {
 							break;
 						}
 					}
@@ -367,12 +992,19 @@ namespace l::filecache {
 			}
 			else {
 				do {
-					cacheBlock1 = sequentialCacheMap1->Get(beginPosition);
+					cacheBlock1 = GetBlock(sequentialCacheMap1, beginPosition);
+					Prefetch(sequentialCacheMap1, beginPosition, endPosition, false);
 					if (cacheBlock1 != nullptr) {
+						CacheBlockPin<T> pin1(cacheBlock1);
 						if (sequentialCacheMap2 != nullptr) {
-							cacheBlock2 = sequentialCacheMap2->Get(beginPosition);
+							cacheBlock2 = GetBlock(sequentialCacheMap2, beginPosition);
+							Prefetch(sequentialCacheMap2, beginPosition, endPosition, false);
 						}
-						if (!callback(beginPosition, cacheBlockWidth1, cacheBlock1, cacheBlock2)) {
+						CacheBlockPin<T> pin2(cacheBlock2);
+						bool proceed = callback(beginPosition, cacheBlockWidth1, cacheBlock1, cacheBlock2);
+						QueueIfDirty(cacheBlock1);
+						QueueIfDirty(cacheBlock2);
+						if (!proceed) {
 							break;
 						}
 					}
@@ -386,25 +1018,16 @@ namespace l::filecache {
 		}
 
 		CacheBlock<T>* Get(std::string_view cacheKey, int32_t position, int32_t blockWidth, bool noProvisioning = false) {
-			std::unique_lock<std::mutex> lock(mMutexSequentialCacheMap);
-			auto it = mSequentialCacheMap.find(cacheKey.data());
-			if (it == mSequentialCacheMap.end()) {
-				mSequentialCacheMap.emplace(cacheKey.data(),
-					std::make_unique<SequentialCache<T>>(
-						cacheKey,
-						blockWidth,
-						mCacheProvider));
-				it = mSequentialCacheMap.find(cacheKey.data());
-			}
-			SequentialCache<T>* sequentialCacheMap = it->second.get();
-			lock.unlock();
-
-			return sequentialCacheMap->Get(position, noProvisioning);
+			return GetBlock(GetOrCreateCache(cacheKey, blockWidth), position, noProvisioning);
 		}
 
 		SequentialCache<T>* GetCache(std::string_view cacheKey) {
-			std::unique_lock<std::mutex> lock(mMutexSequentialCacheMap);
-			auto it = mSequentialCacheMap.find(cacheKey.data());
+			auto symbol = l::string::find_symbol(cacheKey);
+			if (symbol == 0) {
+				return nullptr;
+			}
+			std::shared_lock lock(mMutexSequentialCacheMap);
+			auto it = mSequentialCacheMap.find(symbol);
 			if (it == mSequentialCacheMap.end()) {
 				return nullptr;
 			}
@@ -415,10 +1038,149 @@ namespace l::filecache {
 			return sequentialCacheMap;
 		}
 
+		// Creates the cache if it doesn't exist yet
+		SequentialCache<T>* GetCache(std::string_view cacheKey, int32_t blockWidth) {
+			return GetOrCreateCache(cacheKey, blockWidth);
+		}
+
+		// Bytes of block data all caches of the store may hold together, 0 is unlimited
+		void SetMemoryBudget(size_t bytes) {
+			mBudget.SetLimit(bytes);
+			EnforceBudget(nullptr);
+		}
+
+		// Budget of every cache on its own, applied to existing and new caches
+		void SetCacheMemoryBudget(size_t bytes) {
+			std::lock_guard lock(mMutexSequentialCacheMap);
+			mCacheBudget = bytes;
+			for (auto& it : mSequentialCacheMap) {
+				it.second->SetMemoryBudget(bytes);
+			}
+		}
+
+		size_t GetMemoryUsage() const {
+			return mBudget.GetUsage();
+		}
+
+		// Read ahead for ForEach and ForEach2, every visited block queues loads of the next depth blocks in the
+		// direction of the iteration on the executor. No executor or a depth of 0 turns it off. Set it before
+		// iterating, the executor has to outlive the store or be shut down first.
+		void SetPrefetch(l::concurrency::ExecutorService* executor, int32_t depth) {
+			mPrefetchQueue.SetExecutor(executor);
+			mPrefetchDepth = depth;
+		}
+
+		// Persists blocks on a background thread instead of the caller, see CacheWriteBehind. Blocks modified
+		// in ForEach and ForEach2 callbacks are queued automatically. A batch size of 0 turns it off and
+		// persists whatever is pending first.
+		void SetWriteBehind(size_t batchSize, std::chrono::milliseconds delay = std::chrono::milliseconds(100)) {
+			mWriteBehind.reset();
+			if (batchSize > 0) {
+				mWriteBehind = std::make_unique<CacheWriteBehind<T>>(batchSize, delay);
+			}
+		}
+
+		// Queues the block when write behind is on, otherwise persists it right away
+		bool PersistBlock(CacheBlock<T>* cacheBlock) {
+			if (mWriteBehind) {
+				mWriteBehind->Queue(cacheBlock);
+				return true;
+			}
+			return cacheBlock->PersistData();
+		}
+
+		// Barrier, returns when every block queued before the call is persisted. False while a write is failing.
+		bool Flush() {
+			return mWriteBehind ? mWriteBehind->Flush() : true;
+		}
+
 	protected:
-		std::map<std::string, std::unique_ptr<SequentialCache<T>>> mSequentialCacheMap;
-		std::mutex mMutexSequentialCacheMap;
+		void QueueIfDirty(CacheBlock<T>* cacheBlock) {
+			if (mWriteBehind && cacheBlock != nullptr && cacheBlock->IsDirty()) {
+				mWriteBehind->Queue(cacheBlock);
+			}
+		}
+
+		void Prefetch(SequentialCache<T>* sequentialCache, int32_t position, int32_t endPosition, bool forward) {
+			if (!mPrefetchQueue.IsActive() || mPrefetchDepth <= 0 || mBudget.IsExceeded()) {
+				return;
+			}
+			int64_t step = forward ? sequentialCache->GetBlockWidth() : -sequentialCache->GetBlockWidth();
+			for (int32_t i = 1; i <= mPrefetchDepth; i++) {
+				int64_t next = position + i * step;
+				if (forward ? next > endPosition : next < endPosition) {
+					break;
+				}
+				// the queue skips blocks that have data or a load already queued, evicted blocks are loaded again
+				mPrefetchQueue.Queue(sequentialCache->Get(static_cast<int32_t>(next), true));
+			}
+		}
+
+		SequentialCache<T>* GetOrCreateCache(std::string_view cacheKey, int32_t blockWidth) {
+			auto symbol = l::string::intern(cacheKey);
+			{
+				std::shared_lock lock(mMutexSequentialCacheMap);
+				auto it = mSequentialCacheMap.find(symbol);
+				if (it != mSequentialCacheMap.end()) {
+					return it->second.get();
+				}
+			}
+
+			std::lock_guard lock(mMutexSequentialCacheMap);
+			auto it = mSequentialCacheMap.find(symbol);
+			if (it == mSequentialCacheMap.end()) {
+				auto sequentialCache = std::make_unique<SequentialCache<T>>(cacheKey, blockWidth, mCacheProvider, &mBudget);
+				sequentialCache->SetMemoryBudget(mCacheBudget);
+				it = mSequentialCacheMap.emplace(symbol, std::move(sequentialCache)).first;
+			}
+			return it->second.get();
+		}
+
+		CacheBlock<T>* GetBlock(SequentialCache<T>* sequentialCache, int32_t position, bool noProvisioning = false) {
+			auto cacheBlock = sequentialCache->Get(position, noProvisioning);
+			if (mBudget.IsExceeded()) {
+				EnforceBudget(cacheBlock);
+			}
+			return cacheBlock;
+		}
+
+		// Spreads the eviction over the caches round robin so one busy cache doesn't lose all of its blocks
+		void EnforceBudget(CacheBlock<T>* keep) {
+			CacheBlockPin<T> pin(keep);
+			std::lock_guard evictionLock(mEvictionMutex);
+			std::shared_lock lock(mMutexSequentialCacheMap);
+			if (mSequentialCacheMap.empty()) {
+				return;
+			}
+			size_t idle = 0;
+			while (mBudget.IsExceeded() && idle < mSequentialCacheMap.size()) {
+				auto it = mSequentialCacheMap.find(mEvictionCursor);
+				if (it == mSequentialCacheMap.end() || ++it == mSequentialCacheMap.end()) {
+					it = mSequentialCacheMap.begin();
+				}
+				mEvictionCursor = it->first;
+				auto share = mBudget.GetExcess() / mSequentialCacheMap.size() + 1;
+				if (it->second->Evict(share) > 0) {
+					idle = 0;
+				}
+				else {
+					idle++;
+				}
+			}
+		}
+
+		CacheMemoryBudget mBudget;
+		size_t mCacheBudget = 0;
+		std::mutex mEvictionMutex;
+		uint32_t mEvictionCursor = 0;
+		std::unordered_map<uint32_t, std::unique_ptr<SequentialCache<T>>> mSequentialCacheMap; // keyed by interned cache key, read mostly
+		std::shared_mutex mMutexSequentialCacheMap;
 		ICacheProvider* mCacheProvider;
+
+		CacheLoadQueue mPrefetchQueue;
+		int32_t mPrefetchDepth = 0;
+
+		std::unique_ptr<CacheWriteBehind<T>> mWriteBehind;
 	};
 
 	template<class T>
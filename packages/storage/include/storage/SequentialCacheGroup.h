@@ -11,18 +11,175 @@
 #include <mutex>
 #include <memory>
 #include <optional>
+#include <tuple>
+#include <span>
+#include <functional>
 
 
 namespace l::filecache {
 
+	// Walks positions block by block and queues the loads of the members ahead of the visits
+	class CacheGroupBase {
+	public:
+		// Loads the members' blocks on the executor, depth blocks ahead of the callback. nullptr loads them in
+		// order on the calling thread.
+		void SetExecutor(l::concurrency::ExecutorService* executor, int32_t depth = 1) {
+			mLoadQueue.SetExecutor(executor);
+			mDepth = depth;
+		}
+
+		int32_t GetBlockWidth() const {
+			return mBlockWidth;
+		}
+
+	protected:
+		CacheGroupBase() = default;
+		~CacheGroupBase() = default;
+
+		// Visits the positions from beginPosition to endPosition, backwards if endPosition is before it
+		template<class QueueLoads, class Visit>
+		bool Walk(int32_t beginPosition, int32_t endPosition, QueueLoads&& queueLoads, Visit&& visit) {
+			if (mBlockWidth <= 0) {
+				return false;
+			}
+			int64_t position = GetClampedPosition(beginPosition, mBlockWidth);
+			int64_t step = position <= endPosition ? mBlockWidth : -mBlockWidth;
+			int64_t queued = position - step;
+			bool visited = false;
+
+			while (step > 0 ? position <= endPosition : position >= endPosition) {
+				if (mLoadQueue.IsActive()) {
+					for (int32_t i = 0; i <= mDepth; i++) {
+						int64_t next = position + i * step;
+						if (step > 0 ? next > endPosition : next < endPosition) {
+							break;
+						}
+						if (step > 0 ? next > queued : next < queued) {
+							queueLoads(static_cast<int32_t>(next));
+							queued = next;
+						}
+					}
+				}
+
+				visited = true;
+				if (!visit(static_cast<int32_t>(position))) {
+					break;
+				}
+
+				position += step;
+				if (position > l::math::constants::INTMAX || position < l::math::constants::INTMIN) {
+					break;
+				}
+			}
+			return visited;
+		}
+
+		// Blocks that were never loaded or were evicted are loaded on the executor
+		template<class T>
+		void QueueLoad(CacheBlock<T>* cacheBlock) {
+			mLoadQueue.Queue(cacheBlock);
+		}
+
+		int32_t mBlockWidth = 0;
+		int32_t mDepth = 1;
+
+		CacheLoadQueue mLoadQueue;
+	};
+
+	// Iterates a number of caches with the same block width in lockstep, for example the candles and the trades of
+	// a symbol. The blocks of all members at a position are loaded in parallel on the executor, if one is set, and
+	// handed to the callback together. The caches have to outlive the group.
 	template<class... T>
-	class CacheGroup {
+	class CacheGroup : public CacheGroupBase {
+		static_assert(sizeof...(T) > 0, "A cache group needs at least one cache");
 	public:
-		const size_t size = sizeof...(T);
+		static constexpr size_t size = sizeof...(T);
+
+		using Blocks = std::tuple<CacheBlock<T>*...>;
+		using cbType = std::function<bool(int32_t start, int32_t size, const Blocks& blocks)>;
+
+		CacheGroup(SequentialCache<T>*... caches) : mCaches(caches...) {
+			int32_t widths[] = { caches->GetBlockWidth()... };
+			mBlockWidth = widths[0];
+			for (auto width : widths) {
+				if (width != mBlockWidth) {
+					ASSERT(false) << "Grouped caches must have the same block width";
+					mBlockWidth = 0;
+				}
+			}
+		}
+		~CacheGroup() = default;
 
-		using cbType = std::function<bool(int32_t, int32_t, SequentialCache<T>*...)>;
+		bool ForEach(int32_t beginPosition, int32_t endPosition, cbType callback) {
+			auto queueLoads = [&](int32_t position) {
+				std::apply([&](auto*... caches) {
+					(QueueLoad(caches->Get(position, true)), ...);
+					}, mCaches);
+				};
+			return Walk(beginPosition, endPosition, queueLoads, [&](int32_t position) {
+				// loads that haven't started yet are done here, running ones are waited for on the first read
+				auto blocks = std::apply([&](auto*... caches) {
+					return Blocks(caches->Get(position)...);
+					}, mCaches);
 
+				return std::apply([&](auto*... cacheBlocks) {
+					std::tuple<CacheBlockPin<T>...> pins(cacheBlocks...);
+					return callback(position, mBlockWidth, blocks);
+					}, blocks);
+				});
+		}
+
+	protected:
+		std::tuple<SequentialCache<T>*...> mCaches;
 	};
 
+	// Same type form of CacheGroup for member sets chosen at run time, for example the candles of a list of symbols.
+	// The callback gets the members' blocks in the order of the caches.
+	template<class T>
+	class SequentialCacheGroup : public CacheGroupBase {
+	public:
+		using cbType = std::function<bool(int32_t start, int32_t size, std::span<CacheBlock<T>*> blocks)>;
+
+		SequentialCacheGroup(std::span<SequentialCache<T>*> caches) : mCaches(caches.begin(), caches.end()) {
+			ASSERT(!mCaches.empty()) << "A cache group needs at least one cache";
+			mBlockWidth = mCaches.empty() ? 0 : mCaches.front()->GetBlockWidth();
+			for (auto cache : mCaches) {
+				if (cache->GetBlockWidth() != mBlockWidth) {
+					ASSERT(false) << "Grouped caches must have the same block width";
+					mBlockWidth = 0;
+				}
+			}
+		}
+		~SequentialCacheGroup() = default;
+
+		size_t size() const {
+			return mCaches.size();
+		}
+
+		bool ForEach(int32_t beginPosition, int32_t endPosition, cbType callback) {
+			std::vector<CacheBlock<T>*> blocks(mCaches.size());
+			std::vector<CacheBlockPin<T>> pins;
+			pins.reserve(mCaches.size());
+			auto queueLoads = [&](int32_t position) {
+				for (auto cache : mCaches) {
+					QueueLoad(cache->Get(position, true));
+				}
+				};
+			return Walk(beginPosition, endPosition, queueLoads, [&](int32_t position) {
+				// the pins are released when the callback returns or throws
+				pins.clear();
+				for (size_t i = 0; i < mCaches.size(); i++) {
+					blocks[i] = mCaches[i]->Get(position);
+					pins.emplace_back(blocks[i]);
+				}
+				bool proceed = callback(position, mBlockWidth, blocks);
+				pins.clear();
+				return proceed;
+				});
+		}
+
+	protected:
+		std::vector<SequentialCache<T>*> mCaches;
+	};
 
-}
\ No newline at end of file
+}
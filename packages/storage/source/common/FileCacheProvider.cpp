@@ -2,6 +2,31 @@
 #include <filesystem/File.h>
 
 #include <logging/String.h>
+#include <logging/LoggingAll.h>
+
+namespace {
+	const std::string_view kManifestHeader = "manifest 1";
+
+	// Block names are <cache key>_<block width>_<clamped position>, possibly in a subdirectory
+	bool ParseBlockName(std::string_view name, std::string_view& cacheKey, int32_t& blockWidth, int32_t& position) {
+		auto slash = name.rfind('/');
+		if (slash != std::string_view::npos) {
+			name = name.substr(slash + 1);
+		}
+		auto positionSeparator = name.rfind('_');
+		if (positionSeparator == std::string_view::npos || positionSeparator == 0) {
+			return false;
+		}
+		auto widthSeparator = name.rfind('_', positionSeparator - 1);
+		if (widthSeparator == std::string_view::npos) {
+			return false;
+		}
+		cacheKey = name.substr(0, widthSeparator);
+		blockWidth = std::atoi(std::string(name.substr(widthSeparator + 1, positionSeparator - widthSeparator - 1)).c_str());
+		position = std::atoi(std::string(name.substr(positionSeparator + 1)).c_str());
+		return true;
+	}
+}
 
 namespace l::filecache {
 
@@ -9,17 +34,23 @@ namespace l::filecache {
 		if (data.empty()) {
 			return false;
 		}
+		auto added = OnBlockPersisting(path);
 		auto file = mLocation / (std::string(path) + mExtension);
 
 		l::filesystem::File f(file);
 		f.modeBinary().modeWriteTrunc();
 		if (!f.open()) {
+			if (added) {
+				OnBlockRemoved(path);
+			}
 			return false;
 		}
 		f.write(data);
 		f.close();
 		//LOG(LogInfo) << "Saved " << path;
 
+		// only a new file changes the directory
+		OnBlockPersisted(added);
 		return true;
 	}
 
@@ -44,6 +75,19 @@ namespace l::filecache {
 		return true;
 	}
 
+	bool FileCacheProvider::RemoveData(std::string_view path) {
+		{
+			std::lock_guard<std::mutex> lock(mManifestMutex);
+			LoadManifest();
+		}
+		std::error_code error;
+		if (!std::filesystem::remove(mLocation / (std::string(path) + mExtension), error)) {
+			return false;
+		}
+		OnBlockRemoved(path);
+		return true;
+	}
+
 	void FileCacheProvider::ScanLocation(
 		std::string_view location, 
 		std::string_view extension, 
@@ -93,4 +137,179 @@ namespace l::filecache {
 		}
 	}
 
+	void FileCacheProvider::ScanLocation(
+		std::string_view cacheKey,
+		std::function<void(int32_t position, int32_t blockwidth)> handler) {
+		std::vector<std::pair<int32_t, int32_t>> blocks;
+		{
+			std::lock_guard<std::mutex> lock(mManifestMutex);
+			LoadManifest();
+			for (auto& name : mBlocks) {
+				std::string_view foundCacheKey;
+				int32_t blockWidth = 0;
+				int32_t position = 0;
+				if (ParseBlockName(name, foundCacheKey, blockWidth, position) && foundCacheKey == cacheKey) {
+					blocks.emplace_back(position, blockWidth);
+				}
+			}
+		}
+		for (auto& [position, blockWidth] : blocks) {
+			handler(position, blockWidth);
+		}
+	}
+
+	std::filesystem::path FileCacheProvider::GetManifestPath() const {
+		return mLocation / ("cache" + mExtension + ".manifest");
+	}
+
+	void FileCacheProvider::LoadManifest() {
+		if (mManifestLoaded) {
+			return;
+		}
+		mManifestLoaded = true;
+
+		// every directory change we make is followed by a manifest write, so an older manifest missed something
+		std::error_code error;
+		auto manifest = GetManifestPath();
+		auto manifestTime = std::filesystem::last_write_time(manifest, error);
+		bool valid = !error;
+		if (valid) {
+			auto locationTime = std::filesystem::last_write_time(mLocation, error);
+			valid = !error && manifestTime >= locationTime;
+		}
+
+		if (valid) {
+			std::ifstream in(manifest, std::ios::binary);
+			std::string line;
+			valid = std::getline(in, line) && line == kManifestHeader;
+			while (valid && std::getline(in, line)) {
+				if (in.eof()) {
+					// an append that didn't finish
+					valid = false;
+				}
+				else if (line.size() > 1 && line[0] == '+') {
+					mBlocks.emplace(line.substr(1));
+				}
+				else if (line.size() > 1 && line[0] == '-') {
+					mBlocks.erase(line.substr(1));
+				}
+				else {
+					valid = false;
+				}
+				mManifestLines++;
+			}
+		}
+
+		if (!valid) {
+			LOG(LogInfo) << "Rebuilding cache manifest of " << mLocation.string();
+			RebuildManifest();
+		}
+		else if (mManifestLines > 2 * mBlocks.size() + 64) {
+			WriteManifest();
+		}
+	}
+
+	void FileCacheProvider::RebuildManifest() {
+		mBlocks.clear();
+
+		std::error_code error;
+		auto it = std::filesystem::recursive_directory_iterator(mLocation, std::filesystem::directory_options::skip_permission_denied, error);
+		auto end = std::filesystem::end(it);
+		for (; it != end; it.increment(error)) {
+			if (error) {
+				error.clear();
+				continue;
+			}
+			if (!it->is_regular_file(error) || it->path().extension() != mExtension) {
+				continue;
+			}
+			auto name = std::filesystem::relative(it->path(), mLocation, error).generic_string();
+			if (error || name.size() <= mExtension.size()) {
+				continue;
+			}
+			mBlocks.emplace(name.substr(0, name.size() - mExtension.size()));
+		}
+
+		if (std::filesystem::exists(mLocation, error)) {
+			WriteManifest();
+		}
+	}
+
+	void FileCacheProvider::WriteManifest() {
+		mManifestJournal.close();
+
+		auto manifest = GetManifestPath();
+		auto temp = manifest;
+		temp += ".tmp";
+		{
+			std::ofstream out(temp, std::ios::binary | std::ios::trunc);
+			out << kManifestHeader << "\n";
+			for (auto& name : mBlocks) {
+				out << '+' << name << "\n";
+			}
+			if (!out.good()) {
+				LOG(LogWarning) << "Failed to write cache manifest " << temp.string();
+				return;
+			}
+		}
+		std::error_code error;
+		std::filesystem::rename(temp, manifest, error);
+		if (error) {
+			LOG(LogWarning) << "Failed to replace cache manifest " << manifest.string() << ": " << error.message();
+			return;
+		}
+		// the rename changed the directory after the manifest was written
+		TouchManifest();
+		mManifestLines = mBlocks.size();
+	}
+
+	void FileCacheProvider::AppendManifest(char op, std::string_view path) {
+		if (!mManifestJournal.is_open()) {
+			auto manifest = GetManifestPath();
+			if (!std::filesystem::exists(manifest)) {
+				// the first block is journaled before its file creates the location
+				std::error_code error;
+				std::filesystem::create_directories(mLocation, error);
+				WriteManifest();
+				return;
+			}
+			mManifestJournal.open(manifest, std::ios::binary | std::ios::app);
+		}
+		mManifestJournal << op << path << "\n";
+		mManifestJournal.flush();
+		mManifestLines++;
+	}
+
+	void FileCacheProvider::TouchManifest() {
+		std::error_code error;
+		std::filesystem::last_write_time(GetManifestPath(), std::filesystem::file_time_type::clock::now(), error);
+	}
+
+	bool FileCacheProvider::OnBlockPersisting(std::string_view path) {
+		std::lock_guard<std::mutex> lock(mManifestMutex);
+		LoadManifest();
+		if (!mBlocks.emplace(path).second) {
+			return false;
+		}
+		AppendManifest('+', path);
+		return true;
+	}
+
+	void FileCacheProvider::OnBlockPersisted(bool directoryChanged) {
+		if (!directoryChanged) {
+			return;
+		}
+		// every file created so far was journaled before it, so the manifest covers the directory as it is now
+		std::lock_guard<std::mutex> lock(mManifestMutex);
+		TouchManifest();
+	}
+
+	void FileCacheProvider::OnBlockRemoved(std::string_view path) {
+		std::lock_guard<std::mutex> lock(mManifestMutex);
+		LoadManifest();
+		if (mBlocks.erase(std::string(path)) > 0) {
+			AppendManifest('-', path);
+		}
+	}
+
 }
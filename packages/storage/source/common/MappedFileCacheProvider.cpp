@@ -0,0 +1,173 @@
+#include <storage/MappedFileCacheProvider.h>
+#include <filesystem/File.h>
+
+#include <logging/LoggingAll.h>
+
+#include <atomic>
+
+#ifdef BSYSTEM_PLATFORM_Windows
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace l::filecache {
+
+#ifdef BSYSTEM_PLATFORM_Windows
+	bool MappedFile::Open(const std::filesystem::path& file, MappedFileAccess access) {
+		Close();
+
+		DWORD flags = FILE_ATTRIBUTE_NORMAL;
+		if (access == MappedFileAccess::Sequential) {
+			flags |= FILE_FLAG_SEQUENTIAL_SCAN;
+		}
+		else if (access == MappedFileAccess::Random) {
+			flags |= FILE_FLAG_RANDOM_ACCESS;
+		}
+
+		HANDLE handle = CreateFileW(file.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, flags, nullptr);
+		if (handle == INVALID_HANDLE_VALUE) {
+			return false;
+		}
+		LARGE_INTEGER size;
+		if (!GetFileSizeEx(handle, &size) || size.QuadPart <= 0) {
+			CloseHandle(handle);
+			return false;
+		}
+		// the view keeps the mapping alive, so both handles can be closed right away
+		HANDLE mapping = CreateFileMappingW(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+		CloseHandle(handle);
+		if (mapping == nullptr) {
+			return false;
+		}
+		void* data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+		CloseHandle(mapping);
+		if (data == nullptr) {
+			return false;
+		}
+
+		mData = static_cast<const unsigned char*>(data);
+		mSize = static_cast<size_t>(size.QuadPart);
+		return true;
+	}
+
+	void MappedFile::Close() {
+		if (mData != nullptr) {
+			UnmapViewOfFile(mData);
+			mData = nullptr;
+			mSize = 0;
+		}
+	}
+#else
+	bool MappedFile::Open(const std::filesystem::path& file, MappedFileAccess access) {
+		Close();
+
+		int fd = ::open(file.c_str(), O_RDONLY | O_CLOEXEC);
+		if (fd < 0) {
+			return false;
+		}
+		struct stat st;
+		if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+			::close(fd);
+			return false;
+		}
+		auto size = static_cast<size_t>(st.st_size);
+		// the mapping holds its own reference to the file
+		void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+		::close(fd);
+		if (data == MAP_FAILED) {
+			return false;
+		}
+
+		// hints only, failures are harmless
+		if (access == MappedFileAccess::Sequential) {
+			madvise(data, size, MADV_SEQUENTIAL);
+			madvise(data, size, MADV_WILLNEED);
+		}
+		else if (access == MappedFileAccess::Random) {
+			madvise(data, size, MADV_RANDOM);
+		}
+
+		mData = static_cast<const unsigned char*>(data);
+		mSize = size;
+		return true;
+	}
+
+	void MappedFile::Close() {
+		if (mData != nullptr) {
+			munmap(const_cast<unsigned char*>(mData), mSize);
+			mData = nullptr;
+			mSize = 0;
+		}
+	}
+#endif
+
+	bool MappedFileCacheProvider::PersistData(std::string_view path, const std::vector<unsigned char>& data) {
+		if (data.empty()) {
+			return false;
+		}
+		static std::atomic<uint32_t> sTempId = 0;
+		auto added = OnBlockPersisting(path);
+
+		auto file = mLocation / (std::string(path) + mExtension);
+		auto temp = file;
+		temp += ".tmp" + std::to_string(sTempId++);
+
+		l::filesystem::File f(temp);
+		f.modeBinary().modeWriteTrunc();
+		if (!f.open()) {
+			if (added) {
+				OnBlockRemoved(path);
+			}
+			return false;
+		}
+		f.write(data);
+		f.close();
+
+		std::error_code error;
+		std::filesystem::rename(temp, file, error);
+		if (error) {
+			LOG(LogWarning) << "Failed to replace " << file.string() << ": " << error.message();
+			std::filesystem::remove(temp, error);
+			if (added) {
+				OnBlockRemoved(path);
+			}
+			return false;
+		}
+		// the temp file and the rename changed the directory
+		OnBlockPersisted(true);
+		return true;
+	}
+
+	bool MappedFileCacheProvider::ProvideData(std::string_view path, std::vector<unsigned char>& data) {
+		auto mapping = Map(path);
+		if (!mapping) {
+			return false;
+		}
+		auto view = mapping->GetData();
+		data.assign(view.begin(), view.end());
+		return true;
+	}
+
+	bool MappedFileCacheProvider::ProvideView(std::string_view path, CacheDataView& view) {
+		auto mapping = Map(path);
+		if (!mapping) {
+			return false;
+		}
+		view.mData = mapping->GetData();
+		view.mHolder = std::move(mapping);
+		return true;
+	}
+
+	std::shared_ptr<MappedFile> MappedFileCacheProvider::Map(std::string_view path) {
+		auto mapping = std::make_shared<MappedFile>();
+		if (!mapping->Open(mLocation / (std::string(path) + mExtension), mAccess)) {
+			return nullptr;
+		}
+		return mapping;
+	}
+
+}
@@ -0,0 +1,574 @@
+#include <storage/PackFileCacheProvider.h>
+
+#include <logging/LoggingAll.h>
+
+#include <algorithm>
+#include <cstdio>
+
+#ifdef BSYSTEM_PLATFORM_Windows
+#include <Windows.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+namespace {
+	const uint32_t kRecordMagic = 0x4b434150; // "PACK"
+	const std::string_view kSegmentPrefix = "segment_";
+
+	// Followed by the block name and the data, a record without data removes the block
+	struct RecordHeader {
+		uint32_t mMagic = kRecordMagic;
+		uint32_t mPathSize = 0;
+		uint64_t mDataSize = 0;
+	};
+	static_assert(sizeof(RecordHeader) == 16);
+}
+
+namespace l::filecache {
+
+#ifdef BSYSTEM_PLATFORM_Windows
+	bool PackSegmentReader::Open(const std::filesystem::path& file) {
+		Close();
+		// delete sharing lets compaction remove the file while a read is still in flight
+		HANDLE handle = CreateFileW(file.wstring().c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_FLAG_RANDOM_ACCESS, nullptr);
+		if (handle == INVALID_HANDLE_VALUE) {
+			return false;
+		}
+		mHandle = handle;
+		return true;
+	}
+
+	void PackSegmentReader::Close() {
+		if (mHandle != nullptr) {
+			CloseHandle(mHandle);
+			mHandle = nullptr;
+		}
+	}
+
+	bool PackSegmentReader::Read(uint64_t offset, unsigned char* dst, size_t size) const {
+		while (size > 0) {
+			OVERLAPPED overlapped{};
+			overlapped.Offset = static_cast<DWORD>(offset);
+			overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+			DWORD count = size < 0x40000000 ? static_cast<DWORD>(size) : 0x40000000;
+			DWORD read = 0;
+			if (!ReadFile(mHandle, dst, count, &read, &overlapped) || read == 0) {
+				return false;
+			}
+			offset += read;
+			dst += read;
+			size -= read;
+		}
+		return true;
+	}
+
+	bool PackSegmentWriter::Open(const std::filesystem::path& file) {
+		Close();
+		HANDLE handle = CreateFileW(file.wstring().c_str(), GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr, OPEN_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+		if (handle == INVALID_HANDLE_VALUE) {
+			return false;
+		}
+		mHandle = handle;
+		return true;
+	}
+
+	void PackSegmentWriter::Close() {
+		if (mHandle != nullptr) {
+			CloseHandle(mHandle);
+			mHandle = nullptr;
+		}
+	}
+
+	bool PackSegmentWriter::Write(uint64_t offset, const void* src, size_t size) {
+		auto bytes = static_cast<const unsigned char*>(src);
+		while (size > 0) {
+			OVERLAPPED overlapped{};
+			overlapped.Offset = static_cast<DWORD>(offset);
+			overlapped.OffsetHigh = static_cast<DWORD>(offset >> 32);
+			DWORD count = size < 0x40000000 ? static_cast<DWORD>(size) : 0x40000000;
+			DWORD written = 0;
+			if (!WriteFile(mHandle, bytes, count, &written, &overlapped) || written == 0) {
+				return false;
+			}
+			offset += written;
+			bytes += written;
+			size -= written;
+		}
+		return true;
+	}
+
+	bool PackSegmentWriter::Truncate(uint64_t size) {
+		FILE_END_OF_FILE_INFO info{};
+		info.EndOfFile.QuadPart = static_cast<LONGLONG>(size);
+		return SetFileInformationByHandle(mHandle, FileEndOfFileInfo, &info, sizeof(info)) != 0;
+	}
+
+	bool PackSegmentWriter::Sync() {
+		return FlushFileBuffers(mHandle) != 0;
+	}
+
+	uint64_t PackSegmentWriter::Size() const {
+		LARGE_INTEGER size{};
+		if (!GetFileSizeEx(mHandle, &size)) {
+			return 0;
+		}
+		return static_cast<uint64_t>(size.QuadPart);
+	}
+#else
+	bool PackSegmentReader::Open(const std::filesystem::path& file) {
+		Close();
+		mFd = ::open(file.c_str(), O_RDONLY | O_CLOEXEC);
+		return mFd >= 0;
+	}
+
+	void PackSegmentReader::Close() {
+		if (mFd >= 0) {
+			::close(mFd);
+			mFd = -1;
+		}
+	}
+
+	bool PackSegmentReader::Read(uint64_t offset, unsigned char* dst, size_t size) const {
+		while (size > 0) {
+			auto count = pread(mFd, dst, size, static_cast<off_t>(offset));
+			if (count <= 0) {
+				return false;
+			}
+			offset += static_cast<uint64_t>(count);
+			dst += count;
+			size -= static_cast<size_t>(count);
+		}
+		return true;
+	}
+
+	bool PackSegmentWriter::Open(const std::filesystem::path& file) {
+		Close();
+		mFd = ::open(file.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+		return mFd >= 0;
+	}
+
+	void PackSegmentWriter::Close() {
+		if (mFd >= 0) {
+			::close(mFd);
+			mFd = -1;
+		}
+	}
+
+	bool PackSegmentWriter::Write(uint64_t offset, const void* src, size_t size) {
+		auto bytes = static_cast<const unsigned char*>(src);
+		while (size > 0) {
+			auto count = pwrite(mFd, bytes, size, static_cast<off_t>(offset));
+			if (count <= 0) {
+				return false;
+			}
+			offset += static_cast<uint64_t>(count);
+			bytes += count;
+			size -= static_cast<size_t>(count);
+		}
+		return true;
+	}
+
+	bool PackSegmentWriter::Truncate(uint64_t size) {
+		return ftruncate(mFd, static_cast<off_t>(size)) == 0;
+	}
+
+	bool PackSegmentWriter::Sync() {
+		return fsync(mFd) == 0;
+	}
+
+	uint64_t PackSegmentWriter::Size() const {
+		struct stat status;
+		if (fstat(mFd, &status) != 0) {
+			return 0;
+		}
+		return static_cast<uint64_t>(status.st_size);
+	}
+#endif
+
+	PackFileCacheProvider::PackFileCacheProvider(std::string_view location, std::string_view extension, uint64_t maxSegmentSize) :
+		mLocation(location),
+		mExtension(extension),
+		mMaxSegmentSize(maxSegmentSize)
+	{
+		std::error_code error;
+		std::filesystem::create_directories(mLocation, error);
+
+		std::vector<uint32_t> ids;
+		for (auto& entry : std::filesystem::directory_iterator(mLocation, error)) {
+			auto name = entry.path().filename().string();
+			if (!entry.is_regular_file() || entry.path().extension() != mExtension || !name.starts_with(kSegmentPrefix)) {
+				continue;
+			}
+			auto id = std::atoi(name.c_str() + kSegmentPrefix.size());
+			if (id > 0) {
+				ids.push_back(static_cast<uint32_t>(id));
+			}
+		}
+		std::sort(ids.begin(), ids.end());
+
+		std::lock_guard<std::mutex> lock(mMutex);
+		for (auto id : ids) {
+			ScanSegment(id);
+		}
+		mActiveSegment = ids.empty() ? 1 : ids.back();
+		if (ids.empty()) {
+			OpenSegment(mActiveSegment);
+		}
+	}
+
+	PackFileCacheProvider::~PackFileCacheProvider() {
+		std::unique_lock<std::mutex> lock(mCompactionState->mMutex);
+		mCompactionState->mAlive = false;
+		mCompactionState->mCondition.wait(lock, [&]() {
+			return mCompactionState->mRunning == 0;
+			});
+	}
+
+	bool PackFileCacheProvider::PersistData(std::string_view path, const std::vector<unsigned char>& data) {
+		if (data.empty()) {
+			return false;
+		}
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			if (!AppendRecord(path, data.data(), data.size())) {
+				return false;
+			}
+		}
+		QueueCompaction();
+		return true;
+	}
+
+	// Only the index lookup is locked, the read itself runs in parallel with other reads and writes
+	bool PackFileCacheProvider::ProvideData(std::string_view path, std::vector<unsigned char>& data) {
+		Entry entry;
+		std::shared_ptr<PackSegmentReader> reader;
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			auto it = mIndex.find(std::string(path));
+			if (it == mIndex.end()) {
+				return false;
+			}
+			entry = it->second;
+			reader = GetReader(entry.mSegment);
+		}
+		if (reader == nullptr) {
+			return false;
+		}
+		data.resize(entry.mSize);
+		return reader->Read(entry.mOffset, data.data(), data.size());
+	}
+
+	bool PackFileCacheProvider::RemoveData(std::string_view path) {
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			if (!mIndex.contains(std::string(path)) || !AppendRecord(path, nullptr, 0)) {
+				return false;
+			}
+		}
+		QueueCompaction();
+		return true;
+	}
+
+	bool PackFileCacheProvider::HasData(std::string_view path) {
+		std::lock_guard<std::mutex> lock(mMutex);
+		return mIndex.contains(std::string(path));
+	}
+
+	size_t PackFileCacheProvider::GetBlockCount() {
+		std::lock_guard<std::mutex> lock(mMutex);
+		return mIndex.size();
+	}
+
+	size_t PackFileCacheProvider::GetSegmentCount() {
+		std::lock_guard<std::mutex> lock(mMutex);
+		return mSegments.size();
+	}
+
+	uint64_t PackFileCacheProvider::GetTotalBytes() {
+		std::lock_guard<std::mutex> lock(mMutex);
+		uint64_t total = 0;
+		for (auto& it : mSegments) {
+			total += it.second.mSize;
+		}
+		return total;
+	}
+
+	uint64_t PackFileCacheProvider::GetDeadBytes() {
+		std::lock_guard<std::mutex> lock(mMutex);
+		uint64_t dead = 0;
+		for (auto& it : mSegments) {
+			dead += it.second.mSize - it.second.mLiveBytes;
+		}
+		return dead;
+	}
+
+	size_t PackFileCacheProvider::Compact(float deadRatio) {
+		std::vector<uint32_t> candidates;
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			for (auto& [id, segment] : mSegments) {
+				if (id != mActiveSegment && segment.mSize > 0 && (segment.mSize - segment.mLiveBytes) >= deadRatio * segment.mSize) {
+					candidates.push_back(id);
+				}
+			}
+		}
+
+		size_t removed = 0;
+		for (auto id : candidates) {
+			if (CompactSegment(id)) {
+				removed++;
+			}
+		}
+		return removed;
+	}
+
+	void PackFileCacheProvider::SetBackgroundCompaction(l::concurrency::ExecutorService* executor, float deadRatio) {
+		std::lock_guard<std::mutex> lock(mMutex);
+		mCompactionExecutor = executor;
+		mCompactionRatio = deadRatio;
+	}
+
+	std::filesystem::path PackFileCacheProvider::GetSegmentPath(uint32_t id) {
+		char name[32];
+		std::snprintf(name, sizeof(name), "%06u", id);
+		return mLocation / (std::string(kSegmentPrefix) + name + mExtension);
+	}
+
+	PackFileCacheProvider::Segment* PackFileCacheProvider::OpenSegment(uint32_t id) {
+		auto path = GetSegmentPath(id);
+		auto& segment = mSegments[id];
+		if (!segment.mWriter.Open(path)) {
+			LOG(LogError) << "Failed to open segment " << path.string();
+			mSegments.erase(id);
+			return nullptr;
+		}
+		auto reader = std::make_shared<PackSegmentReader>();
+		if (!reader->Open(path)) {
+			LOG(LogError) << "Failed to open segment " << path.string() << " for reading";
+			mSegments.erase(id);
+			return nullptr;
+		}
+		segment.mReader = std::move(reader);
+		return &segment;
+	}
+
+	void PackFileCacheProvider::ScanSegment(uint32_t id) {
+		auto segment = OpenSegment(id);
+		if (segment == nullptr) {
+			return;
+		}
+		auto size = segment->mWriter.Size();
+
+		uint64_t offset = 0;
+		std::string path;
+		while (offset + sizeof(RecordHeader) <= size) {
+			RecordHeader header;
+			if (!segment->mReader->Read(offset, reinterpret_cast<unsigned char*>(&header), sizeof(header))) {
+				break;
+			}
+			auto recordSize = sizeof(header) + header.mPathSize + header.mDataSize;
+			if (header.mMagic != kRecordMagic || offset + recordSize > size) {
+				break;
+			}
+			path.resize(header.mPathSize);
+			if (!path.empty() && !segment->mReader->Read(offset + sizeof(header), reinterpret_cast<unsigned char*>(path.data()), path.size())) {
+				break;
+			}
+			ApplyRecord(id, offset, path, header.mDataSize);
+			offset += recordSize;
+		}
+		segment->mSize = offset;
+
+		if (offset < size) {
+			// a write that didn't finish, appends continue after the last complete record
+			LOG(LogWarning) << "Truncating " << (size - offset) << " bytes of segment " << GetSegmentPath(id).string();
+			segment->mWriter.Truncate(offset);
+		}
+	}
+
+	bool PackFileCacheProvider::AppendRecord(std::string_view path, const unsigned char* data, uint64_t size) {
+		auto recordSize = sizeof(RecordHeader) + path.size() + size;
+		auto it = mSegments.find(mActiveSegment);
+		if (it == mSegments.end() || (it->second.mSize > 0 && it->second.mSize + recordSize > mMaxSegmentSize)) {
+			// seal the active segment and continue in a new one
+			if (it != mSegments.end()) {
+				mActiveSegment++;
+			}
+			if (OpenSegment(mActiveSegment) == nullptr) {
+				return false;
+			}
+			it = mSegments.find(mActiveSegment);
+		}
+		auto& segment = it->second;
+
+		RecordHeader header;
+		header.mPathSize = static_cast<uint32_t>(path.size());
+		header.mDataSize = size;
+
+		auto offset = segment.mSize;
+		auto dataOffset = offset + sizeof(header) + path.size();
+		if (!segment.mWriter.Write(offset, &header, sizeof(header)) ||
+			!segment.mWriter.Write(offset + sizeof(header), path.data(), path.size()) ||
+			!segment.mWriter.Write(dataOffset, data, size)) {
+			// drop the partial record, the next append starts at the same offset
+			LOG(LogError) << "Failed to write " << path << " to segment " << GetSegmentPath(mActiveSegment).string();
+			segment.mWriter.Truncate(offset);
+			return false;
+		}
+		segment.mSize += recordSize;
+
+		ApplyRecord(mActiveSegment, offset, std::string(path), size);
+		return true;
+	}
+
+	void PackFileCacheProvider::ApplyRecord(uint32_t segmentId, uint64_t offset, const std::string& path, uint64_t size) {
+		auto it = mIndex.find(path);
+		if (it != mIndex.end()) {
+			mSegments[it->second.mSegment].mLiveBytes -= it->second.mRecordSize;
+		}
+
+		if (size == 0) {
+			if (it != mIndex.end()) {
+				mIndex.erase(it);
+			}
+			mTombstones[path] = segmentId;
+			return;
+		}
+
+		Entry entry;
+		entry.mSegment = segmentId;
+		entry.mOffset = offset + sizeof(RecordHeader) + path.size();
+		entry.mSize = size;
+		entry.mRecordSize = sizeof(RecordHeader) + path.size() + size;
+		mIndex[path] = entry;
+		mSegments[segmentId].mLiveBytes += entry.mRecordSize;
+		mTombstones.erase(path);
+	}
+
+	std::shared_ptr<PackSegmentReader> PackFileCacheProvider::GetReader(uint32_t id) {
+		auto it = mSegments.find(id);
+		if (it == mSegments.end()) {
+			return nullptr;
+		}
+		return it->second.mReader;
+	}
+
+	bool PackFileCacheProvider::NeedsCompaction(float deadRatio) {
+		for (auto& [id, segment] : mSegments) {
+			if (id != mActiveSegment && segment.mSize > 0 && (segment.mSize - segment.mLiveBytes) >= deadRatio * segment.mSize) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	bool PackFileCacheProvider::CompactSegment(uint32_t id) {
+		std::vector<std::string> live;
+		std::vector<std::string> removals;
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			for (auto& [path, entry] : mIndex) {
+				if (entry.mSegment == id) {
+					live.push_back(path);
+				}
+			}
+			for (auto& [path, segment] : mTombstones) {
+				if (segment == id) {
+					removals.push_back(path);
+				}
+			}
+		}
+
+		// the lock is taken per record so readers and writers get in between, blocks written meanwhile are skipped
+		std::vector<unsigned char> data;
+		for (auto& path : live) {
+			std::lock_guard<std::mutex> lock(mMutex);
+			auto it = mIndex.find(path);
+			if (it == mIndex.end() || it->second.mSegment != id) {
+				continue;
+			}
+			auto reader = GetReader(id);
+			data.resize(it->second.mSize);
+			if (reader == nullptr || !reader->Read(it->second.mOffset, data.data(), data.size()) || !AppendRecord(path, data.data(), data.size())) {
+				LOG(LogWarning) << "Failed to move " << path << " out of segment " << id;
+				return false;
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(mMutex);
+		// a removal only has to be kept while an older segment can still hold the block
+		bool hasOlder = mSegments.begin()->first < id;
+		for (auto& path : removals) {
+			auto it = mTombstones.find(path);
+			if (it == mTombstones.end() || it->second != id) {
+				continue;
+			}
+			if (hasOlder && !AppendRecord(path, nullptr, 0)) {
+				return false;
+			}
+			else {
+				mTombstones.erase(it);
+			}
+		}
+
+		auto it = mSegments.find(id);
+		if (it == mSegments.end() || it->second.mLiveBytes > 0) {
+			return false;
+		}
+		// the moved records went to newer segments and have to be on the disk before the old copies are deleted
+		for (auto next = std::next(it); next != mSegments.end(); ++next) {
+			if (!next->second.mWriter.Sync()) {
+				LOG(LogWarning) << "Failed to sync segment " << next->first << ", keeping segment " << id;
+				return false;
+			}
+		}
+		mSegments.erase(it);
+		std::error_code error;
+		std::filesystem::remove(GetSegmentPath(id), error);
+		return !error;
+	}
+
+	void PackFileCacheProvider::QueueCompaction() {
+		l::concurrency::ExecutorService* executor = nullptr;
+		float deadRatio = 0.0f;
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			if (mCompactionExecutor == nullptr || !NeedsCompaction(mCompactionRatio)) {
+				return;
+			}
+			executor = mCompactionExecutor;
+			deadRatio = mCompactionRatio;
+		}
+		{
+			std::lock_guard<std::mutex> lock(mCompactionState->mMutex);
+			if (mCompactionState->mQueued) {
+				return;
+			}
+			mCompactionState->mQueued = true;
+		}
+		auto queued = executor->queueJob("pack compaction", [state = mCompactionState, this, deadRatio](const l::concurrency::RunState&) {
+			{
+				std::lock_guard<std::mutex> lock(state->mMutex);
+				state->mQueued = false;
+				if (!state->mAlive) {
+					return l::concurrency::RunnableResult::CANCELLED;
+				}
+				state->mRunning++;
+			}
+			Compact(deadRatio);
+			{
+				std::lock_guard<std::mutex> lock(state->mMutex);
+				state->mRunning--;
+			}
+			state->mCondition.notify_all();
+			return l::concurrency::RunnableResult::SUCCESS;
+			});
+		if (!queued) {
+			std::lock_guard<std::mutex> lock(mCompactionState->mMutex);
+			mCompactionState->mQueued = false;
+		}
+	}
+
+}
@@ -3,6 +3,43 @@
 
 namespace l::filecache {
 
+	void CacheMemoryBudget::SetLimit(size_t bytes) {
+		mLimit = bytes;
+	}
+
+	size_t CacheMemoryBudget::GetLimit() const {
+		return mLimit;
+	}
+
+	size_t CacheMemoryBudget::GetUsage() const {
+		return mUsage;
+	}
+
+	bool CacheMemoryBudget::IsExceeded() const {
+		auto limit = mLimit.load();
+		return limit > 0 && mUsage > limit;
+	}
+
+	size_t CacheMemoryBudget::GetExcess() const {
+		auto limit = mLimit.load();
+		auto usage = mUsage.load();
+		return limit > 0 && usage > limit ? usage - limit : 0;
+	}
+
+	void CacheMemoryBudget::Add(size_t bytes) {
+		mUsage += bytes;
+		if (mParent != nullptr) {
+			mParent->Add(bytes);
+		}
+	}
+
+	void CacheMemoryBudget::Release(size_t bytes) {
+		mUsage -= bytes;
+		if (mParent != nullptr) {
+			mParent->Release(bytes);
+		}
+	}
+
 	int32_t GetClampedPosition(int32_t position, int32_t blockWidth) {
 		return blockWidth * (position / blockWidth);
 	}
@@ -0,0 +1,118 @@
+#include "testing/Test.h"
+
+#include "storage/FileCacheProvider.h"
+#include "storage/MappedFileCacheProvider.h"
+
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <thread>
+
+namespace {
+	std::set<std::pair<int32_t, int32_t>> Scan(l::filecache::FileCacheProvider& provider, std::string_view cacheKey) {
+		std::set<std::pair<int32_t, int32_t>> blocks;
+		provider.ScanLocation(cacheKey, [&](int32_t position, int32_t blockWidth) {
+			blocks.emplace(position, blockWidth);
+			});
+		return blocks;
+	}
+
+	void Append(const std::filesystem::path& file, std::string_view text) {
+		std::ofstream out(file, std::ios::binary | std::ios::app);
+		out << text;
+	}
+}
+
+TEST(FileCacheProvider, Manifest) {
+	std::filesystem::remove_all("tests/manifest");
+	std::vector<unsigned char> data = { 1, 2, 3 };
+	auto manifest = std::filesystem::path("tests/manifest/cache.blk.manifest");
+	using Blocks = std::set<std::pair<int32_t, int32_t>>;
+	{
+		l::filecache::FileCacheProvider provider("tests/manifest", ".blk");
+		TEST_TRUE(Scan(provider, "BTC").empty(), "");
+		TEST_TRUE(provider.PersistData("BTC_10_0", data), "");
+		TEST_TRUE(provider.PersistData("BTC_10_10", data), "");
+		TEST_TRUE(provider.PersistData("BTC_10_-10", data), "");
+		TEST_TRUE(provider.PersistData("BTC_10_0", data), "");
+		TEST_TRUE(provider.PersistData("BTC_USDT_10_0", data), "");
+		TEST_TRUE(provider.RemoveData("BTC_10_10"), "");
+		TEST_FALSE(provider.RemoveData("BTC_10_10"), "");
+		TEST_TRUE(Scan(provider, "BTC") == Blocks({ { -10, 10 }, { 0, 10 } }), "");
+		TEST_TRUE(std::filesystem::exists(manifest), "");
+
+		// the full scan agrees
+		Blocks scanned;
+		provider.ScanLocation("tests/manifest", ".blk", "BTC", [&](int32_t position, int32_t blockWidth) {
+			scanned.emplace(position, blockWidth);
+			});
+		TEST_TRUE(scanned == Scan(provider, "BTC"), "");
+	}
+
+	// an up to date manifest is trusted without scanning
+	Append(manifest, "+BTC_10_990\n");
+	{
+		l::filecache::FileCacheProvider provider("tests/manifest", ".blk");
+		TEST_TRUE(Scan(provider, "BTC") == Blocks({ { -10, 10 }, { 0, 10 }, { 990, 10 } }), "");
+		TEST_TRUE(Scan(provider, "BTC_USDT") == Blocks({ { 0, 10 } }), "");
+	}
+
+	// files added behind its back make it stale
+	std::this_thread::sleep_for(std::chrono::milliseconds(20));
+	Append("tests/manifest/BTC_10_20.blk", "x");
+	{
+		l::filecache::FileCacheProvider provider("tests/manifest", ".blk");
+		TEST_TRUE(Scan(provider, "BTC") == Blocks({ { -10, 10 }, { 0, 10 }, { 20, 10 } }), "");
+	}
+
+	// so does an append that didn't finish
+	Append(manifest, "+BTC_10_5");
+	{
+		l::filecache::FileCacheProvider provider("tests/manifest", ".blk");
+		TEST_TRUE(Scan(provider, "BTC") == Blocks({ { -10, 10 }, { 0, 10 }, { 20, 10 } }), "");
+	}
+
+	// replacing files through a rename keeps the manifest valid
+	{
+		l::filecache::MappedFileCacheProvider provider("tests/manifest", ".blk");
+		TEST_TRUE(provider.PersistData("BTC_10_0", data), "");
+		TEST_TRUE(provider.PersistData("BTC_10_30", data), "");
+	}
+	Append(manifest, "+BTC_10_990\n");
+	{
+		l::filecache::FileCacheProvider provider("tests/manifest", ".blk");
+		TEST_TRUE(Scan(provider, "BTC") == Blocks({ { -10, 10 }, { 0, 10 }, { 20, 10 }, { 30, 10 }, { 990, 10 } }), "");
+	}
+	return 0;
+}
+
+namespace {
+	// Runs the journal step of a persist on its own, the test creates the file
+	class JournalingFileCacheProvider : public l::filecache::FileCacheProvider {
+	public:
+		using l::filecache::FileCacheProvider::FileCacheProvider;
+
+		bool Journal(std::string_view path) {
+			return OnBlockPersisting(path);
+		}
+	};
+}
+
+TEST(FileCacheProvider, ManifestConcurrentPersists) {
+	std::filesystem::remove_all("tests/manifestrace");
+	std::vector<unsigned char> data = { 1, 2, 3 };
+	using Blocks = std::set<std::pair<int32_t, int32_t>>;
+	{
+		JournalingFileCacheProvider provider("tests/manifestrace", ".blk");
+		TEST_TRUE(provider.PersistData("BTC_10_0", data), "");
+
+		// a persist has created its file when another one finishes, then the process dies before the first one is done
+		TEST_TRUE(provider.Journal("BTC_10_10"), "");
+		Append("tests/manifestrace/BTC_10_10.blk", "x");
+		TEST_TRUE(provider.PersistData("BTC_10_20", data), "");
+		TEST_FALSE(provider.Journal("BTC_10_20"), "");
+	}
+	l::filecache::FileCacheProvider provider("tests/manifestrace", ".blk");
+	TEST_TRUE(Scan(provider, "BTC") == Blocks({ { 0, 10 }, { 10, 10 }, { 20, 10 } }), "The unfinished persist's file is listed");
+	return 0;
+}
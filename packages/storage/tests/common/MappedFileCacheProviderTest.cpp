@@ -0,0 +1,85 @@
+#include "testing/Test.h"
+
+#include "storage/MappedFileCacheProvider.h"
+#include "storage/SequentialCache.h"
+#include "various/serializer/Serializer.h"
+
+#include <memory>
+#include <filesystem>
+
+namespace {
+	class Prices {
+	public:
+		Prices() = default;
+		Prices(int32_t size) : mValues(static_cast<size_t>(size)) {};
+		~Prices() = default;
+
+		friend zpp::serializer::access;
+		template <typename Archive, typename Self>
+		static void serialize(Archive& archive, Self& self) {
+			archive(self.mValues);
+		}
+
+		std::vector<double> mValues;
+	};
+}
+
+TEST(MappedFileCacheProvider, MappedFile) {
+	l::filecache::MappedFileCacheProvider provider("tests/mapped", ".test");
+	std::vector<unsigned char> data = { 1, 2, 3, 4, 5 };
+	TEST_TRUE(provider.PersistData("raw", data), "");
+
+	auto mapping = provider.Map("raw");
+	TEST_TRUE(mapping != nullptr && mapping->IsOpen(), "");
+	TEST_EQ(mapping->GetData().size(), 5u, "");
+	TEST_EQ(mapping->GetData()[4], 5, "");
+
+	// replacing the file leaves open mappings alone
+	std::vector<unsigned char> data2 = { 9, 8, 7 };
+	TEST_TRUE(provider.PersistData("raw", data2), "");
+	TEST_EQ(mapping->GetData().size(), 5u, "");
+	TEST_EQ(mapping->GetData()[0], 1, "");
+
+	std::vector<unsigned char> out;
+	TEST_TRUE(provider.ProvideData("raw", out), "");
+	TEST_TRUE(out == data2, "");
+
+	l::filecache::CacheDataView view;
+	TEST_TRUE(provider.ProvideView("raw", view), "");
+	TEST_EQ(view.mData.size(), 3u, "");
+	TEST_TRUE(view.mHolder != nullptr, "");
+
+	TEST_FALSE(provider.ProvideView("missing", view), "");
+	TEST_TRUE(provider.Map("missing") == nullptr, "");
+	TEST_FALSE(provider.PersistData("empty", {}), "");
+
+	mapping->Close();
+	TEST_FALSE(mapping->IsOpen(), "");
+	TEST_TRUE(mapping->GetData().empty(), "");
+	return 0;
+}
+
+TEST(MappedFileCacheProvider, SequentialCache) {
+	l::filecache::MappedFileCacheProvider provider("tests/mapped", ".test", l::filecache::MappedFileAccess::Random);
+	{
+		l::filecache::SequentialCacheStore<Prices> store(&provider);
+		for (int32_t i = 0; i < 8; i++) {
+			auto block = store.Get("Prices", i * 100, 100, true);
+			block->AllocateBlockData(100);
+			block->Get()->mValues[99] = i * 0.5;
+			TEST_TRUE(block->PersistData(), "");
+		}
+	}
+
+	l::filecache::SequentialCacheStore<Prices> store(&provider);
+	int32_t count = 0;
+	store.ForEach("Prices", 0, 799, 100, [&](int32_t position, int32_t, l::filecache::CacheBlock<Prices>* cacheBlock) {
+		auto data = cacheBlock->Read();
+		TEST_TRUE_NO_RET(data.valid() && data->mValues.size() == 100, "");
+		TEST_TRUE_NO_RET(data->mValues[99] == (position / 100) * 0.5, "");
+		count++;
+		return true;
+		});
+	TEST_EQ(count, 8, "");
+	return 0;
+}
@@ -0,0 +1,191 @@
+#include "testing/Test.h"
+
+#include "storage/PackFileCacheProvider.h"
+#include "storage/SequentialCache.h"
+#include "various/serializer/Serializer.h"
+
+#include <memory>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+#include <atomic>
+
+namespace {
+	std::vector<unsigned char> MakeBlock(int32_t value, size_t size) {
+		std::vector<unsigned char> data(size);
+		for (size_t i = 0; i < size; i++) {
+			data[i] = static_cast<unsigned char>(value + i);
+		}
+		return data;
+	}
+
+	class Values {
+	public:
+		Values() = default;
+		Values(int32_t size) : mValues(static_cast<size_t>(size)) {};
+
+		friend zpp::serializer::access;
+		template <typename Archive, typename Self>
+		static void serialize(Archive& archive, Self& self) {
+			archive(self.mValues);
+		}
+
+		std::vector<int32_t> mValues;
+	};
+
+	std::string BlockName(int32_t i) {
+		return l::filecache::GetCacheBlockName("BTC", 100, i * 100);
+	}
+}
+
+TEST(PackFileCacheProvider, PersistAndReopen) {
+	std::filesystem::remove_all("tests/pack");
+	{
+		l::filecache::PackFileCacheProvider provider("tests/pack", ".pack", 4096);
+		for (int32_t i = 0; i < 100; i++) {
+			TEST_TRUE(provider.PersistData(BlockName(i), MakeBlock(i, 200)), "");
+		}
+		for (int32_t i = 0; i < 100; i += 2) {
+			TEST_TRUE(provider.PersistData(BlockName(i), MakeBlock(i + 1, 300)), "");
+		}
+		for (int32_t i = 90; i < 100; i++) {
+			TEST_TRUE(provider.RemoveData(BlockName(i)), "");
+		}
+		TEST_FALSE(provider.RemoveData(BlockName(95)), "");
+		TEST_FALSE(provider.PersistData("empty", {}), "");
+		TEST_EQ(provider.GetBlockCount(), 90u, "");
+		TEST_TRUE(provider.GetSegmentCount() > 5, "");
+		TEST_TRUE(provider.GetDeadBytes() > 0, "");
+	}
+
+	// a torn write at the end is dropped on start
+	{
+		auto last = std::filesystem::path("tests/pack");
+		for (auto& entry : std::filesystem::directory_iterator("tests/pack")) {
+			last = std::max(last, entry.path());
+		}
+		std::ofstream out(last, std::ios::binary | std::ios::app);
+		out << "PACK but not quite";
+	}
+
+	l::filecache::PackFileCacheProvider provider("tests/pack", ".pack", 4096);
+	TEST_EQ(provider.GetBlockCount(), 90u, "");
+	std::vector<unsigned char> data;
+	for (int32_t i = 0; i < 100; i++) {
+		if (i >= 90) {
+			TEST_FALSE(provider.ProvideData(BlockName(i), data), "");
+			continue;
+		}
+		TEST_TRUE(provider.ProvideData(BlockName(i), data), "");
+		TEST_TRUE(data == (i % 2 == 0 ? MakeBlock(i + 1, 300) : MakeBlock(i, 200)), "");
+	}
+
+	auto segments = provider.GetSegmentCount();
+	auto dead = provider.GetDeadBytes();
+	TEST_TRUE(provider.Compact(0.3f) > 0, "");
+	TEST_TRUE(provider.GetSegmentCount() < segments, "");
+	TEST_TRUE(provider.GetDeadBytes() < dead, "");
+	TEST_TRUE(provider.PersistData(BlockName(0), MakeBlock(7, 50)), "");
+	TEST_EQ(provider.GetBlockCount(), 90u, "");
+
+	// removed blocks stay removed after their removal was compacted away
+	l::filecache::PackFileCacheProvider reopened("tests/pack", ".pack", 4096);
+	TEST_EQ(reopened.GetBlockCount(), 90u, "");
+	TEST_FALSE(reopened.HasData(BlockName(95)), "");
+	TEST_TRUE(reopened.ProvideData(BlockName(0), data), "");
+	TEST_TRUE(data == MakeBlock(7, 50), "");
+	TEST_TRUE(reopened.ProvideData(BlockName(89), data), "");
+	TEST_TRUE(data == MakeBlock(89, 200), "");
+	return 0;
+}
+
+#ifndef BSYSTEM_PLATFORM_Windows
+TEST(PackFileCacheProvider, FullDisk) {
+	// every write to /dev/full fails with ENOSPC
+	if (!std::filesystem::exists("/dev/full")) {
+		return 0;
+	}
+	std::filesystem::remove_all("tests/packfull");
+	std::filesystem::create_directories("tests/packfull");
+	std::filesystem::create_symlink("/dev/full", "tests/packfull/segment_000001.pack");
+
+	l::filecache::PackFileCacheProvider provider("tests/packfull", ".pack", 4096);
+	TEST_FALSE(provider.PersistData(BlockName(0), MakeBlock(0, 200)), "");
+	TEST_FALSE(provider.HasData(BlockName(0)), "A failed write is not indexed");
+	TEST_EQ(provider.GetTotalBytes(), 0u, "");
+	std::filesystem::remove_all("tests/packfull");
+	return 0;
+}
+#endif
+
+TEST(PackFileCacheProvider, ConcurrentReads) {
+	std::filesystem::remove_all("tests/packreads");
+	l::filecache::PackFileCacheProvider provider("tests/packreads", ".pack", 4096);
+	for (int32_t i = 0; i < 50; i++) {
+		TEST_TRUE(provider.PersistData(BlockName(i), MakeBlock(i, 200)), "");
+	}
+
+	// readers don't wait for each other and keep working while blocks are rewritten and segments compacted away
+	std::atomic<int32_t> failures = 0;
+	auto segments = provider.GetSegmentCount();
+	std::vector<std::thread> readers;
+	for (int32_t t = 0; t < 4; t++) {
+		readers.emplace_back([&, t]() {
+			std::vector<unsigned char> data;
+			for (int32_t n = 0; n < 500; n++) {
+				auto i = (n * 7 + t) % 50;
+				if (!provider.ProvideData(BlockName(i), data) || data != MakeBlock(i, 200)) {
+					failures++;
+				}
+			}
+			});
+	}
+	for (int32_t round = 0; round < 4; round++) {
+		for (int32_t i = 0; i < 50; i++) {
+			provider.PersistData(BlockName(i), MakeBlock(i, 200));
+		}
+		provider.Compact(0.5f);
+	}
+	for (auto& reader : readers) {
+		reader.join();
+	}
+	TEST_EQ(failures.load(), 0, "");
+	TEST_TRUE(provider.GetSegmentCount() < 4 * segments, "Rewritten segments are compacted");
+	TEST_EQ(provider.GetBlockCount(), 50u, "");
+	return 0;
+}
+
+TEST(PackFileCacheProvider, SequentialCache) {
+	std::filesystem::remove_all("tests/packcache");
+	l::filecache::PackFileCacheProvider provider("tests/packcache", ".pack", 16 * 1024);
+	l::concurrency::ExecutorService executor("compaction", 1);
+	executor.startJobs();
+	provider.SetBackgroundCompaction(&executor, 0.5f);
+
+	// rewriting the same blocks over and over leaves mostly dead segments for the background compaction
+	l::filecache::SequentialCacheStore<Values> store(&provider);
+	for (int32_t round = 0; round < 20; round++) {
+		for (int32_t i = 0; i < 10; i++) {
+			auto block = store.Get("ETH", i * 10, 10, true);
+			block->AllocateBlockData(100);
+			block->Get()->mValues[0] = round * 100 + i;
+			TEST_TRUE(block->PersistData(), "");
+		}
+	}
+	for (int32_t i = 0; i < 100 && executor.numCompletedJobs() < executor.numTotalJobs(); i++) {
+		std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	}
+	TEST_TRUE(provider.GetSegmentCount() < 6, "Dead segments should be compacted in the background");
+
+	l::filecache::SequentialCacheStore<Values> store2(&provider);
+	int32_t count = 0;
+	store2.ForEach("ETH", 0, 90, 10, [&](int32_t position, int32_t, l::filecache::CacheBlock<Values>* cacheBlock) {
+		auto data = cacheBlock->Read();
+		TEST_TRUE_NO_RET(data.valid() && data->mValues[0] == 1900 + position / 10, "");
+		count++;
+		return true;
+		});
+	TEST_EQ(count, 10, "");
+	executor.shutdown();
+	return 0;
+}
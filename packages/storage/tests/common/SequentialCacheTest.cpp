@@ -6,6 +6,9 @@
 
 #include <memory>
 #include <filesystem>
+#include <thread>
+#include <condition_variable>
+#include <stdexcept>
 
 
 class CacheBlock {
@@ -46,6 +49,13 @@ TEST(SequentialCacheStore, Setup) {
 
 		TEST_TRUE(block->HasData(), "");
 		TEST_TRUE(block->Get()->mValue == 1, "");
+
+		// probing unknown keys doesn't grow the symbol table
+		auto symbols = l::string::symbol_count();
+		TEST_FALSE(store.Has("Unknown key", 25), "");
+		TEST_EQ(store.GetBlockWidth("Unknown key"), 0, "");
+		TEST_TRUE(store.GetCache("Unknown key") == nullptr, "");
+		TEST_EQ(l::string::symbol_count(), symbols, "");
 	}
 	return 0;
 }
@@ -96,11 +106,537 @@ TEST(SequentialCacheStore, ForEach) {
 	return 0;
 }
 
+class Series {
+public:
+	Series() = default;
+	Series(int32_t size) : mValues(static_cast<size_t>(size)) {};
+	~Series() = default;
+
+	friend zpp::serializer::access;
+	template <typename Archive, typename Self>
+	static void serialize(Archive& archive, Self& self) {
+		archive(self.mValues);
+	}
+
+	size_t GetMemoryUsage() const {
+		return sizeof(*this) + mValues.capacity() * sizeof(float);
+	}
+
+	std::vector<float> mValues;
+};
+
+class MemoryCacheProvider : public l::filecache::ICacheProvider {
+public:
+	virtual bool PersistData(std::string_view path, const std::vector<unsigned char>& data) override {
+		std::lock_guard lock(mMutex);
+		mFiles[std::string(path)] = data;
+		mPersistCount++;
+		return true;
+	}
+	virtual bool ProvideData(std::string_view path, std::vector<unsigned char>& data) override {
+		std::lock_guard lock(mMutex);
+		auto it = mFiles.find(std::string(path));
+		if (it == mFiles.end()) {
+			return false;
+		}
+		data = it->second;
+		mProvideCount++;
+		return true;
+	}
+
+	std::mutex mMutex;
+	std::map<std::string, std::vector<unsigned char>> mFiles;
+	int32_t mPersistCount = 0;
+	int32_t mProvideCount = 0;
+};
+
+TEST(SequentialCacheStore, MemoryBudget) {
+	MemoryCacheProvider provider;
+	l::filecache::SequentialCacheStore<Series> store(&provider);
+	auto blockUsage = sizeof(Series) + 100 * sizeof(float);
+	store.SetMemoryBudget(10 * blockUsage);
+
+	for (int32_t i = 0; i < 50; i++) {
+		auto block = store.Get(i % 2 == 0 ? "BTC" : "ETH", i * 10, 10, true);
+		block->AllocateBlockData(100);
+		block->Get()->mValues[0] = static_cast<float>(i);
+		TEST_TRUE(store.GetMemoryUsage() <= 11 * blockUsage, "The budget should hold within a block");
+	}
+	// blocks growing after they were handed out are trimmed on the next access or budget change
+	store.SetMemoryBudget(10 * blockUsage);
+	TEST_TRUE(store.GetMemoryUsage() <= 10 * blockUsage, "");
+	TEST_TRUE(provider.mPersistCount >= 40, "Dirty blocks are persisted before they are dropped");
+
+	// evicted blocks reload on access
+	auto block = store.Get("BTC", 0, 10);
+	TEST_TRUE(block->IsEvicted(), "");
+	TEST_FALSE(block->IsDirty(), "");
+	TEST_EQ(block->Read()->mValues[0], 0.0f, "");
+	TEST_FALSE(block->IsDirty(), "Reading doesn't dirty a block");
+	TEST_EQ(store.Get("ETH", 410, 10)->Read()->mValues[0], 41.0f, "");
+
+	// pinned blocks stay
+	auto pinned = store.Get("ETH", 490, 10);
+	pinned->Pin();
+	store.SetMemoryBudget(1);
+	TEST_TRUE(pinned->HasData(), "");
+	TEST_EQ(store.GetMemoryUsage(), pinned->GetMemoryUsage(), "");
+	pinned->Unpin();
+	store.SetMemoryBudget(1);
+	TEST_EQ(store.GetMemoryUsage(), 0u, "");
+	TEST_EQ(pinned->Read()->mValues[0], 49.0f, "");
+
+	// blocks visited by ForEach are pinned for the callback and a per cache budget holds on its own
+	store.SetMemoryBudget(0);
+	store.SetCacheMemoryBudget(3 * blockUsage);
+	int32_t count = 0;
+	TEST_TRUE(store.ForEach("BTC", 0, 480, 10, [&](int32_t position, int32_t, l::filecache::CacheBlock<Series>* cacheBlock) {
+		TEST_TRUE_NO_RET(cacheBlock->IsPinned(), "");
+		TEST_TRUE_NO_RET(store.GetCache("BTC")->GetMemoryUsage() <= 4 * blockUsage, "");
+		auto data = cacheBlock->Read();
+		if (data.valid()) { // odd positions belong to ETH
+			TEST_TRUE_NO_RET(data->mValues[0] == static_cast<float>(position / 10), "");
+			count++;
+		}
+		return true;
+		}), "");
+	TEST_EQ(count, 25, "");
+	TEST_FALSE(store.GetCache("BTC")->Get(240)->IsPinned(), "");
+
+	// types without GetMemoryUsage are charged their archive size once persisted
+	l::filecache::CacheBlock<Data> dataBlock("Data_10_0", &provider, true);
+	dataBlock.AllocateBlockData();
+	auto allocated = dataBlock.GetMemoryUsage();
+	TEST_TRUE(dataBlock.PersistData(), "");
+	TEST_TRUE(dataBlock.GetMemoryUsage() > allocated, "");
+	return 0;
+}
+
+class SlowCacheProvider : public MemoryCacheProvider {
+public:
+	virtual bool ProvideData(std::string_view path, std::vector<unsigned char>& data) override {
+		std::this_thread::sleep_for(std::chrono::milliseconds(2));
+		return MemoryCacheProvider::ProvideData(path, data);
+	}
+};
+
+namespace {
+	void PersistSeries(l::filecache::ICacheProvider& provider, std::string_view cacheKey, int32_t numBlocks) {
+		l::filecache::SequentialCacheStore<Series> store(&provider);
+		for (int32_t i = 0; i < numBlocks; i++) {
+			auto block = store.Get(cacheKey, i * 10, 10, true);
+			block->AllocateBlockData(10);
+			block->Get()->mValues[0] = static_cast<float>(i);
+			block->PersistData();
+		}
+	}
+}
+
+TEST(SequentialCacheStore, Prefetch) {
+	SlowCacheProvider provider;
+	PersistSeries(provider, "BTC", 40);
+	PersistSeries(provider, "ETH", 40);
+
+	l::concurrency::ExecutorService executor("prefetch", 4);
+	executor.startJobs();
+	{
+		l::filecache::SequentialCacheStore<Series> store(&provider);
+		store.SetPrefetch(&executor, 4);
+
+		int32_t count = 0;
+		TEST_TRUE(store.ForEach("BTC", 0, 290, 10, [&](int32_t position, int32_t, l::filecache::CacheBlock<Series>* cacheBlock) {
+			auto data = cacheBlock->Read();
+			TEST_TRUE_NO_RET(data.valid() && data->mValues[0] == static_cast<float>(position / 10), "");
+			count++;
+			return true;
+			}), "");
+		TEST_EQ(count, 30, "");
+		TEST_EQ(provider.mProvideCount, 30, "Every block is loaded once, either ahead or by the iteration");
+		TEST_FALSE(store.Has("BTC", 300), "Read ahead stops at the end of the range");
+
+		count = 0;
+		TEST_TRUE(store.ForEach2("ETH", "BTC", 390, 200, 10, [&](int32_t position, int32_t, l::filecache::CacheBlock<Series>* block1, l::filecache::CacheBlock<Series>* block2) {
+			TEST_TRUE_NO_RET(block1->Read()->mValues[0] == static_cast<float>(position / 10), "");
+			TEST_TRUE_NO_RET(block2->Read()->mValues[0] == static_cast<float>(position / 10), "");
+			count++;
+			return true;
+			}), "");
+		TEST_EQ(count, 20, "");
+		TEST_EQ(provider.mProvideCount, 60, "Blocks loaded by the first pass are reused");
+		TEST_FALSE(store.Has("ETH", 190), "");
+
+		// loads still queued when the store goes away are dropped
+		executor.pauseJobs();
+		store.ForEach("ETH", 0, 150, 10, [&](int32_t, int32_t, l::filecache::CacheBlock<Series>*) {
+			return false;
+			});
+		TEST_TRUE(executor.numJobs() > 0, "");
+	}
+	executor.startJobs();
+	executor.shutdown();
+	return 0;
+}
+
+TEST(SequentialCacheStore, PrefetchEvicted) {
+	SlowCacheProvider provider;
+	PersistSeries(provider, "BTC", 40);
+
+	l::concurrency::ExecutorService executor("prefetch", 2);
+	{
+		l::filecache::SequentialCacheStore<Series> store(&provider);
+		store.SetMemoryBudget(5 * (sizeof(Series) + 10 * sizeof(float)));
+		store.ForEach("BTC", 0, 390, 10, [&](int32_t, int32_t, l::filecache::CacheBlock<Series>* cacheBlock) {
+			return cacheBlock->Read().valid();
+			});
+		auto cache = store.GetCache("BTC");
+		for (int32_t position = 10; position <= 40; position += 10) {
+			TEST_TRUE(cache->Get(position, true)->IsEvicted(), "");
+		}
+
+		// evicted blocks are read ahead like blocks that were never loaded
+		store.SetMemoryBudget(0);
+		store.SetPrefetch(&executor, 4);
+		store.ForEach("BTC", 0, 390, 10, [&](int32_t, int32_t, l::filecache::CacheBlock<Series>*) {
+			return false;
+			});
+		TEST_EQ(executor.numTotalJobs(), 4, "");
+		executor.startJobs();
+		for (int32_t i = 0; i < 100 && executor.numCompletedJobs() < executor.numTotalJobs(); i++) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+		for (int32_t position = 10; position <= 40; position += 10) {
+			auto cacheBlock = cache->Get(position, true);
+			TEST_FALSE(cacheBlock->IsEvicted(), "");
+			TEST_EQ(cacheBlock->Read()->mValues[0], static_cast<float>(position / 10), "");
+		}
+	}
+	executor.shutdown();
+	return 0;
+}
+
+PERF_TEST(SequentialCacheStore, PrefetchTimings) {
+	SlowCacheProvider provider;
+	PersistSeries(provider, "BTC", 100);
+
+	l::concurrency::ExecutorService executor("prefetch", 8);
+	executor.startJobs();
+	for (int32_t depth : { 0, 8 }) {
+		l::filecache::SequentialCacheStore<Series> store(&provider);
+		store.SetPrefetch(&executor, depth);
+		PERF_TIMER(depth == 0 ? "SequentialCacheStore::ForEachNoPrefetch" : "SequentialCacheStore::ForEachPrefetch8");
+		store.ForEach("BTC", 0, 990, 10, [&](int32_t, int32_t, l::filecache::CacheBlock<Series>* cacheBlock) {
+			std::this_thread::sleep_for(std::chrono::microseconds(500));
+			return cacheBlock->Read().valid();
+			});
+	}
+	return 0;
+}
+
+TEST(SequentialCacheStore, WriteBehind) {
+	MemoryCacheProvider provider;
+	{
+		l::filecache::SequentialCacheStore<Series> store(&provider);
+		store.SetWriteBehind(16, std::chrono::milliseconds(20));
+
+		// streaming updates to the same few blocks coalesce
+		for (int32_t i = 0; i < 300; i++) {
+			auto block = store.Get("BTC", (i % 3) * 10, 10, true);
+			block->AllocateBlockData(10);
+			block->Get()->mValues[0] = static_cast<float>(i);
+			TEST_TRUE(store.PersistBlock(block), "");
+		}
+		TEST_TRUE(store.Flush(), "");
+		TEST_TRUE(provider.mPersistCount < 300, "Repeated writes of a block should be coalesced");
+		TEST_TRUE(provider.mPersistCount >= 3, "");
+		for (int32_t i = 0; i < 3; i++) {
+			TEST_FALSE(store.Get("BTC", i * 10, 10)->IsDirty(), "");
+		}
+
+		// blocks changed in ForEach are queued, unchanged ones are not
+		auto persistCount = provider.mPersistCount;
+		store.ForEach("BTC", 0, 20, 10, [&](int32_t position, int32_t, l::filecache::CacheBlock<Series>* cacheBlock) {
+			if (position == 10) {
+				cacheBlock->Get()->mValues[1] = 1.0f;
+			}
+			return cacheBlock->Read().valid();
+			});
+		TEST_TRUE(store.Flush(), "");
+		TEST_EQ(provider.mPersistCount, persistCount + 1, "");
+
+		// pending writes are persisted when the store goes away
+		store.Get("BTC", 20, 10)->Get()->mValues[1] = 2.0f;
+		store.PersistBlock(store.Get("BTC", 20, 10));
+	}
+
+	l::filecache::SequentialCacheStore<Series> store(&provider);
+	TEST_EQ(store.Get("BTC", 0, 10)->Read()->mValues[0], 297.0f, "The last write wins");
+	TEST_EQ(store.Get("BTC", 10, 10)->Read()->mValues[0], 298.0f, "");
+	TEST_EQ(store.Get("BTC", 10, 10)->Read()->mValues[1], 1.0f, "");
+	TEST_EQ(store.Get("BTC", 20, 10)->Read()->mValues[1], 2.0f, "");
+	TEST_TRUE(store.Flush(), "Flush without write behind is a no-op");
+	return 0;
+}
+
+namespace {
+	// Fails persists while mFail is set
+	class FailingCacheProvider : public MemoryCacheProvider {
+	public:
+		virtual bool PersistData(std::string_view path, const std::vector<unsigned char>& data) override {
+			if (mFail) {
+				return false;
+			}
+			return MemoryCacheProvider::PersistData(path, data);
+		}
+
+		std::atomic_bool mFail = true;
+	};
+}
+
+TEST(SequentialCacheStore, WriteBehindRetry) {
+	FailingCacheProvider provider;
+	{
+		l::filecache::SequentialCacheStore<Series> store(&provider);
+		store.SetWriteBehind(16, std::chrono::milliseconds(5));
+
+		auto block = store.Get("BTC", 0, 10, true);
+		block->AllocateBlockData(10);
+		block->Get()->mValues[0] = 1.0f;
+		store.PersistBlock(block);
+		TEST_FALSE(store.Flush(), "");
+		TEST_FALSE(store.Flush(), "A failed block fails every flush until it is persisted");
+		TEST_TRUE(block->IsDirty(), "");
+
+		// retried with backoff without another flush
+		provider.mFail = false;
+		for (int32_t i = 0; i < 100 && block->IsDirty(); i++) {
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+		}
+		TEST_FALSE(block->IsDirty(), "");
+		TEST_TRUE(store.Flush(), "");
+
+		// blocks still failing get a last attempt when the store goes away
+		provider.mFail = true;
+		block = store.Get("BTC", 10, 10, true);
+		block->AllocateBlockData(10);
+		block->Get()->mValues[0] = 2.0f;
+		store.PersistBlock(block);
+		TEST_FALSE(store.Flush(), "");
+		provider.mFail = false;
+	}
+	l::filecache::SequentialCacheStore<Series> store(&provider);
+	TEST_EQ(store.Get("BTC", 0, 10)->Read()->mValues[0], 1.0f, "");
+	TEST_EQ(store.Get("BTC", 10, 10)->Read()->mValues[0], 2.0f, "");
+	return 0;
+}
+
+namespace {
+	// Holds persists in the provider until released
+	class BlockingCacheProvider : public MemoryCacheProvider {
+	public:
+		virtual bool PersistData(std::string_view path, const std::vector<unsigned char>& data) override {
+			{
+				std::unique_lock lock(mBlockMutex);
+				mEntered = true;
+				mCondition.notify_all();
+				mCondition.wait(lock, [&]() { return !mBlocking; });
+			}
+			return MemoryCacheProvider::PersistData(path, data);
+		}
+
+		void WaitEntered() {
+			std::unique_lock lock(mBlockMutex);
+			mCondition.wait(lock, [&]() { return mEntered; });
+		}
+		void Release() {
+			std::lock_guard lock(mBlockMutex);
+			mBlocking = false;
+			mCondition.notify_all();
+		}
+
+		std::mutex mBlockMutex;
+		std::condition_variable mCondition;
+		bool mBlocking = true;
+		bool mEntered = false;
+	};
+}
+
+TEST(SequentialCacheStore, PersistRace) {
+	BlockingCacheProvider provider;
+	l::filecache::SequentialCacheStore<Series> store(&provider);
+	auto block = store.Get("BTC", 0, 10, true);
+	block->AllocateBlockData(10);
+	block->Get()->mValues[0] = 1.0f;
+
+	// a write made while the provider holds the previous archive keeps the block dirty
+	std::thread persist([&]() {
+		TEST_TRUE_NO_RET(block->PersistData(), "");
+		});
+	provider.WaitEntered();
+	block->Get()->mValues[0] = 2.0f;
+	provider.Release();
+	persist.join();
+	TEST_TRUE(block->IsDirty(), "");
+
+	TEST_TRUE(block->Evict() > 0, "");
+	TEST_EQ(block->Read()->mValues[0], 2.0f, "The write is persisted before the block is dropped");
+	TEST_FALSE(block->IsDirty(), "");
+	return 0;
+}
+
+TEST(SequentialCacheStore, EvictionOutsideLocks) {
+	BlockingCacheProvider provider;
+	l::filecache::SequentialCacheStore<Series> store(&provider);
+	auto block = store.Get("BTC", 0, 10, true);
+	block->AllocateBlockData(10);
+	block->Get()->mValues[0] = 1.0f;
+
+	// blocks can be created in the same stripe while a dirty block is persisted by the eviction
+	auto cache = store.GetCache("BTC");
+	std::thread evict([&]() {
+		cache->SetMemoryBudget(1);
+		});
+	provider.WaitEntered();
+	TEST_TRUE(cache->Get(160, true) != nullptr, "");
+	TEST_TRUE(cache->Has(0), "");
+	provider.Release();
+	evict.join();
+	TEST_TRUE(block->IsEvicted(), "");
+	TEST_EQ(block->Read()->mValues[0], 1.0f, "");
+	return 0;
+}
+
+TEST(SequentialCacheStore, ConcurrentAccess) {
+	MemoryCacheProvider provider;
+	PersistSeries(provider, "BTC", 64);
+
+	l::filecache::SequentialCacheStore<Series> store(&provider);
+	store.SetMemoryBudget(32 * (sizeof(Series) + 10 * sizeof(float)));
+
+	// readers share blocks while a writer updates every other one and the budget keeps evicting
+	std::atomic<int32_t> mismatches = 0;
+	std::vector<std::thread> threads;
+	for (int32_t t = 0; t < 8; t++) {
+		threads.emplace_back([&, t]() {
+			for (int32_t round = 0; round < 20; round++) {
+				auto forward = (t + round) % 2 == 0;
+				store.ForEach(t < 4 ? "BTC" : "ETH", forward ? 0 : 630, forward ? 630 : 0, 10, [&](int32_t position, int32_t, l::filecache::CacheBlock<Series>* cacheBlock) {
+					if (t < 4) {
+						auto data = cacheBlock->Read();
+						if (!data.valid() || data->mValues[0] != static_cast<float>(position / 10)) {
+							mismatches++;
+						}
+					}
+					else if (position % 20 == 0) {
+						cacheBlock->AllocateBlockData(10);
+						cacheBlock->Get()->mValues[1] += 1.0f;
+					}
+					return true;
+					});
+			}
+			});
+	}
+	for (auto& thread : threads) {
+		thread.join();
+	}
+	TEST_EQ(mismatches.load(), 0, "");
+
+	float sum = 0.0f;
+	for (int32_t i = 0; i < 64; i += 2) {
+		sum += store.Get("ETH", i * 10, 10)->Read()->mValues[1];
+	}
+	TEST_EQ(sum, 32 * 80.0f, "Updates should not be lost when blocks are evicted and reloaded");
+	return 0;
+}
+
 TEST(SequentialCacheStore, CacheGroup) {
-	l::filecache::SequentialCacheStore<Data> store;
+	SlowCacheProvider provider;
+	PersistSeries(provider, "BTC", 20);
+	PersistSeries(provider, "ETH", 20);
+	PersistSeries(provider, "SOL", 10);
+
+	l::concurrency::ExecutorService executor("group", 4);
+	executor.startJobs();
+	{
+		l::filecache::SequentialCacheStore<Series> store(&provider);
+		l::filecache::CacheGroup<Series, Series, Series> group(store.GetCache("BTC", 10), store.GetCache("ETH", 10), store.GetCache("SOL", 10));
+		TEST_EQ(group.GetBlockWidth(), 10, "");
+
+		int32_t count = 0;
+		TEST_TRUE(group.ForEach(5, 95, [&](int32_t position, int32_t size, const auto& blocks) {
+			auto [btc, eth, sol] = blocks;
+			TEST_TRUE_NO_RET(size == 10 && btc->IsPinned() && eth->IsPinned() && sol->IsPinned(), "");
+			TEST_TRUE_NO_RET(btc->Read()->mValues[0] == static_cast<float>(position / 10), "");
+			TEST_TRUE_NO_RET(eth->Read()->mValues[0] == static_cast<float>(position / 10), "");
+			TEST_TRUE_NO_RET(sol->Read()->mValues[0] == static_cast<float>(position / 10), "");
+			count++;
+			return true;
+			}), "");
+		TEST_EQ(count, 10, "");
+		TEST_EQ(provider.mProvideCount, 30, "");
+
+		// members are loaded in parallel and reused by later passes, missing blocks stay empty
+		group.SetExecutor(&executor, 2);
+		std::vector<int32_t> positions;
+		TEST_TRUE(group.ForEach(190, 110, [&](int32_t position, int32_t, const auto& blocks) {
+			TEST_TRUE_NO_RET(std::get<0>(blocks)->Read()->mValues[0] == static_cast<float>(position / 10), "");
+			TEST_TRUE_NO_RET(std::get<1>(blocks)->Read()->mValues[0] == static_cast<float>(position / 10), "");
+			TEST_TRUE_NO_RET(std::get<2>(blocks)->Read().valid() == (position < 100), "");
+			positions.push_back(position);
+			return true;
+			}), "");
+		TEST_TRUE(positions.size() == 9 && positions.front() == 190 && positions.back() == 110, "");
+		TEST_EQ(provider.mProvideCount, 48, "Every block is loaded once");
+		TEST_FALSE(store.Has("BTC", 100), "Loads stop at the end of the range");
+	}
+
+	// same type members chosen at run time
+	std::vector<std::string> symbols;
+	for (int32_t i = 0; i < 6; i++) {
+		symbols.push_back("SYM" + std::to_string(i));
+		PersistSeries(provider, symbols.back(), 10);
+	}
+	auto loaded = provider.mProvideCount;
+	{
+		l::filecache::SequentialCacheStore<Series> store(&provider);
+		std::vector<l::filecache::SequentialCache<Series>*> caches;
+		for (auto& symbol : symbols) {
+			caches.push_back(store.GetCache(symbol, 10));
+		}
+		l::filecache::SequentialCacheGroup<Series> group(caches);
+		group.SetExecutor(&executor, 2);
+		TEST_EQ(group.size(), 6u, "");
 
-	//auto a = store.GetCache("Key1");
-	//l::filecache::CacheGroup<Data, Data, Data> group(a, store.GetCache("Key2"), store.GetCache("Key3"));
+		int32_t count = 0;
+		TEST_TRUE(group.ForEach(90, 0, [&](int32_t position, int32_t size, std::span<l::filecache::CacheBlock<Series>*> blocks) {
+			TEST_TRUE_NO_RET(size == 10 && blocks.size() == 6, "");
+			for (auto cacheBlock : blocks) {
+				TEST_TRUE_NO_RET(cacheBlock->IsPinned(), "");
+				TEST_TRUE_NO_RET(cacheBlock->Read()->mValues[0] == static_cast<float>(position / 10), "");
+			}
+			count++;
+			return position > 30;
+			}), "");
+		TEST_EQ(count, 7, "");
+		TEST_FALSE(caches[0]->Get(30, true)->IsPinned(), "");
 
+		// a throwing callback leaves no block pinned
+		l::filecache::SequentialCacheGroup<Series> throwing(caches);
+		bool thrown = false;
+		try {
+			throwing.ForEach(30, 30, [&](int32_t, int32_t, std::span<l::filecache::CacheBlock<Series>*>) -> bool {
+				throw std::runtime_error("callback");
+				});
+		}
+		catch (const std::runtime_error&) {
+			thrown = true;
+		}
+		TEST_TRUE(thrown, "");
+		for (auto cache : caches) {
+			TEST_FALSE(cache->Get(30, true)->IsPinned(), "");
+		}
+	}
+	// loads still running are waited for when the group goes away
+	TEST_TRUE(provider.mProvideCount - loaded >= 6 * 7 && provider.mProvideCount - loaded <= 6 * 9, "Loads stay within the read ahead of the last visit");
+	executor.shutdown();
 	return 0;
 }
@@ -0,0 +1,55 @@
+#include "testing/Test.h"
+#include "logging/Log.h"
+#include "logging/BinaryLog.h"
+#include "logging/String.h"
+
+#include <filesystem>
+#include <sstream>
+
+using namespace l;
+
+TEST(BinaryLog, WriteAndDecode) {
+	auto path = std::filesystem::path("binarylog_test.blog");
+
+	TEST_TRUE(logging::OpenBinaryLog(path.string()), "Failed to open binary log");
+	for (int32_t i = 0; i < 3; i++) {
+		BLOG(LogInfo, "Loaded {} candles for {} at {}", i, "BTCUSDT", 1.5f);
+	}
+	std::string symbol = "ETHUSDT";
+	BLOG(LogWarning, "No placeholders", symbol, static_cast<uint8_t>(7), true);
+	BLOG(LogInfo, "a {} b {} c {}", 2.5L, 42, "s");
+	logging::CloseBinaryLog();
+
+	BLOG(LogInfo, "Not written since log is closed {}", 1);
+
+	std::stringstream text;
+	TEST_TRUE(logging::DecodeBinaryLogFile(path.string(), text), "Failed to decode binary log");
+	std::filesystem::remove(path);
+
+	std::vector<std::string> lines;
+	for (std::string line; std::getline(text, line);) {
+		lines.push_back(line);
+	}
+	TEST_EQ(lines.size(), 5u, "Wrong number of decoded messages");
+	TEST_TRUE(string::equal_anywhere(lines.at(0), "Info> BinaryLogTest.cpp") >= 0, lines.at(0));
+	TEST_TRUE(string::equal_anywhere(lines.at(0), "Loaded 0 candles for BTCUSDT at 1.5") >= 0, lines.at(0));
+	TEST_TRUE(string::equal_anywhere(lines.at(2), "Loaded 2 candles for BTCUSDT at 1.5") >= 0, lines.at(2));
+	TEST_TRUE(string::equal_anywhere(lines.at(3), "No placeholders ETHUSDT 7 true") >= 0, lines.at(3));
+	TEST_TRUE(string::equal_anywhere(lines.at(4), "a 2.5 b 42 c s") >= 0, lines.at(4));
+
+	return 0;
+}
+
+PERF_TEST(BinaryLogTest, BinaryLogTimings) {
+	auto path = std::filesystem::path("binarylog_perf.blog");
+	logging::OpenBinaryLog(path.string());
+	{
+		PERF_TIMER("BinaryLogTimings::BLOG");
+		for (int i = 0; i < 10000; i++) {
+			BLOG(LogInfo, "Test logging {} {}", i, 0.5);
+		}
+	}
+	logging::CloseBinaryLog();
+	std::filesystem::remove(path);
+	return 0;
+}
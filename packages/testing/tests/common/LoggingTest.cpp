@@ -2,6 +2,8 @@
 #include "logging/Log.h"
 #include "logging/String.h"
 
+#include <thread>
+
 using namespace l;
 
 
@@ -33,6 +35,118 @@ TEST(Logging, WideStringSplit) {
 	return 0;
 }
 
+TEST(Logging, StringTokenizer) {
+	{
+		std::string text;
+		for (int32_t i = 0; i < 200; i++) {
+			text += std::to_string(i * 37);
+			text += (i % 3 == 0) ? "," : (i % 3 == 1 ? ";" : "\n");
+		}
+		auto expected = string::split(text, ",;\n");
+
+		std::array<std::string_view, 256> storage;
+		auto count = string::split_into(text, storage, ",;\n");
+		TEST_EQ(count, expected.size(), "");
+		for (size_t i = 0; i < count; i++) {
+			TEST_TRUE(storage[i] == expected.at(i), storage[i]);
+		}
+
+		size_t i = 0;
+		for (auto token : string::tokenizer(text, ",;\n")) {
+			TEST_TRUE(token == expected.at(i++), token);
+		}
+		TEST_EQ(i, expected.size(), "");
+	}
+	{
+		std::array<std::string_view, 8> storage;
+		TEST_EQ(string::split_into("a,,b,", storage, ",", false), 4u, "");
+		TEST_TRUE(storage[1].empty() && storage[3].empty() && storage[2] == "b", "");
+		TEST_EQ(string::split_into("a,,b,", std::span(storage.data(), 1), ","), 1u, "");
+	}
+	{
+		auto text = std::string(100, 'x') + "|" + std::string(40, 'y');
+		for (size_t pos = 0; pos < text.size(); pos++) {
+			auto expected = text.find_first_of("|#", pos);
+			expected = expected == std::string::npos ? text.size() : expected;
+			TEST_EQ(string::find_first_of(text, "|#", pos), expected, "");
+		}
+		TEST_EQ(string::find_first_of(text, "0123456789abcdef|", 0), 100u, ""); // scalar table path
+	}
+	{
+		auto parts = string::split("a \"b c\" d");
+		TEST_EQ(parts.size(), 3u, "");
+		TEST_TRUE(parts.at(1) == "b c", "");
+	}
+	return 0;
+}
+
+TEST(Logging, NumberParsing) {
+	TEST_FUZZY(string::to_number<double>("  +12.5e2"), 1250.0, 0.0000001, "");
+	TEST_FUZZY(string::to_number<float>(std::string_view("0.125,17", 5)), 0.125f, 0.0000001, "");
+	TEST_EQ(string::to_number<int32_t>("-42xyz"), -42, "");
+	TEST_EQ(string::to_number<uint64_t>("18446744073709551615"), 18446744073709551615ull, "");
+	TEST_EQ(string::get_number<int32_t>("17"), 17, "");
+
+	int32_t value = 5;
+	TEST_FALSE(string::to_number("abc", value), "");
+	TEST_EQ(value, 5, "");
+
+	std::array<float, 8> candles;
+	auto count = string::to_numbers<float>("1731096600,0.5,0.75\n0.25,bad,1e3\n", candles);
+	TEST_EQ(count, 5u, "");
+	TEST_FUZZY(candles[1], 0.5f, 0.0000001, "");
+	TEST_FUZZY(candles[4], 1000.0f, 0.0000001, "");
+
+	std::vector<uint32_t> indices;
+	string::cstring_to_numbers<uint32_t>("1 2 3 4", 7, 3, ' ', indices);
+	TEST_EQ(indices.size(), 3u, "");
+	TEST_EQ(indices.at(2), 3u, "");
+
+	// collada arrays break lines, and the source isn't read past its length
+	const char collada[] = { '\n', '1', ' ', '2', '\n', '3', '\t', '4', ' ', '5' };
+	std::vector<float> floats;
+	string::cstring_to_numbers<float>(collada, 8, 5, ' ', floats);
+	TEST_TRUE(floats == std::vector<float>({ 1.0f, 2.0f, 3.0f, 4.0f }), "");
+	TEST_EQ(string::to_numbers<float>("1, 2 ,3", candles), 3u, "");
+	return 0;
+}
+
+TEST(Logging, StringHashingAndInterning) {
+	using namespace l::string::literals;
+	static_assert(string::fnv1a_32("") == 0x811c9dc5u);
+	static_assert(string::fnv1a_32("a") == 0xe40c292cu);
+	static_assert(string::fnv1a_64("a") == 0xaf63dc4c8601ec8cull);
+	static_assert("telegram_token"_id == string::string_id("telegram_token"));
+	TEST_EQ(string::string_id(std::string("telegram_token")), "telegram_token"_id, "");
+
+	auto btc = string::intern("BTCUSDT");
+	auto eth = string::intern(std::string_view("ETHUSDT_ignored", 7));
+	TEST_TRUE(btc != 0 && eth != 0 && btc != eth, "");
+	TEST_EQ(string::intern(std::string("BTCUSDT")), btc, "");
+	TEST_EQ(string::find_symbol("ETHUSDT"), eth, "");
+	TEST_EQ(string::find_symbol("never interned"), 0u, "");
+	TEST_TRUE(string::symbol_name(eth) == "ETHUSDT", "");
+	TEST_TRUE(string::symbol_name(0).empty(), "");
+
+	std::vector<std::thread> threads;
+	std::array<uint32_t, 4> symbols{};
+	for (size_t i = 0; i < symbols.size(); i++) {
+		threads.emplace_back([&, i]() {
+			for (int j = 0; j < 1000; j++) {
+				symbols[i] = string::intern("symbol_" + std::to_string(j));
+			}
+			});
+	}
+	for (auto& t : threads) {
+		t.join();
+	}
+	for (auto symbol : symbols) {
+		TEST_EQ(symbol, symbols[0], "");
+	}
+	TEST_TRUE(string::symbol_name(symbols[0]) == "symbol_999", "");
+	return 0;
+}
+
 TEST(Logging, StringViewCutting) {
 	auto str = "asdd aaaaaa:bbbb";
 
@@ -165,6 +279,126 @@ TEST(Logging, TimeConversions) {
 	return 0;
 }
 
+TEST(Logging, FastTimeParsing) {
+	TEST_EQ(l::string::parse_unix_time("1970-01-01"), 0, "");
+	TEST_EQ(l::string::parse_unix_time("2024-01-18 14:04:00"), 1705586640, "");
+	TEST_EQ(l::string::parse_unix_time("2024-01-18T14:04:00.1234567Z"), 1705586640, "");
+	TEST_EQ(l::string::parse_unix_time("2024-01-18T15:04:00+01:00"), 1705586640, "");
+	TEST_EQ(l::string::parse_unix_time("1705586640"), 1705586640, "");
+	TEST_EQ(l::string::parse_unix_time("1705586640123"), 1705586640, "");
+	TEST_EQ(l::string::to_unix_time("2024-01-18 14:04:00"), 1705586640, "");
+	TEST_EQ(l::string::to_unix_time2("2024-01-18T14:04:00.0000000Z"), 1705586640, "");
+
+	int64_t ms = 0;
+	TEST_TRUE(l::string::parse_unix_time_ms("2024-02-29T23:59:59.250Z", ms), "");
+	TEST_EQ(ms, 1709251199250, "");
+	TEST_FALSE(l::string::parse_unix_time_ms("garbage", ms), "");
+
+	for (int32_t year = 1970; year < 2100; year += 7) {
+		for (int32_t month = 1; month <= 12; month++) {
+			struct tm timeinfo = {};
+			timeinfo.tm_year = year;
+			timeinfo.tm_mon = month;
+			timeinfo.tm_mday = 28;
+			timeinfo.tm_hour = 13;
+			auto expected = l::string::convert_to_time(&timeinfo, true);
+			char buf[32];
+			std::snprintf(buf, sizeof(buf), "%.4d-%.2d-28 13:00:00", year, month);
+			TEST_EQ(l::string::parse_unix_time(buf), static_cast<int32_t>(expected), buf);
+		}
+	}
+
+	std::vector<std::string_view> dates = { "2024-01-18 14:04:00", "2024-01-18 14:05:00", "bad" };
+	std::vector<int32_t> unixtimes(dates.size());
+	TEST_EQ(l::string::parse_unix_times(dates, unixtimes), 2u, "");
+	TEST_EQ(unixtimes.at(1) - unixtimes.at(0), 60, "");
+	TEST_EQ(unixtimes.at(2), 0, "");
+	return 0;
+}
+
+TEST(Logging, CachedTimeFormatting) {
+	auto unixtime = l::string::get_unix_epoch();
+	auto expected = l::string::get_local_time_string(unixtime, "%Y-%m-%d %H:%M:%S");
+
+	char buf[32];
+	auto size = l::string::get_local_time_string_cached(buf, sizeof(buf), static_cast<int64_t>(unixtime) * 1000000 + 42);
+	TEST_EQ(size, 26u, "");
+	TEST_TRUE(std::string_view(buf, 19) == expected, std::string_view(buf, size));
+	TEST_TRUE(std::string_view(buf + 19, 7) == ".000042", std::string_view(buf, size));
+
+	size = l::string::get_local_time_string_cached(buf, sizeof(buf), static_cast<int64_t>(unixtime) * 1000000 + 999999);
+	TEST_TRUE(std::string_view(buf + 19, 7) == ".999999", std::string_view(buf, size));
+	return 0;
+}
+
+TEST(Logging, DisabledLevelsAreNotEvaluated) {
+	int32_t evaluations = 0;
+	auto count = [&]() {
+		evaluations++;
+		return evaluations;
+	};
+
+	LOG_LEVEL_OFF(LogDebug);
+	LOG(LogDebug) << "Not evaluated " << count();
+	LOG_LEVEL_ON(LogDebug);
+	TEST_EQ(evaluations, 0, "Disabled log level evaluated its arguments");
+
+	ASSERT(true) << "Not evaluated " << count();
+	EXPECT(true) << "Not evaluated " << count();
+	TEST_EQ(evaluations, 0, "Passing condition evaluated its arguments");
+
+	EXPECT(false) << "Evaluated " << count();
+	TEST_EQ(evaluations, 1, "Failing condition did not evaluate its arguments");
+
+	if (evaluations == 1)
+		LOG(LogInfo) << "Dangling else check";
+	else
+		return 1;
+
+	return 0;
+}
+
+TEST(Logging, RateLimitedAndDeduplicated) {
+	std::vector<std::string> messages;
+	logging::SetLocalLogHandler([&](std::string_view msg) {
+		messages.emplace_back(msg);
+		});
+
+	for (int32_t i = 0; i < 100; i++) {
+		LOG_RATE_LIMITED(LogInfo, 5, 60000) << "Node destroyed " << i;
+	}
+	auto rateLimitedCount = messages.size();
+	messages.clear();
+
+	logging::SetLogDeduplication(true);
+	for (int32_t i = 0; i < 10; i++) {
+		LOG(LogInfo) << "Same message";
+	}
+	LOG(LogInfo) << "Other message";
+	logging::SetLogDeduplication(false);
+	TEST_EQ(messages.size(), 3u, "Duplicates were not collapsed");
+	TEST_TRUE(messages.at(1) == "Last message repeated 9 times", messages.at(1));
+
+	// counts that no later message reports are flushed
+	messages.clear();
+	logging::SetLogDeduplication(true);
+	for (int32_t i = 0; i < 4; i++) {
+		LOG(LogInfo) << "Same message";
+	}
+	logging::FlushLog();
+	logging::SetLogDeduplication(false);
+
+	logging::SetLocalLogHandler([](std::string_view msg) {
+		std::cout << msg << std::endl;
+		});
+
+	TEST_EQ(rateLimitedCount, 5u, "Rate limiter let through the wrong number of messages");
+	TEST_EQ(messages.size(), 3u, "");
+	TEST_TRUE(messages.at(1) == "Last message repeated 3 times", messages.at(1));
+	TEST_TRUE(string::equal_anywhere(messages.at(2), "Suppressed 95 messages from LoggingTest.cpp(368)") >= 0, messages.at(2));
+	return 0;
+}
+
 PERF_TEST(LoggingTest, LogTimings) {
 	{
 		PERF_TIMER("LogTimings::LogInfo");
@@ -179,6 +413,57 @@ PERF_TEST(LoggingTest, LogTimings) {
 		}
 	}
 
+	{
+		LOG_LEVEL_OFF(LogDebug);
+		PERF_TIMER("LogTimings::LogDebugDisabled");
+		for (int i = 0; i < 10; i++) {
+			LOG(LogDebug) << "Test logging";
+		}
+		LOG_LEVEL_ON(LogDebug);
+	}
+
+	{
+		char buf[32];
+		PERF_TIMER("LogTimings::CachedTimeString");
+		for (int i = 0; i < 10000; i++) {
+			l::logging::get_time_string(buf, sizeof(buf));
+		}
+	}
+	{
+		std::vector<std::string_view> dates(10000, "2024-01-18T14:04:00.000Z");
+		std::vector<int32_t> unixtimes(dates.size());
+		PERF_TIMER("LogTimings::ParseUnixTimes");
+		l::string::parse_unix_times(dates, unixtimes);
+	}
+
+	{
+		std::string text;
+		for (int i = 0; i < 10000; i++) {
+			text += "1731096600000,0.5123,0.5234,0.5012,0.5199,123456.78\n";
+		}
+		std::vector<std::string_view> storage(text.size() / 4);
+		{
+			PERF_TIMER("LogTimings::Split");
+			auto parts = string::split(text, ",\n");
+		}
+		{
+			PERF_TIMER("LogTimings::SplitInto");
+			string::split_into(text, storage, ",\n");
+		}
+	}
+
+	{
+		std::string text;
+		for (int i = 0; i < 10000; i++) {
+			text += "0.5123,0.5234,0.5012,0.5199,123456.78\n";
+		}
+		std::vector<float> values(50000);
+		{
+			PERF_TIMER("LogTimings::ToNumbers");
+			string::to_numbers<float>(text, values);
+		}
+	}
+
 	PERF_TIMER_RESULT("LogTimings");
 	return 0;
 }